@@ -34,10 +34,12 @@
 /////////////////////////////////////////////////////////////////////////
 //Allocator types
 #include "maxsize.hpp"
+#include "maxsize_bitset.hpp"
 #include "pim.hpp"
 #include "islip.hpp"
 #include "loa.hpp"
 #include "wavefront.hpp"
+#include "wavefront_bitset.hpp"
 #include "selalloc.hpp"
 #include "separable_input_first.hpp"
 #include "separable_output_first.hpp"
@@ -59,8 +61,12 @@ Module( parent, name ), _inputs( inputs ), _outputs( outputs ), _dirty( false )
 void Allocator::Clear( )
 {
   if(_dirty) {
-    _inmatch.assign(_inputs, -1);
-    _outmatch.assign(_outputs, -1);
+    for(size_t i = 0; i < _req_in.size(); ++i) {
+      _inmatch[_req_in[i]] = -1;
+      _outmatch[_req_out[i]] = -1;
+    }
+    _req_in.clear();
+    _req_out.clear();
     _dirty = false;
   }
 }
@@ -71,6 +77,8 @@ void Allocator::AddRequest( int in, int out, int label, int in_pri,
   assert( ( in >= 0 ) && ( in < _inputs ) );
   assert( ( out >= 0 ) && ( out < _outputs ) );
   assert( label >= 0 );
+  _req_in.push_back(in);
+  _req_out.push_back(out);
   _dirty = true;
 }
 
@@ -127,10 +135,8 @@ DenseAllocator::DenseAllocator( Module *parent, const string& name,
 
 void DenseAllocator::Clear( )
 {
-  for ( int i = 0; i < _inputs; ++i ) {
-    for ( int j = 0; j < _outputs; ++j ) {
-      _request[i][j].label = -1;
-    }
+  for ( size_t i = 0; i < _req_in.size(); ++i ) {
+    _request[_req_in[i]][_req_out[i]].label = -1;
   }
   Allocator::Clear();
 }
@@ -266,14 +272,12 @@ SparseAllocator::SparseAllocator( Module *parent, const string& name,
 
 void SparseAllocator::Clear( )
 {
-  for ( int i = 0; i < _inputs; ++i ) {
-    if(!_in_req[i].empty())
-      _in_req[i].clear( );
+  for ( set<int>::const_iterator i = _in_occ.begin( ); i != _in_occ.end( ); ++i ) {
+    _in_req[*i].clear( );
   }
 
-  for ( int j = 0; j < _outputs; ++j ) {
-    if(!_out_req[j].empty())
-      _out_req[j].clear( );
+  for ( set<int>::const_iterator j = _out_occ.begin( ); j != _out_occ.end( ); ++j ) {
+    _out_req[*j].clear( );
   }
 
   _in_occ.clear( );
@@ -419,6 +423,172 @@ void SparseAllocator::PrintRequests( ostream * os ) const
   *os << "]." << endl;
 }
 
+//==================================================
+// BitsetAllocator
+//==================================================
+
+BitsetAllocator::BitsetAllocator( Module *parent, const string& name,
+				  int inputs, int outputs ) :
+  Allocator( parent, name, inputs, outputs )
+{
+  _in_words  = ( _outputs + _word_bits - 1 ) / _word_bits;
+  _out_words = ( _inputs + _word_bits - 1 ) / _word_bits;
+
+  _in_row.resize(_inputs * _in_words, 0);
+  _out_col.resize(_outputs * _out_words, 0);
+
+  _in_occ_bits.resize(_out_words, 0);
+  _out_occ_bits.resize(_in_words, 0);
+
+  _in_count.resize(_inputs, 0);
+  _out_count.resize(_outputs, 0);
+
+  _request.resize(_inputs * _outputs);
+}
+
+void BitsetAllocator::Clear( )
+{
+  // only rows and columns that hold requests need to be reset
+  for ( int w = 0; w < _out_words; ++w ) {
+    for ( word_t b = _in_occ_bits[w]; b; b &= b - 1 ) {
+      int const in = w * _word_bits + __builtin_ctzll( b );
+      for ( int i = 0; i < _in_words; ++i ) {
+	_in_row[in * _in_words + i] = 0;
+      }
+      _in_count[in] = 0;
+    }
+    _in_occ_bits[w] = 0;
+  }
+
+  for ( int w = 0; w < _in_words; ++w ) {
+    for ( word_t b = _out_occ_bits[w]; b; b &= b - 1 ) {
+      int const out = w * _word_bits + __builtin_ctzll( b );
+      for ( int i = 0; i < _out_words; ++i ) {
+	_out_col[out * _out_words + i] = 0;
+      }
+      _out_count[out] = 0;
+    }
+    _out_occ_bits[w] = 0;
+  }
+
+  Allocator::Clear();
+}
+
+int BitsetAllocator::ReadRequest( int in, int out ) const
+{
+  sRequest r;
+
+  if ( ! ReadRequest( r, in, out ) ) {
+    r.label = -1;
+  } 
+
+  return r.label;
+}
+
+bool BitsetAllocator::ReadRequest( sRequest &req, int in, int out ) const
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) );
+
+  if ( ( _InRow(in)[out / _word_bits] >> ( out % _word_bits ) ) & 1 ) {
+    req = _request[in * _outputs + out];
+    return true;
+  }
+  return false;
+}
+
+void BitsetAllocator::AddRequest( int in, int out, int label, 
+				  int in_pri, int out_pri )
+{
+  Allocator::AddRequest(in, out, label, in_pri, out_pri);
+  assert( ReadRequest( in, out ) < 0 );
+
+  _in_row[in * _in_words + out / _word_bits]   |= (word_t)1 << ( out % _word_bits );
+  _out_col[out * _out_words + in / _word_bits] |= (word_t)1 << ( in % _word_bits );
+
+  if ( _in_count[in]++ == 0 ) {
+    _in_occ_bits[in / _word_bits] |= (word_t)1 << ( in % _word_bits );
+  }
+  if ( _out_count[out]++ == 0 ) {
+    _out_occ_bits[out / _word_bits] |= (word_t)1 << ( out % _word_bits );
+  }
+
+  sRequest & req = _request[in * _outputs + out];
+  req.port    = out;
+  req.label   = label;
+  req.in_pri  = in_pri;
+  req.out_pri = out_pri;
+}
+
+void BitsetAllocator::RemoveRequest( int in, int out, int label )
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) ); 
+  assert( ReadRequest( in, out ) == label );
+
+  _in_row[in * _in_words + out / _word_bits]   &= ~( (word_t)1 << ( out % _word_bits ) );
+  _out_col[out * _out_words + in / _word_bits] &= ~( (word_t)1 << ( in % _word_bits ) );
+
+  if ( --_in_count[in] == 0 ) {
+    _in_occ_bits[in / _word_bits] &= ~( (word_t)1 << ( in % _word_bits ) );
+  }
+  if ( --_out_count[out] == 0 ) {
+    _out_occ_bits[out / _word_bits] &= ~( (word_t)1 << ( out % _word_bits ) );
+  }
+}
+
+bool BitsetAllocator::InputHasRequests( int in ) const
+{
+  return _in_count[in] > 0;
+}
+
+bool BitsetAllocator::OutputHasRequests( int out ) const
+{
+  return _out_count[out] > 0;
+}
+
+int BitsetAllocator::NumInputRequests( int in ) const
+{
+  return _in_count[in];
+}
+
+int BitsetAllocator::NumOutputRequests( int out ) const
+{
+  return _out_count[out];
+}
+
+void BitsetAllocator::PrintRequests( ostream * os ) const
+{
+  if(!os) os = &cout;
+  
+  *os << "Input requests = [ ";
+  for ( int input = 0; input < _inputs; ++input ) {
+    if(_in_count[input] > 0) {
+      *os << input << " -> [ ";
+      for ( int output = _NextSet( _InRow(input), NULL, _in_words, 0 );
+	    output >= 0;
+	    output = _NextSet( _InRow(input), NULL, _in_words, output + 1 ) ) {
+	*os << output << "@" << _request[input * _outputs + output].in_pri << " ";
+      }
+      *os << "]  ";
+    }
+  }
+  *os << "], output requests = [ ";
+  for ( int output = 0; output < _outputs; ++output ) {
+    if(_out_count[output] > 0) {
+      *os << output << " -> ";
+      *os << "[ ";
+      for ( int input = _NextSet( _OutCol(output), NULL, _out_words, 0 );
+	    input >= 0;
+	    input = _NextSet( _OutCol(output), NULL, _out_words, input + 1 ) ) {
+	*os << input << "@" << _request[input * _outputs + output].out_pri << " ";
+      }
+      *os << "]  ";
+    }
+  }
+  *os << "]." << endl;
+}
+
 //==================================================
 // Global allocator allocation function
 //==================================================
@@ -446,6 +616,8 @@ Allocator *Allocator::NewAllocator( Module *parent, const string& name,
   }
   if ( alloc_name == "max_size" ) {
     a = new MaxSizeMatch( parent, name, inputs, outputs );
+  } else if ( alloc_name == "max_size_bitset" ) {
+    a = new MaxSizeBitset( parent, name, inputs, outputs );
   } else if ( alloc_name == "pim" ) {
     int iters = param_str.empty() ? (config ? config->GetInt("alloc_iters") : 1) : atoi(param_str.c_str());
     a = new PIM( parent, name, inputs, outputs, iters );
@@ -458,6 +630,10 @@ Allocator *Allocator::NewAllocator( Module *parent, const string& name,
     a = new Wavefront( parent, name, inputs, outputs );
   } else if ( alloc_name == "rr_wavefront" ) {
     a = new Wavefront( parent, name, inputs, outputs, true );
+  } else if ( alloc_name == "wavefront_bitset" ) {
+    a = new WavefrontBitset( parent, name, inputs, outputs );
+  } else if ( alloc_name == "rr_wavefront_bitset" ) {
+    a = new WavefrontBitset( parent, name, inputs, outputs, true );
   } else if ( alloc_name == "select" ) {
     int iters = param_str.empty() ? (config ? config->GetInt("alloc_iters") : 1) : atoi(param_str.c_str());
     a = new SelAlloc( parent, name, inputs, outputs, iters );
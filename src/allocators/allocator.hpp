@@ -32,6 +32,7 @@
 #include <map>
 #include <set>
 #include <vector>
+#include <stdint.h>
 
 #include "module.hpp"
 #include "config_utils.hpp"
@@ -46,6 +47,11 @@ protected:
   vector<int> _inmatch;
   vector<int> _outmatch;
 
+  // (input, output) pairs requested since the last Clear(); every grant
+  // is one of these, so resetting them is enough to undo a cycle
+  vector<int> _req_in;
+  vector<int> _req_out;
+
 public:
 
   struct sRequest {
@@ -155,4 +161,86 @@ public:
 
 };
 
+//==================================================
+// A bitset allocator stores the request matrix as
+// rows (per input) and columns (per output) of
+// machine-word bitsets; label and priorities live
+// in a dense side array. Requests are visited in
+// increasing port order, as in the sparse allocator.
+//==================================================
+
+class BitsetAllocator : public Allocator {
+protected:
+  typedef uint64_t word_t;
+  static const int _word_bits = 64;
+
+  int _in_words;   // words per input row (indexed by output)
+  int _out_words;  // words per output column (indexed by input)
+
+  vector<word_t> _in_row;
+  vector<word_t> _out_col;
+
+  vector<word_t> _in_occ_bits;
+  vector<word_t> _out_occ_bits;
+
+  vector<int> _in_count;
+  vector<int> _out_count;
+
+  vector<sRequest> _request;
+
+  inline word_t const * _InRow( int in ) const {
+    return &_in_row[in * _in_words];
+  }
+  inline word_t const * _OutCol( int out ) const {
+    return &_out_col[out * _out_words];
+  }
+
+  // Lowest set bit at or above pos in (bits & mask), or -1.
+  static inline int _NextSet( word_t const * bits, word_t const * mask,
+			      int words, int pos ) {
+    int w = pos / _word_bits;
+    if ( w >= words ) {
+      return -1;
+    }
+    word_t b = bits[w] & ( mask ? mask[w] : ~(word_t)0 ) &
+      ( ~(word_t)0 << ( pos % _word_bits ) );
+    while ( !b ) {
+      if ( ++w >= words ) {
+	return -1;
+      }
+      b = bits[w] & ( mask ? mask[w] : ~(word_t)0 );
+    }
+    return w * _word_bits + __builtin_ctzll( b );
+  }
+
+  // Round-robin search starting at pos and wrapping around, or -1.
+  static inline int _RoundRobin( word_t const * bits, word_t const * mask,
+				 int words, int pos ) {
+    int const found = _NextSet( bits, mask, words, pos );
+    return ( found >= 0 || pos == 0 ) ? found : _NextSet( bits, mask, words, 0 );
+  }
+
+public:
+  BitsetAllocator( Module *parent, const string& name,
+		   int inputs, int outputs );
+
+  void Clear( );
+
+  int  ReadRequest( int in, int out ) const;
+  bool ReadRequest( sRequest &req, int in, int out ) const;
+
+  void AddRequest( int in, int out, int label = 1,
+		   int in_pri = 0, int out_pri = 0 );
+  void RemoveRequest( int in, int out, int label = 1 );
+
+  bool OutputHasRequests( int out ) const;
+  bool InputHasRequests( int in ) const;
+
+  int NumOutputRequests( int out ) const;
+  int NumInputRequests( int in ) const;
+
+  void PrintRequests( ostream * os = NULL ) const;
+
+};
+
 #endif
@@ -35,11 +35,13 @@
 
 iSLIP_Sparse::iSLIP_Sparse( Module *parent, const string& name,
 			    int inputs, int outputs, int iters ) :
-  SparseAllocator( parent, name, inputs, outputs ),
+  BitsetAllocator( parent, name, inputs, outputs ),
   _iSLIP_iter(iters)
 {
   _gptrs.resize(_outputs, 0);
   _aptrs.resize(_inputs, 0);
+  _grant_row.resize(_inputs * _in_words, 0);
+  _free_inputs.resize(_out_words, 0);
 }
 
 void iSLIP_Sparse::Allocate( )
@@ -47,58 +49,42 @@ void iSLIP_Sparse::Allocate( )
   int input;
   int output;
 
-  int input_offset;
-  int output_offset;
-
-  map<int, sRequest>::iterator p;
-  bool wrapped;
+  for ( int w = 0; w < _out_words; ++w ) {
+    _free_inputs[w] = 0;
+  }
+  for ( input = 0; input < _inputs; ++input ) {
+    if ( _inmatch[input] == -1 ) {
+      _free_inputs[input / _word_bits] |= (word_t)1 << ( input % _word_bits );
+    }
+  }
 
   for ( int iter = 0; iter < _iSLIP_iter; ++iter ) {
     // Grant phase
 
+#ifdef DEBUG_ISLIP
     vector<int> grants(_outputs, -1);
+#endif
 
-    for ( output = 0; output < _outputs; ++output ) {
+    for ( output = _NextSet( &_out_occ_bits[0], NULL, _in_words, 0 );
+	  output >= 0;
+	  output = _NextSet( &_out_occ_bits[0], NULL, _in_words, output + 1 ) ) {
 
-      // Skip loop if there are no requests
-      // or the output is already matched
-      if ( ( _out_req[output].empty( ) ) ||
-	   ( _outmatch[output] != -1 ) ) {
+      // Skip loop if the output is already matched
+      if ( _outmatch[output] != -1 ) {
 	continue;
       }
 
-      // A round-robin arbiter between input requests
-      input_offset = _gptrs[output];
+      // A round-robin arbiter between requests from free inputs
+      input = _RoundRobin( _OutCol(output), &_free_inputs[0], _out_words,
+			   _gptrs[output] );
 
-      p = _out_req[output].begin( );
-      while( ( p != _out_req[output].end( ) ) &&
-	     ( p->second.port < input_offset ) ) {
-	p++;
+      if ( input >= 0 ) {
+#ifdef DEBUG_ISLIP
+	grants[output] = input;
+#endif
+	_grant_row[input * _in_words + output / _word_bits] |= 
+	  (word_t)1 << ( output % _word_bits );
       }
-
-      wrapped = false;
-      while( (!wrapped) || 
-	     ( ( p != _out_req[output].end( ) ) &&
-	       ( p->second.port < input_offset ) ) ) {
-	if ( p == _out_req[output].end( ) ) {
-	  if ( wrapped ) { break; }
-	  // p is valid here because empty lists
-	  // are skipped (above)
-	  p = _out_req[output].begin( );
-	  wrapped = true;
-	}
-
-	input = p->second.port;
-
-	// we know the output is free (above) and
-	// if the input is free, grant request
-	if ( _inmatch[input] == -1 ) {
-	  grants[output] = input;
-	  break;
-	}
-
-	p++;
-      }      
     }
 
 #ifdef DEBUG_ISLIP
@@ -117,53 +103,31 @@ void iSLIP_Sparse::Allocate( )
 
     // Accept phase
 
-    for ( input = 0; input < _inputs; ++input ) {
+    for ( input = _NextSet( &_in_occ_bits[0], NULL, _out_words, 0 );
+	  input >= 0;
+	  input = _NextSet( &_in_occ_bits[0], NULL, _out_words, input + 1 ) ) {
 
-      if ( _in_req[input].empty( ) ) {
-	continue;
-      }
+      word_t * const grant_row = &_grant_row[input * _in_words];
 
       // A round-robin arbiter between output grants
-      output_offset = _aptrs[input];
-
-      p = _in_req[input].begin( );
-      while( ( p != _in_req[input].end( ) ) &&
-	     ( p->second.port < output_offset ) ) {
-	p++;
-      }
-
-      wrapped = false;
-      while( (!wrapped) || 
-	     ( ( p != _in_req[input].end( ) ) &&
-	       ( p->second.port < output_offset ) ) ) {
-	if ( p == _in_req[input].end( ) ) {
-	  if ( wrapped ) { break; }
-	  // p is valid here because empty lists
-	  // are skipped (above)
-	  p = _in_req[input].begin( );
-	  wrapped = true;
+      output = _RoundRobin( grant_row, NULL, _in_words, _aptrs[input] );
+
+      if ( output >= 0 ) {
+	// Accept
+	_inmatch[input]   = output;
+	_outmatch[output] = input;
+	_free_inputs[input / _word_bits] &= ~( (word_t)1 << ( input % _word_bits ) );
+
+	// Only update pointers if accepted during the 1st iteration
+	if ( iter == 0 ) {
+	  _gptrs[output] = ( input + 1 ) % _inputs;
+	  _aptrs[input]  = ( output + 1 ) % _outputs;
 	}
 
-	output = p->second.port;
-
-	// we know the output is free (above) and
-	// if the input is free, grant request
-	if ( grants[output] == input ) {
-	  // Accept
-	  _inmatch[input]   = output;
-	  _outmatch[output] = input;
-
-	  // Only update pointers if accepted during the 1st iteration
-	  if ( iter == 0 ) {
-	    _gptrs[output] = ( input + 1 ) % _inputs;
-	    _aptrs[input]  = ( output + 1 ) % _outputs;
-	  }
-
-	  break;
+	for ( int w = 0; w < _in_words; ++w ) {
+	  grant_row[w] = 0;
 	}
-
-	p++;
-      } 
+      }
     }
   }
 
@@ -32,12 +32,18 @@
 
 #include "allocator.hpp"
 
-class iSLIP_Sparse : public SparseAllocator {
+class iSLIP_Sparse : public BitsetAllocator {
   int _iSLIP_iter;
 
   vector<int> _gptrs;
   vector<int> _aptrs;
 
+  // per-input bitset of the outputs that granted it in this iteration
+  vector<word_t> _grant_row;
+
+  // bitset of the inputs that are still unmatched
+  vector<word_t> _free_inputs;
+
 public:
   iSLIP_Sparse( Module *parent, const string& name,
 		int inputs, int outputs, int iters );
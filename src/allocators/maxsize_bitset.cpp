@@ -0,0 +1,143 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "booksim.hpp"
+
+#include "maxsize_bitset.hpp"
+
+MaxSizeBitset::MaxSizeBitset( Module *parent, const string& name,
+			      int inputs, int outputs ) :
+  DenseAllocator( parent, name, inputs, outputs )
+{
+  _words = ( outputs + _word_bits - 1 ) / _word_bits;
+  _row.resize(inputs * _words, 0);
+  _reached.resize(_words, 0);
+  _from.resize(outputs, -1);
+  _s.resize(inputs);
+  _ns.resize(inputs);
+  _prio = 0;
+}
+
+void MaxSizeBitset::Allocate( )
+{
+  for ( size_t r = 0; r < _req_in.size(); ++r ) {
+    int const i = _req_in[r];
+    int const j = _req_out[r];
+    if ( _request[i][j].label != -1 ) {
+      _row[i * _words + j / _word_bits] |= (word_t)1 << ( j % _word_bits );
+    }
+  }
+
+  // augment as many times as possible 
+  while( _ShortestAugmenting( ) );
+
+  for ( size_t r = 0; r < _req_in.size(); ++r ) {
+    int const i = _req_in[r];
+    int const j = _req_out[r];
+    _row[i * _words + j / _word_bits] = 0;
+  }
+
+  // next time, start at next input to ensure fairness
+  _prio = (_prio + 1) % _inputs;
+}
+
+bool MaxSizeBitset::_ShortestAugmenting( )
+{
+  int i, j, jn;
+  int slen, nslen;
+
+  // start with empty stack
+  slen = 0;
+
+  // push all unassigned inputs to the stack
+  for ( i = 0; i < _inputs; ++i ) {
+    j = (i + _prio) % _inputs;
+    if ( _inmatch[j] == -1 ) { // start with unmatched left nodes
+      _s[slen++] = j;
+    }
+  }
+
+  for ( int w = 0; w < _words; ++w ) {
+    _reached[w] = 0;
+  }
+
+  for ( int iter = 0; iter < _inputs; iter++ ) {
+    nslen = 0;
+
+    for ( int e = 0; e < slen; ++e ) {
+      i = _s[e];
+
+      word_t const * const row = &_row[i * _words];
+      
+      for ( int w = 0; w < _words; ++w ) {
+	// edges (i,j) not in the current matching with no shorter path to j
+	word_t b = row[w] & ~_reached[w];
+	if ( ( _inmatch[i] >= 0 ) && ( _inmatch[i] / _word_bits == w ) ) {
+	  b &= ~( (word_t)1 << ( _inmatch[i] % _word_bits ) );
+	}
+	for ( ; b; b &= b - 1 ) {
+	  j = w * _word_bits + __builtin_ctzll( b );
+
+	  _from[j] = i;                  // how did we get to j?
+	  _reached[w] |= (word_t)1 << ( j % _word_bits );
+
+	  if ( _outmatch[j] == -1 ) {   // j is unmatched -- augmenting path found
+	    goto found_augmenting;
+	  } else {                      // j is matched
+	    _ns[nslen++] = _outmatch[j];  // add the destination of this edge to the leaf nodes
+	  }
+	}
+      }
+    }
+
+    // no augmenting path found yet, swap stacks
+    _s.swap(_ns);
+    slen = nslen;
+  }
+  
+  return false; // no augmenting paths
+
+ found_augmenting:
+  
+  // the augmenting path ends at node j on the right
+
+  i = _from[j];
+  _outmatch[j] = i;
+
+  while ( _inmatch[i] != -1 ) {  // loop until the end of the path
+    jn = _inmatch[i];            // remove previous edge (i,jn) and add (i,j)
+    _inmatch[i] = j;
+
+    j = jn;                    // add edge from (jn,in)
+    i = _from[j];
+    _outmatch[j] = i; 
+  }
+  
+  _inmatch[i] = j;
+
+  return true;
+}
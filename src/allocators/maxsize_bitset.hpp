@@ -0,0 +1,62 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _MAXSIZE_BITSET_HPP_
+#define _MAXSIZE_BITSET_HPP_
+
+#include <vector>
+#include <stdint.h>
+
+#include "allocator.hpp"
+
+// Maximum-size matching with the same shortest augmenting path search as
+// MaxSizeMatch, but with the request rows and the set of outputs reached
+// by the breadth-first tree held as bitsets.
+class MaxSizeBitset : public DenseAllocator {
+
+  typedef uint64_t word_t;
+  static const int _word_bits = 64;
+
+  int _words;
+  vector<word_t> _row;      // requested outputs per input
+  vector<word_t> _reached;  // outputs already in the breadth-first tree
+
+  vector<int> _from;   // array to hold breadth-first tree
+  vector<int> _s;      // stack of leaf nodes in tree
+  vector<int> _ns;     // next stack
+  int _prio;           // priority pointer to ensure fairness
+ 
+  bool _ShortestAugmenting( );
+
+public:
+  MaxSizeBitset( Module *parent, const string& name,
+		 int inputs, int outputs ); 
+  
+  void Allocate( );
+};
+
+#endif
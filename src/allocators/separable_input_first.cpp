@@ -48,21 +48,19 @@ SeparableInputFirstAllocator( Module* parent, const string& name, int inputs,
 
 void SeparableInputFirstAllocator::Allocate() {
   
-  set<int>::const_iterator port_iter = _in_occ.begin();
-  while(port_iter != _in_occ.end()) {
+  for(int input = _NextSet(&_in_occ_bits[0], NULL, _out_words, 0);
+      input >= 0;
+      input = _NextSet(&_in_occ_bits[0], NULL, _out_words, input + 1)) {
     
-    const int & input = *port_iter;
-
     // add requests to the input arbiter
 
-    map<int, sRequest>::const_iterator req_iter = _in_req[input].begin();
-    while(req_iter != _in_req[input].end()) {
+    for(int output = _NextSet(_InRow(input), NULL, _in_words, 0);
+	output >= 0;
+	output = _NextSet(_InRow(input), NULL, _in_words, output + 1)) {
 
-      const sRequest & req = req_iter->second;
+      const sRequest & req = _request[input * _outputs + output];
       
-      _input_arb[input]->AddRequest(req.port, req.label, req.in_pri);
-
-      ++req_iter;
+      _input_arb[input]->AddRequest(output, req.label, req.in_pri);
     }
 
     // Execute the input arbiters and propagate the grants to the
@@ -72,18 +70,15 @@ void SeparableInputFirstAllocator::Allocate() {
     const int output = _input_arb[input]->Arbitrate(&label, NULL);
     assert(output > -1);
 
-    const sRequest & req = _out_req[output][input]; 
-    assert((req.port == input) && (req.label == label));
-
-    _output_arb[output]->AddRequest(req.port, req.label, req.out_pri);
+    const sRequest & req = _request[input * _outputs + output]; 
+    assert((req.port == output) && (req.label == label));
 
-    ++port_iter;
+    _output_arb[output]->AddRequest(input, req.label, req.out_pri);
   }
 
-  port_iter = _out_occ.begin();
-  while(port_iter != _out_occ.end()) {
-
-    const int & output = *port_iter;
+  for(int output = _NextSet(&_out_occ_bits[0], NULL, _in_words, 0);
+      output >= 0;
+      output = _NextSet(&_out_occ_bits[0], NULL, _in_words, output + 1)) {
 
     // Execute the output arbiters.
     
@@ -97,7 +92,5 @@ void SeparableInputFirstAllocator::Allocate() {
       _input_arb[input]->UpdateState() ;
       _output_arb[output]->UpdateState() ;
     }
-
-    ++port_iter;
   }
 }
@@ -48,21 +48,19 @@ SeparableOutputFirstAllocator( Module* parent, const string& name, int inputs,
 
 void SeparableOutputFirstAllocator::Allocate() {
   
-  set<int>::const_iterator port_iter = _out_occ.begin();
-  while(port_iter != _out_occ.end()) {
+  for(int output = _NextSet(&_out_occ_bits[0], NULL, _in_words, 0);
+      output >= 0;
+      output = _NextSet(&_out_occ_bits[0], NULL, _in_words, output + 1)) {
     
-    const int & output = *port_iter;
-
     // add requests to the output arbiter
 
-    map<int, sRequest>::const_iterator req_iter = _out_req[output].begin();
-    while(req_iter != _out_req[output].end()) {
+    for(int input = _NextSet(_OutCol(output), NULL, _out_words, 0);
+	input >= 0;
+	input = _NextSet(_OutCol(output), NULL, _out_words, input + 1)) {
       
-      const sRequest & req = req_iter->second;
-
-      _output_arb[output]->AddRequest(req.port, req.label, req.out_pri);
+      const sRequest & req = _request[input * _outputs + output];
 
-      ++req_iter;
+      _output_arb[output]->AddRequest(input, req.label, req.out_pri);
     }
     
     // Execute the output arbiter and propagate the grants to the
@@ -72,19 +70,16 @@ void SeparableOutputFirstAllocator::Allocate() {
     const int input = _output_arb[output]->Arbitrate(&label, NULL);
     assert(input > -1);
 
-    const sRequest & req = _in_req[input][output];
+    const sRequest & req = _request[input * _outputs + output];
     assert((req.port == output) && (req.label == label));
 
-    _input_arb[input]->AddRequest(req.port, req.label, req.in_pri);
-
-    ++port_iter;
+    _input_arb[input]->AddRequest(output, req.label, req.in_pri);
   }
   
-  port_iter = _in_occ.begin();
-  while(port_iter != _in_occ.end()) {
+  for(int input = _NextSet(&_in_occ_bits[0], NULL, _out_words, 0);
+      input >= 0;
+      input = _NextSet(&_in_occ_bits[0], NULL, _out_words, input + 1)) {
     
-    const int & input = *port_iter;
-
     // Execute the input arbiters.
     
     const int output = _input_arb[input]->Arbitrate(NULL, NULL);
@@ -97,7 +92,5 @@ void SeparableOutputFirstAllocator::Allocate() {
       _input_arb[input]->UpdateState() ;
       _output_arb[output]->UpdateState() ;
     }
-    
-    ++port_iter;
   }
 }
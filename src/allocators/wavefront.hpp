@@ -34,13 +34,12 @@
 
 class Wavefront : public DenseAllocator {
 
-private:
+protected:
   int _last_in;
   int _last_out;
   set<pair<int, int> > _priorities;
   bool _skip_diags;
 
-protected:
   int _square;
   int _pri;
   int _num_requests;
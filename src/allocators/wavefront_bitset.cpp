@@ -0,0 +1,124 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*wavefront_bitset.cpp
+ *
+ *Bit-packed wave front allocator, grants are identical to Wavefront
+ *
+ */
+#include "booksim.hpp"
+
+#include "wavefront_bitset.hpp"
+
+WavefrontBitset::WavefrontBitset( Module *parent, const string& name,
+				  int inputs, int outputs, bool skip_diags ) :
+  Wavefront( parent, name, inputs, outputs, skip_diags )
+{
+  _words = ( _square + _word_bits - 1 ) / _word_bits;
+  _diag.resize(_square * _words, 0);
+  _free_out.resize(_words, 0);
+}
+
+void WavefrontBitset::Allocate( )
+{
+
+  int first_diag = -1;
+
+  if(_num_requests == 0)
+
+    // bypass allocator completely if there were no requests
+    return;
+  
+  if(_num_requests == 1) {
+
+    // if we only had a single request, we can immediately grant it
+    _inmatch[_last_in] = _last_out;
+    _outmatch[_last_out] = _last_in;
+    first_diag = _last_in + _last_out;
+
+  } else {
+
+    // all outputs start out unmatched
+    for ( int output = 0; output < _outputs; ++output ) {
+      _free_out[output / _word_bits] |= (word_t)1 << ( output % _word_bits );
+    }
+
+    for(set<pair<int, int> >::const_reverse_iterator iter = 
+	  _priorities.rbegin();
+	iter != _priorities.rend(); ++iter) {
+
+      // diagonal d holds cell (input, output) with input + output = d mod square,
+      // stored as a bitset over outputs
+      for ( size_t r = 0; r < _req_in.size(); ++r ) {
+	int const input = _req_in[r];
+	int const output = _req_out[r];
+	sRequest const & req = _request[input][output];
+	if ( ( req.label != -1 ) &&
+	     ( req.in_pri == iter->second ) &&
+	     ( req.out_pri == iter->first ) ) {
+	  int const d = ( input + output ) % _square;
+	  _diag[d * _words + output / _word_bits] |= (word_t)1 << ( output % _word_bits );
+	}
+      }
+
+      for ( int p = 0; p < _square; ++p ) {
+	int const d = ( _pri + p ) % _square;
+	word_t * const diag = &_diag[d * _words];
+	for ( int w = 0; w < _words; ++w ) {
+	  for ( word_t b = diag[w] & _free_out[w]; b; b &= b - 1 ) {
+	    int const output = w * _word_bits + __builtin_ctzll( b );
+	    int const input = ( d + _square - output ) % _square;
+	    if ( _inmatch[input] == -1 ) {
+	      // Grant!
+	      _inmatch[input] = output;
+	      _outmatch[output] = input;
+	      _free_out[w] &= ~( (word_t)1 << ( output % _word_bits ) );
+	      if(first_diag < 0) {
+		first_diag = input + output;
+	      }
+	    }
+	  }
+	  diag[w] = 0;
+	}
+      }
+    }
+
+    for ( int w = 0; w < _words; ++w ) {
+      _free_out[w] = 0;
+    }
+  }
+
+  _num_requests = 0;
+  _last_in = -1;
+  _last_out = -1;
+  _priorities.clear();
+  
+  assert(first_diag >= 0);
+
+  // Round-robin the priority diagonal
+  _pri = ( ( _skip_diags ? first_diag : _pri ) + 1 ) % _square;
+}
@@ -0,0 +1,55 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _WAVEFRONT_BITSET_HPP_
+#define _WAVEFRONT_BITSET_HPP_
+
+#include <vector>
+#include <stdint.h>
+
+#include "wavefront.hpp"
+
+// Wavefront allocator that keeps, for each priority level, one bitset of
+// requested outputs per diagonal of the request matrix; a diagonal is then
+// scanned a machine word at a time instead of cell by cell.
+class WavefrontBitset : public Wavefront {
+
+  typedef uint64_t word_t;
+  static const int _word_bits = 64;
+
+  int _words;
+  vector<word_t> _diag;
+  vector<word_t> _free_out;
+
+public:
+  WavefrontBitset( Module *parent, const string& name,
+		   int inputs, int outputs, bool skip_diags = false );
+
+  virtual void Allocate( );
+};
+
+#endif
@@ -33,6 +33,7 @@
 
 #include "arbiter.hpp"
 #include "roundrobin_arb.hpp"
+#include "roundrobin_bitset_arb.hpp"
 #include "matrix_arb.hpp"
 #include "tree_arb.hpp"
 
@@ -57,6 +58,7 @@ void Arbiter::AddRequest( int input, int id, int pri )
   assert( !_request[input].valid );
 
   _num_reqs++ ;
+  _valid_inputs.push_back(input) ;
   _request[input].valid = true ;
   _request[input].id = id ;
   _request[input].pri = pri ;
@@ -81,8 +83,9 @@ void Arbiter::Clear()
   if(_num_reqs > 0) {
     
     // clear the request vector
-    for ( int i = 0; i < _size ; i++ )
-      _request[i].valid = false ;
+    for ( size_t i = 0; i < _valid_inputs.size() ; i++ )
+      _request[_valid_inputs[i]].valid = false ;
+    _valid_inputs.clear() ;
     _num_reqs = 0 ;
     _selected = -1;
   }
@@ -94,6 +97,8 @@ Arbiter *Arbiter::NewArbiter( Module *parent, const string& name,
   Arbiter *a = NULL;
   if(arb_type == "round_robin") {
     a = new RoundRobinArbiter( parent, name, size );
+  } else if(arb_type == "round_robin_bitset") {
+    a = new RoundRobinBitsetArbiter( parent, name, size );
   } else if(arb_type == "matrix") {
     a = new MatrixArbiter( parent, name, size );
   } else if(arb_type.substr(0, 5) == "tree(") {
@@ -51,6 +51,9 @@ protected:
   vector<entry_t> _request ;
   int  _size ;
 
+  // inputs with a valid request, so Clear() only touches those
+  vector<int> _valid_inputs ;
+
   int  _selected ;
   int _highest_pri;
   int _best_input;
@@ -0,0 +1,134 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  RoundRobinBitset: Round Robin Arbiter over request bitmasks
+//
+//  Grants are the same as RoundRobinArbiter: the highest priority wins,
+//  and ties go to the first input at or after the pointer.
+//
+// ----------------------------------------------------------------------
+
+#include "roundrobin_bitset_arb.hpp"
+#include <iostream>
+#include <cassert>
+
+using namespace std ;
+
+RoundRobinBitsetArbiter::RoundRobinBitsetArbiter( Module *parent,
+						  const string &name,
+						  int size ) 
+  : Arbiter( parent, name, size ), _pointer( 0 ), _req_id( size, -1 ),
+    _req_pri( size, 0 ), _top_pri( 0 ) {
+  _words = ( size + _word_bits - 1 ) / _word_bits ;
+  _top_mask.resize( _words, 0 ) ;
+}
+
+void RoundRobinBitsetArbiter::PrintState() const  {
+  cout << "Round Robin Priority Pointer: " << endl ;
+  cout << "  _pointer = " << _pointer << endl ;
+}
+
+void RoundRobinBitsetArbiter::UpdateState() {
+  // update priority matrix using last grant
+  if ( _selected > -1 ) 
+    _pointer = ( _selected + 1 ) % _size ;
+}
+
+void RoundRobinBitsetArbiter::AddRequest( int input, int id, int pri )
+{
+  assert( ( 0 <= input ) && ( input < _size ) ) ;
+
+  _req_id[input] = id ;
+  _req_pri[input] = pri ;
+
+  // a new highest priority means the requests seen so far cannot win
+  bool const higher = ( _num_reqs == 0 ) || ( pri > _top_pri ) ;
+  if ( _words == 1 ) {
+    // priorities arrive in no particular order, so avoid branching on them
+    word_t const mask = higher ? 0 : _top_mask[0] ;
+    _top_pri = higher ? pri : _top_pri ;
+    _top_mask[0] = mask | ( ( pri == _top_pri ) ? (word_t)1 << input : 0 ) ;
+  } else {
+    if ( higher ) {
+      for ( int w = 0 ; w < _words ; ++w ) {
+	_top_mask[w] = 0 ;
+      }
+      _top_pri = pri ;
+    }
+    if ( pri == _top_pri ) {
+      _top_mask[input / _word_bits] |= (word_t)1 << ( input % _word_bits ) ;
+    }
+  }
+  ++_num_reqs ;
+}
+
+int RoundRobinBitsetArbiter::Arbitrate( int* id, int* pri ) {
+
+  _selected = -1 ;
+
+  if ( _num_reqs > 0 ) {
+    if ( _words == 1 ) {
+      // rotate the pointer to bit 0 and take the lowest set bit
+      word_t const m = _top_mask[0] ;
+      word_t const upper = m & ( ~(word_t)0 << _pointer ) ;
+      _selected = __builtin_ctzll( upper ? upper : m ) ;
+    } else {
+      // first set bit at or after the pointer, wrapping around
+      for ( int n = 0 ; n <= _words ; ++n ) {
+	int const w = ( _pointer / _word_bits + n ) % _words ;
+	word_t b = _top_mask[w] ;
+	if ( n == 0 ) {
+	  b &= ~(word_t)0 << ( _pointer % _word_bits ) ;
+	}
+	if ( b ) {
+	  _selected = w * _word_bits + __builtin_ctzll( b ) ;
+	  break ;
+	}
+      }
+    }
+    assert( _selected >= 0 ) ;
+    if ( id )
+      *id = _req_id[_selected] ;
+    if ( pri )
+      *pri = _req_pri[_selected] ;
+  }
+  
+  return _selected ;
+}
+
+void RoundRobinBitsetArbiter::Clear()
+{
+  if ( _num_reqs > 0 ) {
+    for ( int w = 0 ; w < _words ; ++w ) {
+      _top_mask[w] = 0 ;
+    }
+    _num_reqs = 0 ;
+    _selected = -1 ;
+  }
+}
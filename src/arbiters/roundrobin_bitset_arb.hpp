@@ -0,0 +1,82 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  RoundRobinBitset: Round Robin Arbiter over request bitmasks
+//
+// ----------------------------------------------------------------------
+
+#ifndef _ROUNDROBIN_BITSET_HPP_
+#define _ROUNDROBIN_BITSET_HPP_
+
+#include <stdint.h>
+
+#include "arbiter.hpp"
+
+class RoundRobinBitsetArbiter : public Arbiter {
+
+  typedef uint64_t word_t;
+  static const int _word_bits = 64;
+
+  // Priority pointer
+  int  _pointer ;
+
+  int  _words ;
+
+  // Request metadata per input; the base class's request entries are not
+  // used, so requests are only recorded here and in the mask below.
+  vector<int> _req_id ;
+  vector<int> _req_pri ;
+
+  // Inputs requesting at the highest priority among the current requests;
+  // only they can win.
+  vector<word_t> _top_mask ;
+  int  _top_pri ;
+
+public:
+
+  // Constructors
+  RoundRobinBitsetArbiter( Module *parent, const string &name, int size ) ;
+
+  // Print priority matrix to standard output
+  virtual void PrintState() const ;
+  
+  // Update priority matrix based on last aribtration result
+  virtual void UpdateState() ; 
+
+  // Arbitrate amongst requests. Returns winning input and 
+  // updates pointers to metadata when valid pointers are passed
+  virtual int Arbitrate( int* id = 0, int* pri = 0) ;
+
+  virtual void AddRequest( int input, int id, int pri ) ;
+
+  virtual void Clear() ;
+
+} ;
+
+#endif
@@ -111,8 +111,10 @@ void TreeArbiter::Clear()
     return;
   }
   for(int i = 0; i < (int)_group_arbiters.size(); ++i) {
-    _group_arbiters[i]->Clear();
-    _group_reqs[i] = 0;
+    if(_group_reqs[i]) {
+      _group_arbiters[i]->Clear();
+      _group_reqs[i] = 0;
+    }
   }
   _global_arbiter->Clear();
   Arbiter::Clear();
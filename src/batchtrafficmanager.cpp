@@ -198,6 +198,7 @@ void BatchTrafficManager::_RetireFlit(Flit *f, int dest)
 
   // Inject a flit into ROB
   _reordering_vect_size[f->src][dest] += 1;
+  ++_rob_occupancy[dest];
 
   // THO: Total ROB
   // int total_rob = 0;
@@ -239,6 +240,7 @@ void BatchTrafficManager::_RetireFlit(Flit *f, int dest)
     // Eject a flit from ROB
     _reordering_vect_size[temp->src][dest] -= 1;
     assert(_reordering_vect_size[temp->src][dest] >= 0);
+    --_rob_occupancy[dest];
 
     TrafficManager::_RetireFlit(temp, dest);
 
@@ -279,7 +281,7 @@ int BatchTrafficManager::_IssueMessage( int source, int cl )
       }
     } else {
       // THO: Active and hotspot
-      if ((_compute_nodes.count(source) > 0) && !_hs_dests.count(source)) {
+      if (IsComputeNode(source) && !IsHotspotDest(source)) {
       // if (1){
         if ((_injection_process[cl]->test(source) || batch_send_all[cl]) && (_message_seq_no[source] < _batch_size) && ((_max_outstanding <= 0) || (_requestsOutstanding[source] < _max_outstanding))) {
 	        //coin toss to determine request type.
@@ -291,7 +293,7 @@ int BatchTrafficManager::_IssueMessage( int source, int cl )
     }
   } else { //normal
     // THO: Active and hotspot
-    if ((_compute_nodes.count(source) > 0) && !_hs_dests.count(source)) {
+    if (IsComputeNode(source) && !IsHotspotDest(source)) {
     // if (1){
       if ((_injection_process[cl]->test(source) || batch_send_all[cl]) && (_message_seq_no[source] < _batch_size) && ((_max_outstanding <= 0) || (_requestsOutstanding[source] < _max_outstanding))) {
         result = _GetNextMessageSize(cl);
@@ -326,10 +328,13 @@ bool BatchTrafficManager::_SingleSim( )
     cout << "Sending batch " << batch_index + 1 << " (" << _batch_size << " packets)..." << endl;
     do {
       _Step();
+      if(_deadlocked) {
+        return false;
+      }
       batch_complete = true;
       for(int i = 0; i < _nodes; ++i) {
         // THO: Active and hotspot
-        if ((_compute_nodes.count(i) > 0) && !_hs_dests.count(i)) {
+        if (IsComputeNode(i) && !IsHotspotDest(i)) {
         // if (1){  
           if (_message_seq_no[i] < _batch_size) {
 	          batch_complete = false;
@@ -350,11 +355,14 @@ bool BatchTrafficManager::_SingleSim( )
     
     bool packets_left = false;
     for(int c = 0; c < _classes; ++c) {
-      packets_left |= !_total_in_flight_flits[c].empty();
+      packets_left |= (_InFlightFlits(c) > 0);
     }
     
     while( packets_left ) { 
       _Step( ); 
+      if(_deadlocked) {
+        return false;
+      }
       
       ++empty_steps;
       
@@ -365,7 +373,7 @@ bool BatchTrafficManager::_SingleSim( )
       
       packets_left = false;
       for(int c = 0; c < _classes; ++c) {
-        packets_left |= !_total_in_flight_flits[c].empty();
+        packets_left |= (_InFlightFlits(c) > 0);
       }
     }
     cout << endl;
@@ -0,0 +1,662 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*bench.cpp
+ *
+ *Microbenchmarks for the simulator's hot building blocks: every allocator
+ *and arbiter type on synthetic request matrices, every routing function on
+ *random source/destination paths through a small instance of its topology,
+ *and the router hash helpers. Built by "make bench"; run with -h for usage.
+ *
+ *Each benchmark reports ns/op and heap allocations/op. With -b, results are
+ *compared against a file written earlier with -o, and the exit status is
+ *non-zero if any benchmark got slower than the given tolerance.
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "booksim.hpp"
+#include "booksim_config.hpp"
+#include "random_utils.hpp"
+#include "routefunc.hpp"
+#include "outputset.hpp"
+#include "flit.hpp"
+#include "network.hpp"
+#include "kncube.hpp"
+#include "fly.hpp"
+#include "cmesh.hpp"
+#include "flatfly_onchip.hpp"
+#include "qtree.hpp"
+#include "tree4.hpp"
+#include "fattree.hpp"
+#include "fattree2.hpp"
+#include "anynet.hpp"
+#include "dragonfly.hpp"
+#include "allocator.hpp"
+#include "arbiter.hpp"
+
+//////////////////////////////////////////////////////////////////////
+// heap allocation counting
+
+static long long gAllocs = 0;
+
+void * operator new( size_t size )
+{
+  ++gAllocs;
+  void * p = malloc(size ? size : 1);
+  if(!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete( void * p ) throw()
+{
+  free(p);
+}
+
+void operator delete( void * p, size_t ) throw()
+{
+  free(p);
+}
+
+static long long Now( )
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+//////////////////////////////////////////////////////////////////////
+// measurement
+
+struct Result {
+  double ns;
+  double allocs;
+  bool ok;
+};
+
+static double gMinTime = 0.1;
+static bool gVerbose = false;
+
+// Runs op(arg, iters) with growing iteration counts until one batch takes
+// at least gMinTime seconds; op returns the number of operations it did.
+static Result Measure( long long (*op)(void *, long long), void * arg )
+{
+  Result r;
+  op(arg, 1); // warm-up, also sizes any lazily grown state
+  long long iters = 1;
+  while(true) {
+    long long const allocs = gAllocs;
+    long long const start = Now();
+    long long const ops = op(arg, iters);
+    long long const elapsed = Now() - start;
+    if((elapsed >= gMinTime * 1e9) || (iters >= (1LL << 40))) {
+      r.ns = (double)elapsed / (double)ops;
+      r.allocs = (double)(gAllocs - allocs) / (double)ops;
+      r.ok = true;
+      return r;
+    }
+    iters *= (elapsed > 0) ? max(2LL, min(100LL, (long long)(gMinTime * 2e9 / elapsed))) : 100;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////
+// allocators and arbiters
+
+struct sRequest {
+  int in;
+  int out;
+  int pri;
+};
+
+struct AllocShape {
+  char const * name;
+  int inputs;
+  int outputs;
+  double active; // fraction of inputs with requests
+  int reqs;      // requests per active input, in one aligned block
+};
+
+// switch allocation at mesh and high-radix routers, and VC allocation with
+// 8 VCs per port, where an input requests all VCs of one output port
+static AllocShape const gAllocShapes[] = {
+  { "sw5x5", 5, 5, 0.6, 1 },
+  { "sw32x32", 32, 32, 0.5, 1 },
+  { "vc40x40", 40, 40, 0.25, 8 },
+  { "vc256x256", 256, 256, 0.1, 8 }
+};
+
+static int const gPatterns = 64;
+
+static vector<vector<sRequest> > MakePatterns( AllocShape const & s )
+{
+  vector<vector<sRequest> > patterns(gPatterns);
+  for(int p = 0; p < gPatterns; ++p) {
+    for(int in = 0; in < s.inputs; ++in) {
+      if(RandomFloat() >= s.active) {
+	continue;
+      }
+      int const blocks = s.outputs / s.reqs;
+      int const first = RandomInt(blocks - 1) * s.reqs;
+      for(int o = 0; o < s.reqs; ++o) {
+	sRequest r;
+	r.in = in;
+	r.out = first + o;
+	r.pri = RandomInt(3);
+	patterns[p].push_back(r);
+      }
+    }
+  }
+  return patterns;
+}
+
+struct AllocBench {
+  Allocator * alloc;
+  vector<vector<sRequest> > patterns;
+};
+
+static long long RunAllocator( void * arg, long long iters )
+{
+  AllocBench * b = (AllocBench *)arg;
+  for(long long i = 0; i < iters; ++i) {
+    vector<sRequest> const & reqs = b->patterns[i % gPatterns];
+    b->alloc->Clear();
+    for(size_t r = 0; r < reqs.size(); ++r) {
+      b->alloc->AddRequest(reqs[r].in, reqs[r].out, 1, reqs[r].pri, reqs[r].pri);
+    }
+    b->alloc->Allocate();
+  }
+  return iters;
+}
+
+struct ArbBench {
+  Arbiter * arb;
+  vector<vector<sRequest> > patterns;
+};
+
+static long long RunArbiter( void * arg, long long iters )
+{
+  ArbBench * b = (ArbBench *)arg;
+  for(long long i = 0; i < iters; ++i) {
+    vector<sRequest> const & reqs = b->patterns[i % gPatterns];
+    for(size_t r = 0; r < reqs.size(); ++r) {
+      b->arb->AddRequest(reqs[r].in, reqs[r].out, reqs[r].pri);
+    }
+    if(b->arb->Arbitrate() >= 0) {
+      b->arb->UpdateState();
+    }
+    b->arb->Clear();
+  }
+  return iters;
+}
+
+//////////////////////////////////////////////////////////////////////
+// routing functions
+
+// small instances of each topology; routing functions of topologies not
+// listed here (e.g. anynet, which needs a network file) are skipped
+static map<string, string> TopologyParams( )
+{
+  map<string, string> t;
+  t["mesh"] = "k=8 n=2";
+  t["torus"] = "k=8 n=2";
+  t["cmesh"] = "k=4 n=2 c=4 x=4 y=4 xr=2 yr=2";
+  t["fly"] = "k=8 n=1";
+  t["qtree"] = "k=4 n=3";
+  t["tree4"] = "k=4 n=3";
+  t["fattree"] = "k=16 n=2";
+  t["fattree2"] = "k=8 n=2";
+  t["flatfly"] = "k=4 n=2 c=4 x=4 y=4 xr=2 yr=2";
+  t["dragonflynew"] = "k=4 n=1";
+  return t;
+}
+
+// extra settings some routing functions insist on
+static string RoutingParams( string const & name )
+{
+  if(name.find("_ni_") != string::npos) {
+    return "num_vcs=128"; // two VCs (ring halves) per destination
+  } else if(name == "ugal_dragonflynew") {
+    return "num_vcs=3";
+  } else if(name == "nca_hybrid_fattree2") {
+    return "k=16"; // hashes onto one of 16 up ports
+  }
+  return "";
+}
+
+static void Configure( BookSimConfig & config, string const & topo, 
+		       string const & params, string const & rf )
+{
+  config.Assign("topology", topo);
+  config.Assign("routing_function", rf);
+  istringstream is(params);
+  string kv;
+  while(is >> kv) {
+    size_t const eq = kv.find('=');
+    config.Assign(kv.substr(0, eq), atoi(kv.substr(eq + 1).c_str()));
+  }
+}
+
+struct RouteBench {
+  tRoutingFunction rf;
+  Network * net;
+  vector<pair<int, int> > flows;
+  vector<vector<int> > out_link;
+  vector<FlitChannel *> links;
+};
+
+// follows each flow from its injection channel to its ejection channel,
+// taking the highest-priority output at every hop
+static long long RunRoute( void * arg, long long iters )
+{
+  RouteBench * b = (RouteBench *)arg;
+  OutputSet route;
+  long long calls = 0;
+  int const max_hops = b->links.size();
+  for(long long i = 0; i < iters; ++i) {
+    pair<int, int> const & flow = b->flows[i % b->flows.size()];
+    Flit * f = Flit::New();
+    f->id = i;
+    f->pid = i;
+    f->src = flow.first;
+    f->dest = flow.second;
+    f->head = true;
+    f->tail = true;
+    route.Clear();
+    b->rf(NULL, f, -1, &route, true);
+    ++calls;
+    f->vc = route.GetSet().begin()->vc_start;
+    FlitChannel const * channel = b->links[f->src];
+    while(channel->GetSink() && (f->hops <= max_hops)) {
+      Router const * const router = channel->GetSink();
+      route.Clear();
+      b->rf(router, f, channel->GetSinkPort(), &route, false);
+      ++calls;
+      assert(!route.GetSet().empty());
+      OutputSet::sSetElement const & se = *route.GetSet().begin();
+      assert((se.output_port >= 0) && (se.output_port < router->NumOutputs()));
+      f->vc = se.vc_start;
+      channel = b->links[b->out_link[router->GetID()][se.output_port]];
+      ++f->hops;
+    }
+    f->Free();
+  }
+  return calls;
+}
+
+static Result BenchRoute( string const & name, string const & topo, string const & params )
+{
+  BookSimConfig config;
+  Configure(config, topo, params + " " + RoutingParams(name),
+	    name.substr(0, name.size() - topo.size() - 1));
+  InitializeRoutingMap(config);
+  RouteBench b;
+  b.net = Network::New(config, "network");
+  b.rf = gRoutingFunctionMap[name];
+
+  _compute_nodes.clear();
+  _memory_nodes.clear();
+  for(int n = 0; n < gNodes; ++n) {
+    _compute_nodes.insert(n);
+  }
+  UpdateNodeRoles(gNodes);
+
+  vector<FlitChannel *> const & inject = b.net->GetInject();
+  b.links.assign(inject.begin(), inject.end());
+  vector<Router *> const & routers = b.net->GetRouters();
+  // some topologies (e.g. qtree) encode their position in the router ID,
+  // so the per-router tables are indexed by ID rather than by position
+  for(size_t r = 0; r < routers.size(); ++r) {
+    if(!routers[r]) {
+      continue; // fattree2 over-allocates its router table
+    }
+    int const id = routers[r]->GetID();
+    if(id >= (int)b.out_link.size()) {
+      b.out_link.resize(id + 1);
+    }
+    for(int o = 0; o < routers[r]->NumOutputs(); ++o) {
+      b.out_link[id].push_back(b.links.size());
+      b.links.push_back(routers[r]->GetOutputChannel(o));
+    }
+  }
+  for(int i = 0; i < 256; ++i) {
+    int const src = RandomInt(gNodes - 1);
+    int dest = RandomInt(gNodes - 2);
+    if(dest >= src) {
+      ++dest;
+    }
+    b.flows.push_back(make_pair(src, dest));
+  }
+  return Measure(RunRoute, &b);
+}
+
+// Routing functions may call Error() or assert on configurations they do
+// not support, so each one runs in its own process.
+static Result BenchRouteIsolated( string const & name, string const & topo, string const & params )
+{
+  Result r;
+  r.ok = false;
+  int fds[2];
+  if(pipe(fds) != 0) {
+    return r;
+  }
+  cout.flush();
+  pid_t const pid = fork();
+  if(pid == 0) {
+    close(fds[0]);
+    if(!gVerbose) {
+      int const null_fd = open("/dev/null", O_WRONLY);
+      dup2(null_fd, STDOUT_FILENO);
+      dup2(null_fd, STDERR_FILENO);
+    }
+    Result const child = BenchRoute(name, topo, params);
+    ssize_t const written = write(fds[1], &child, sizeof(child));
+    _exit(written == sizeof(child) ? 0 : 1);
+  }
+  close(fds[1]);
+  ssize_t const got = read(fds[0], &r, sizeof(r));
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if((pid < 0) || (got != sizeof(r)) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+    r.ok = false;
+    if(gVerbose && WIFSIGNALED(status)) {
+      cerr << name << ": killed by signal " << WTERMSIG(status) << endl;
+    }
+  }
+  return r;
+}
+
+//////////////////////////////////////////////////////////////////////
+// hash helpers
+
+struct HashBench {
+  Router const * router;
+  vector<int> pool;
+};
+
+static long long RunCRC8( void * arg, long long iters )
+{
+  HashBench * b = (HashBench *)arg;
+  char data[8];
+  int sink = 0;
+  for(long long i = 0; i < iters; ++i) {
+    memcpy(data, &i, sizeof(data));
+    sink += b->router->CRC8(data, sizeof(data));
+  }
+  return iters + (sink & 0);
+}
+
+static long long RunCRC16( void * arg, long long iters )
+{
+  HashBench * b = (HashBench *)arg;
+  uint8_t data[16];
+  int sink = 0;
+  memset(data, 0, sizeof(data));
+  for(long long i = 0; i < iters; ++i) {
+    memcpy(data, &i, sizeof(i));
+    sink += b->router->crc16(data, sizeof(data));
+  }
+  return iters + (sink & 0);
+}
+
+static long long RunCRC16Int( void * arg, long long iters )
+{
+  HashBench * b = (HashBench *)arg;
+  int sink = 0;
+  for(long long i = 0; i < iters; ++i) {
+    sink += b->router->crc16_int((uint32_t)i);
+  }
+  return iters + (sink & 0);
+}
+
+static long long RunGenerateCyclic( void * arg, long long iters )
+{
+  HashBench * b = (HashBench *)arg;
+  int sink = 0;
+  for(long long i = 0; i < iters; ++i) {
+    sink += b->router->GenerateCyclic(16, b->pool);
+  }
+  return iters + (sink & 0);
+}
+
+//////////////////////////////////////////////////////////////////////
+// reporting
+
+static map<string, Result> gBaseline;
+static double gTolerance = 0.10;
+static int gRegressions = 0;
+static ostream * gOut = NULL;
+static string gFilter;
+
+static bool Selected( string const & name )
+{
+  return gFilter.empty() || (name.find(gFilter) != string::npos);
+}
+
+static void Report( string const & name, Result const & r )
+{
+  cout << setw(48) << left << name << right;
+  if(!r.ok) {
+    cout << setw(12) << "failed" << endl;
+    return;
+  }
+  cout << setw(12) << fixed << setprecision(1) << r.ns
+       << setw(12) << setprecision(2) << r.allocs;
+  map<string, Result>::const_iterator base = gBaseline.find(name);
+  if(base != gBaseline.end()) {
+    double const ratio = r.ns / base->second.ns;
+    cout << setw(12) << setprecision(1) << base->second.ns
+	 << setw(9) << setprecision(3) << ratio;
+    // allocation counts are averages over the timed runs, so they get
+    // the same relative tolerance, plus half an allocation for baselines
+    // that do not allocate at all
+    if((ratio > 1.0 + gTolerance) || 
+       (r.allocs > base->second.allocs * (1.0 + gTolerance) + 0.5)) {
+      cout << "  REGRESSION";
+      ++gRegressions;
+    }
+  }
+  cout << endl;
+  if(gOut) {
+    *gOut << name << ' ' << r.ns << ' ' << r.allocs << endl;
+  }
+}
+
+static void LoadBaseline( string const & filename )
+{
+  ifstream in(filename.c_str());
+  if(!in) {
+    cerr << "Cannot open baseline " << filename << endl;
+    exit(-1);
+  }
+  string line;
+  while(getline(in, line)) {
+    if(line.empty() || (line[0] == '#')) {
+      continue;
+    }
+    istringstream is(line);
+    string name;
+    Result r;
+    if(is >> name >> r.ns >> r.allocs) {
+      r.ok = true;
+      gBaseline[name] = r;
+    }
+  }
+}
+
+static void Usage( char const * prog )
+{
+  cerr << "Usage: " << prog << " [-t min_seconds] [-o results] [-b baseline]"
+       << " [-r tolerance] [-v] [filter]" << endl;
+  exit(-1);
+}
+
+int main( int argc, char **argv )
+{
+  int c;
+  while((c = getopt(argc, argv, "t:o:b:r:vh")) != -1) {
+    switch(c) {
+    case 't': gMinTime = atof(optarg); break;
+    case 'o': gOut = new ofstream(optarg); break;
+    case 'b': LoadBaseline(optarg); break;
+    case 'r': gTolerance = atof(optarg); break;
+    case 'v': gVerbose = true; break;
+    default: Usage(argv[0]);
+    }
+  }
+  if(optind < argc) {
+    gFilter = argv[optind];
+  }
+  if(gOut) {
+    *gOut << "# name ns/op allocs/op" << endl;
+  }
+
+  RandomSeed(0);
+  BookSimConfig config;
+  InitializeRoutingMap(config);
+
+  cout << setw(48) << left << "benchmark" << right
+       << setw(12) << "ns/op" << setw(12) << "allocs/op";
+  if(!gBaseline.empty()) {
+    cout << setw(12) << "base ns/op" << setw(9) << "ratio";
+  }
+  cout << endl;
+
+  char const * const alloc_types[] = {
+    "max_size", "max_size_bitset", "pim", "islip", "loa", "wavefront",
+    "rr_wavefront", "wavefront_bitset", "rr_wavefront_bitset", "select",
+    "separable_input_first", "separable_output_first"
+  };
+  for(size_t s = 0; s < sizeof(gAllocShapes) / sizeof(gAllocShapes[0]); ++s) {
+    AllocShape const & shape = gAllocShapes[s];
+    AllocBench b;
+    b.patterns = MakePatterns(shape);
+    for(size_t t = 0; t < sizeof(alloc_types) / sizeof(alloc_types[0]); ++t) {
+      string const name = string("alloc/") + alloc_types[t] + "/" + shape.name;
+      if(!Selected(name)) {
+	continue;
+      }
+      b.alloc = Allocator::NewAllocator(NULL, "alloc", alloc_types[t],
+					shape.inputs, shape.outputs, &config);
+      Report(name, Measure(RunAllocator, &b));
+      delete b.alloc;
+    }
+  }
+
+  char const * const arb_types[] = {
+    "round_robin", "round_robin_bitset", "matrix", "tree(4,round_robin)"
+  };
+  int const arb_sizes[] = { 8, 64 };
+  for(size_t s = 0; s < sizeof(arb_sizes) / sizeof(arb_sizes[0]); ++s) {
+    AllocShape const shape = { "", arb_sizes[s], 1, 0.5, 1 };
+    ArbBench b;
+    b.patterns = MakePatterns(shape);
+    for(size_t t = 0; t < sizeof(arb_types) / sizeof(arb_types[0]); ++t) {
+      ostringstream name;
+      name << "arb/" << arb_types[t] << "/" << arb_sizes[s];
+      if(!Selected(name.str())) {
+	continue;
+      }
+      b.arb = Arbiter::NewArbiter(NULL, "arb", arb_types[t], arb_sizes[s]);
+      Report(name.str(), Measure(RunArbiter, &b));
+      delete b.arb;
+    }
+  }
+
+  // topology-specific routing functions are registered by the networks
+  KNCube::RegisterRoutingFunctions();
+  CMesh::RegisterRoutingFunctions();
+  KNFly::RegisterRoutingFunctions();
+  QTree::RegisterRoutingFunctions();
+  Tree4::RegisterRoutingFunctions();
+  FatTree::RegisterRoutingFunctions();
+  FatTree2::RegisterRoutingFunctions();
+  FlatFlyOnChip::RegisterRoutingFunctions();
+  AnyNet::RegisterRoutingFunctions();
+  DragonFlyNew::RegisterRoutingFunctions();
+  map<string, string> const topologies = TopologyParams();
+  for(map<string, tRoutingFunction>::const_iterator rf = gRoutingFunctionMap.begin();
+      rf != gRoutingFunctionMap.end(); ++rf) {
+    string const & name = rf->first;
+    size_t const sep = name.find_last_of('_');
+    map<string, string>::const_iterator t = topologies.find(name.substr(sep + 1));
+    if((t == topologies.end()) || !Selected("route/" + name)) {
+      continue;
+    }
+    // valiant_torus and valiant_ni_torus read the dateline partition from
+    // dor_next_torus, which only sets it when turning into a new
+    // dimension, so both assert on any torus whatever the VC count
+    if((name == "valiant_torus") || (name == "valiant_ni_torus")) {
+      continue;
+    }
+    Report("route/" + name, BenchRouteIsolated(name, t->first, t->second));
+  }
+
+  BookSimConfig mesh_config;
+  Configure(mesh_config, "mesh", "k=4 n=2", "dim_order");
+  InitializeRoutingMap(mesh_config);
+  // network construction is chatty
+  ofstream null_stream("/dev/null");
+  streambuf * const cout_buf = cout.rdbuf(null_stream.rdbuf());
+  Network * mesh = Network::New(mesh_config, "network");
+  cout.rdbuf(cout_buf);
+  HashBench h;
+  h.router = mesh->GetRouters()[0];
+  if(Selected("hash/crc8")) Report("hash/crc8", Measure(RunCRC8, &h));
+  if(Selected("hash/crc16")) Report("hash/crc16", Measure(RunCRC16, &h));
+  if(Selected("hash/crc16_int")) Report("hash/crc16_int", Measure(RunCRC16Int, &h));
+  if(Selected("hash/generate_cyclic")) Report("hash/generate_cyclic", Measure(RunGenerateCyclic, &h));
+  delete mesh;
+
+  if(gOut) {
+    delete gOut;
+  }
+  if(gRegressions > 0) {
+    cout << gRegressions << " benchmark(s) regressed beyond " 
+	 << gTolerance * 100.0 << "%." << endl;
+    return 1;
+  }
+  return 0;
+}
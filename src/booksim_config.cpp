@@ -54,6 +54,9 @@ BookSimConfig::BookSimConfig( )
   _int_map["c"] = 1; //concentration
   AddStrField( "routing_function", "none" );
 
+  _int_map["flowlet_gap"] = 100;        // idle cycles before a flowlet may switch up-port (nca_flowlet)
+  _int_map["flowlet_table_size"] = 256; // flowlet entries per router (nca_flowlet)
+
   _int_map["active_concentration"] = -1; // per router
   _int_map["compute_nodes"] = 8;
   _int_map["memory_nodes"] = 8;
@@ -136,6 +139,12 @@ BookSimConfig::BookSimConfig( )
   _int_map["vc_shuffle_requests"] = 0; // rearrange VC allocator requests to avoid unfairness
 
   _int_map["hold_switch_for_packet"] = 0; // hold a switch config for the entire packet
+  _int_map["iq_specialize"] = 1; // use compile-time specialized IQ router pipelines where available
+
+  //==== Lite router =======================================
+
+  _int_map["lite_pipeline_delay"] = -1; // extra cycles before switch traversal; -1: derive from routing/VC/switch alloc delays
+  _int_map["lite_output_buffer_size"] = -1; // flits per output queue; -1: vc_buf_size
 
   _int_map["input_speedup"]     = 1;  // expansion of input ports into crossbar
   _int_map["output_speedup"]    = 1;  // expansion of output ports into crossbar
@@ -224,12 +233,36 @@ BookSimConfig::BookSimConfig( )
   _int_map["batch_count"] = 1;
   _int_map["max_outstanding_requests"] = 0; // 0 = unlimited
 
+  // trace only -- binary message trace (see booksim_msgtrace)
+  AddStrField( "trace_file", "" );
+  _int_map["trace_class"] = 0; // class whose messages come from the trace
+
+  // collective only -- closed-loop workloads
+  AddStrField( "collective", "ring_allreduce" ); // ring_allreduce, tree_allreduce, alltoall, ps, dag
+  AddStrField( "collective_dag", "" ); // message DAG for collective = dag
+  _int_map["collective_size"] = 16; // flits per message
+  _int_map["collective_delay"] = 0; // cycles from last dependency to issue
+  _int_map["collective_root"] = -1; // tree root / server; -1 = first compute node
+  _int_map["collective_class"] = 0;
+  _int_map["collective_iterations"] = 1;
+
+  // library interface only (libbooksim.hpp)
+  _int_map["completion_queue_size"] = 4096; // deliveries buffered for PollDelivery
+
   // Use read/write request reply scheme
   _int_map["use_read_write"] = 0;
   AddStrField("use_read_write", ""); // workaraound to allow for vector specification
   _float_map["write_fraction"] = 0.5;
   AddStrField("write_fraction", "");
 
+  // service model of the nodes answering read/write requests
+  AddStrField("endpoint_model", "ideal"); // ideal or banked
+  _int_map["endpoint_banks"] = 4; // requests served in parallel
+  _int_map["endpoint_latency"] = 20; // mean service time in cycles
+  AddStrField("endpoint_service", "fixed"); // fixed, uniform or exponential
+  _float_map["endpoint_rate"] = 0.0; // max requests starting service per cycle; 0 = no limit
+  _int_map["endpoint_queue_depth"] = 0; // requests before credits are held back; 0 = unlimited
+
   _float_map["mixed_msg_fraction"] = 0.0;
   AddStrField("mixed_msg_fraction", "");
 
@@ -292,9 +325,15 @@ BookSimConfig::BookSimConfig( )
   // types:
   //   latency    - average + latency distribution for a particular injection rate
   //   throughput - sustained throughput for a particular injection rate
+  //   flow       - fluid approximation of channel loads, see flow_model.cpp
 
   AddStrField( "sim_type", "latency" );
 
+  _int_map["flow_samples"] = 16;            // destinations sampled per source in the flow model
+  _float_map["flow_injection_rate"] = 1.0;  // offered load per source (flits/cycle) in the flow model
+  _int_map["flow_top_links"] = 10;          // number of most loaded channels to report
+  AddStrField("flow_util_out", "");         // optional per-channel utilization CSV
+
   _int_map["warmup_periods"] = 3; // number of samples periods to "warm-up" the simulation
 
   _int_map["sample_period"] = 1000; // how long between measurements
@@ -340,7 +379,10 @@ BookSimConfig::BookSimConfig( )
 
   _int_map["print_csv_results"] = 0;
 
+  _int_map["print_perf_stats"] = 0; // print simulator speed and memory use after the run
+
   _int_map["deadlock_warn_timeout"] = 256;
+  _int_map["deadlock_abort"] = 1; // on a deadlock warning, check the VC wait-for graph and abort on a cycle
 
   _int_map["viewer_trace"] = 0;
 
@@ -352,9 +394,27 @@ BookSimConfig::BookSimConfig( )
 
   AddStrField("watch_out", "");
 
+  AddStrField("event_trace_out", ""); // binary event trace, see booksim_tracedec
+  _int_map["event_trace_buffer"] = 65536; // records staged before each flush
+
   AddStrField("stats_out", "");
+  AddStrField("results_out", ""); // columnar binary results, see booksim_resultsdec
+  AddStrField("snapshot_out", ""); // periodic binary network snapshots, see booksim_snapdec
+  _int_map["snapshot_interval"] = 1000; // cycles between snapshots
+  _int_map["snapshot_buffer"] = 64; // snapshots staged before each write
+  AddStrField("telemetry_socket", ""); // UNIX socket for live progress updates
+  _int_map["telemetry_interval"] = 10000; // cycles between telemetry updates
+
+  // optional statistics; each costs simulation speed when enabled
+  _int_map["track_chan_utils"] = 0; // windowed utilization of every channel
+  _int_map["chan_util_top"] = 10; // hottest links to report (0 = all)
+  AddStrField("chan_util_out", ""); // per-window utilization time series (CSV)
+  _int_map["track_wait_time"] = 0;  // endpoint waiting and router service times
+  _int_map["track_flows"] = 0;      // per-class flit counts, see *_flits_out
+  _int_map["track_stalls"] = 0;     // allocation stall rates
+  _int_map["track_buffers"] = 0;    // per-class buffer occupancy
+  _int_map["track_credits"] = 0;    // credit counts, see *_credits_out
 
-#ifdef TRACK_FLOWS
   AddStrField("injected_flits_out", "");
   AddStrField("received_flits_out", "");
   AddStrField("stored_flits_out", "");
@@ -362,13 +422,10 @@ BookSimConfig::BookSimConfig( )
   AddStrField("outstanding_credits_out", "");
   AddStrField("ejected_flits_out", "");
   AddStrField("active_packets_out", "");
-#endif
 
-#ifdef TRACK_CREDITS
   AddStrField("used_credits_out", "");
   AddStrField("free_credits_out", "");
   AddStrField("max_credits_out", "");
-#endif
 
   // batch only -- packet sequence numbers
   AddStrField("sent_packets_out", "");
@@ -50,10 +50,10 @@ Module( parent, name ), _occupancy(0)
     _vc[i] = new VC(config, outputs, this, vc_name.str( ) );
   }
 
-#ifdef TRACK_BUFFERS
-  int classes = config.GetInt("classes");
-  _class_occupancy.resize(classes, 0);
-#endif
+  if(gTrackBuffers) {
+    int classes = config.GetInt("classes");
+    _class_occupancy.resize(classes, 0);
+  }
 }
 
 Buffer::~Buffer()
@@ -70,9 +70,9 @@ void Buffer::AddFlit( int vc, Flit *f )
   }
   ++_occupancy;
   _vc[vc]->AddFlit(f);
-#ifdef TRACK_BUFFERS
-  ++_class_occupancy[f->cl];
-#endif
+  if(gTrackBuffers) {
+    ++_class_occupancy[f->cl];
+  }
 }
 
 void Buffer::Display( ostream & os ) const
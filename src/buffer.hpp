@@ -35,6 +35,7 @@
 #include "outputset.hpp"
 #include "routefunc.hpp"
 #include "config_utils.hpp"
+#include "globals.hpp"
 
 class Buffer : public Module {
   
@@ -43,9 +44,7 @@ class Buffer : public Module {
 
   vector<VC*> _vc;
 
-#ifdef TRACK_BUFFERS
   vector<int> _class_occupancy;
-#endif
 
 public:
   
@@ -58,11 +57,11 @@ public:
   inline Flit *RemoveFlit( int vc )
   {
     --_occupancy;
-#ifdef TRACK_BUFFERS
-    int cl = _vc[vc]->FrontFlit()->cl;
-    assert(_class_occupancy[cl] > 0);
-    --_class_occupancy[cl];
-#endif
+    if(gTrackBuffers) {
+      int cl = _vc[vc]->FrontFlit()->cl;
+      assert(_class_occupancy[cl] > 0);
+      --_class_occupancy[cl];
+    }
     return _vc[vc]->RemoveFlit( );
   }
   
@@ -148,12 +147,10 @@ public:
     return _vc[vc]->GetOccupancy( );
   }
 
-#ifdef TRACK_BUFFERS
   inline int GetOccupancyForClass(int c) const
   {
     return _class_occupancy[c];
   }
-#endif
 
   void Display( ostream & os = cout ) const;
 };
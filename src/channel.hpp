@@ -43,6 +43,7 @@
 #include "globals.hpp"
 #include "module.hpp"
 #include "timed_module.hpp"
+#include "profiler.hpp"
 
 using namespace std;
 
@@ -99,6 +100,7 @@ T * Channel<T>::Receive() {
 
 template<typename T>
 void Channel<T>::ReadInputs() {
+  PROFILE_SCOPE("Channel::ReadInputs");
   if(_input) {
     _wait_queue.push(make_pair(GetSimTime() + _delay - 1, _input));
     _input = 0;
@@ -107,6 +109,7 @@ void Channel<T>::ReadInputs() {
 
 template<typename T>
 void Channel<T>::WriteOutputs() {
+  PROFILE_SCOPE("Channel::WriteOutputs");
   _output = 0;
   if(_wait_queue.empty()) {
     return;
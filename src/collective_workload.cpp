@@ -0,0 +1,306 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <algorithm>
+
+#include "globals.hpp"
+#include "collective_workload.hpp"
+
+CollectiveWorkload::CollectiveWorkload( Configuration const & config, int nodes )
+  : _nodes(nodes), _delivered(0)
+{
+  _name = config.GetStr("collective");
+  _size = config.GetInt("collective_size");
+  _delay = config.GetInt("collective_delay");
+  if(_size <= 0) {
+    cout << "Error: collective_size must be positive" << endl;
+    exit(-1);
+  }
+
+  if(_name == "dag") {
+    _Load(config.GetStr("collective_dag"));
+  } else {
+    vector<int> participants;
+    for(int n = 0; n < _nodes; ++n) {
+      if(IsComputeNode(n)) {
+	participants.push_back(n);
+      }
+    }
+    int const root = config.GetInt("collective_root");
+    if(root >= 0) {
+      vector<int>::iterator iter = 
+	find(participants.begin(), participants.end(), root);
+      if(iter == participants.end()) {
+	cout << "Error: collective_root " << root << " is not a compute node"
+	     << endl;
+	exit(-1);
+      }
+      rotate(participants.begin(), iter, participants.end());
+    }
+    if(participants.size() < 2) {
+      cout << "Error: Collective " << _name 
+	   << " needs at least two compute nodes" << endl;
+      exit(-1);
+    }
+
+    if(_name == "ring_allreduce") {
+      _BuildRingAllReduce(participants);
+    } else if(_name == "tree_allreduce") {
+      _BuildTreeAllReduce(participants);
+    } else if(_name == "alltoall") {
+      _BuildAllToAll(participants);
+    } else if(_name == "ps") {
+      _BuildParameterServer(participants);
+    } else {
+      cout << "Error: Unknown collective: " << _name << endl;
+      exit(-1);
+    }
+  }
+  _CheckAcyclic();
+
+  _ready.resize(_nodes);
+  Reset(0);
+}
+
+int CollectiveWorkload::_Add( int src, int dest, vector<int> const & deps )
+{
+  int const id = _messages.size();
+  Message m;
+  m.src = src;
+  m.dest = dest;
+  m.flits = _size;
+  m.deps = deps.size();
+  _messages.push_back(m);
+  for(size_t i = 0; i < deps.size(); ++i) {
+    assert((deps[i] >= 0) && (deps[i] < id));
+    _messages[deps[i]].children.push_back(id);
+  }
+  return id;
+}
+
+// reduce-scatter followed by all-gather: 2(N-1) steps in which every node
+// forwards a chunk to its successor once it has received the previous one
+void CollectiveWorkload::_BuildRingAllReduce( vector<int> const & nodes )
+{
+  int const n = nodes.size();
+  vector<int> last(n, -1);
+  for(int step = 0; step < 2 * (n - 1); ++step) {
+    vector<int> sent(n);
+    for(int i = 0; i < n; ++i) {
+      vector<int> deps;
+      int const prev = last[(i + n - 1) % n];
+      if(prev >= 0) {
+	deps.push_back(prev);
+      }
+      sent[i] = _Add(nodes[i], nodes[(i + 1) % n], deps);
+    }
+    last = sent;
+  }
+}
+
+// binary tree rooted at nodes[0]: reduce towards the root, then broadcast
+// back down
+void CollectiveWorkload::_BuildTreeAllReduce( vector<int> const & nodes )
+{
+  int const n = nodes.size();
+  vector<int> up(n, -1);
+  for(int k = n - 1; k > 0; --k) {
+    vector<int> deps;
+    for(int c = 2 * k + 1; (c <= 2 * k + 2) && (c < n); ++c) {
+      deps.push_back(up[c]);
+    }
+    up[k] = _Add(nodes[k], nodes[(k - 1) / 2], deps);
+  }
+  vector<int> down(n, -1);
+  for(int k = 1; k < n; ++k) {
+    int const parent = (k - 1) / 2;
+    vector<int> deps;
+    if(parent == 0) {
+      for(int c = 1; (c <= 2) && (c < n); ++c) {
+	deps.push_back(up[c]);
+      }
+    } else {
+      deps.push_back(down[parent]);
+    }
+    down[k] = _Add(nodes[parent], nodes[k], deps);
+  }
+}
+
+// every node sends to every other node; shift k goes to the node k ahead
+// so that no destination is targeted by everyone at once
+void CollectiveWorkload::_BuildAllToAll( vector<int> const & nodes )
+{
+  int const n = nodes.size();
+  for(int k = 1; k < n; ++k) {
+    for(int i = 0; i < n; ++i) {
+      _Add(nodes[i], nodes[(i + k) % n]);
+    }
+  }
+}
+
+// one round of a parameter server at nodes[0]: every worker pushes its
+// update, and the server returns the new parameters once it has them all
+void CollectiveWorkload::_BuildParameterServer( vector<int> const & nodes )
+{
+  int const n = nodes.size();
+  vector<int> pushes;
+  for(int w = 1; w < n; ++w) {
+    pushes.push_back(_Add(nodes[w], nodes[0]));
+  }
+  for(int w = 1; w < n; ++w) {
+    _Add(nodes[0], nodes[w], pushes);
+  }
+}
+
+void CollectiveWorkload::_Load( string const & filename )
+{
+  ifstream in(filename.c_str());
+  if(!in) {
+    cout << "Error: Unable to open collective DAG " << filename << endl;
+    exit(-1);
+  }
+  Message undefined;
+  undefined.src = -1;
+  undefined.dest = -1;
+  undefined.flits = 0;
+  undefined.deps = 0;
+  vector<vector<int> > deps;
+  string line;
+  int lineno = 0;
+  while(getline(in, line)) {
+    ++lineno;
+    size_t const start = line.find_first_not_of(" \t\r");
+    if((start == string::npos) || (line[start] == '#')) {
+      continue;
+    }
+    istringstream is(line);
+    int id, src, dest, size;
+    if(!(is >> id >> src >> dest >> size) ||
+       (id < 0) || (src < 0) || (src >= _nodes) || 
+       (dest < 0) || (dest >= _nodes) || (size < 0)) {
+      cout << "Error: " << filename << ":" << lineno 
+	   << ": expected id source dest size [dep ...]" << endl;
+      exit(-1);
+    }
+    if(id >= (int)_messages.size()) {
+      _messages.resize(id + 1, undefined);
+      deps.resize(id + 1);
+    }
+    if(_messages[id].src >= 0) {
+      cout << "Error: " << filename << ":" << lineno << ": message " << id
+	   << " is defined twice" << endl;
+      exit(-1);
+    }
+    _messages[id].src = src;
+    _messages[id].dest = dest;
+    _messages[id].flits = (size > 0) ? size : _size;
+    int dep;
+    while(is >> dep) {
+      deps[id].push_back(dep);
+    }
+  }
+  if(_messages.empty()) {
+    cout << "Error: Collective DAG " << filename << " is empty" << endl;
+    exit(-1);
+  }
+  for(size_t id = 0; id < _messages.size(); ++id) {
+    if(_messages[id].src < 0) {
+      cout << "Error: Collective DAG " << filename << " is missing message " 
+	   << id << endl;
+      exit(-1);
+    }
+    _messages[id].deps = deps[id].size();
+    for(size_t i = 0; i < deps[id].size(); ++i) {
+      int const d = deps[id][i];
+      if((d < 0) || (d >= (int)_messages.size())) {
+	cout << "Error: Message " << id << " in " << filename 
+	     << " depends on unknown message " << d << endl;
+	exit(-1);
+      }
+      _messages[d].children.push_back(id);
+    }
+  }
+}
+
+void CollectiveWorkload::_CheckAcyclic( ) const
+{
+  vector<int> deps(_messages.size());
+  vector<int> frontier;
+  for(size_t id = 0; id < _messages.size(); ++id) {
+    deps[id] = _messages[id].deps;
+    if(deps[id] == 0) {
+      frontier.push_back(id);
+    }
+  }
+  size_t reached = 0;
+  while(!frontier.empty()) {
+    int const id = frontier.back();
+    frontier.pop_back();
+    ++reached;
+    vector<int> const & children = _messages[id].children;
+    for(size_t i = 0; i < children.size(); ++i) {
+      if(--deps[children[i]] == 0) {
+	frontier.push_back(children[i]);
+      }
+    }
+  }
+  if(reached != _messages.size()) {
+    cout << "Error: Collective " << _name << " has a dependency cycle" << endl;
+    exit(-1);
+  }
+}
+
+void CollectiveWorkload::Reset( int time )
+{
+  _delivered = 0;
+  _deps_left.resize(_messages.size());
+  for(int n = 0; n < _nodes; ++n) {
+    _ready[n].clear();
+  }
+  for(size_t id = 0; id < _messages.size(); ++id) {
+    _deps_left[id] = _messages[id].deps;
+    if(_deps_left[id] == 0) {
+      _ready[_messages[id].src].push_back(make_pair(time, (int)id));
+    }
+  }
+}
+
+void CollectiveWorkload::Deliver( int id, int time )
+{
+  ++_delivered;
+  vector<int> const & children = _messages[id].children;
+  for(size_t i = 0; i < children.size(); ++i) {
+    int const c = children[i];
+    if(--_deps_left[c] == 0) {
+      _ready[_messages[c].src].push_back(make_pair(time + _delay, c));
+    }
+  }
+}
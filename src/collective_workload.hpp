@@ -0,0 +1,107 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _COLLECTIVE_WORKLOAD_HPP_
+#define _COLLECTIVE_WORKLOAD_HPP_
+
+// Closed-loop workload for sim_type = collective: a DAG of messages in
+// which a message may only be issued once every message it depends on has
+// been delivered to its source (and collective_delay cycles have passed,
+// e.g. for the reduction itself). Built-in collectives run over the
+// compute nodes; arbitrary DAGs are read from collective_dag, one message
+// per line:
+//
+//   id source dest size [dep ...]
+//
+// with size in flits (0 for collective_size) and ids numbered from 0.
+
+#include <vector>
+#include <deque>
+#include <string>
+
+#include "config_utils.hpp"
+
+using namespace std;
+
+class CollectiveWorkload {
+
+public:
+
+  struct Message {
+    int src;
+    int dest;
+    int flits;
+    vector<int> children;
+    int deps;
+  };
+
+private:
+
+  string _name;
+  int _nodes;
+  int _size;
+  int _delay;
+  vector<Message> _messages;
+
+  // messages whose dependencies are met, with the cycle they become ready
+  vector<deque<pair<int, int> > > _ready;
+  vector<int> _deps_left;
+  int _delivered;
+
+  int _Add( int src, int dest, vector<int> const & deps = vector<int>() );
+
+  void _BuildRingAllReduce( vector<int> const & nodes );
+  void _BuildTreeAllReduce( vector<int> const & nodes );
+  void _BuildAllToAll( vector<int> const & nodes );
+  void _BuildParameterServer( vector<int> const & nodes );
+  void _Load( string const & filename );
+  void _CheckAcyclic( ) const;
+
+public:
+
+  CollectiveWorkload( Configuration const & config, int nodes );
+
+  // restart the workload; messages without dependencies are ready at time
+  void Reset( int time );
+
+  // next message of a source that is ready at time, or -1
+  inline int Peek( int source, int time ) const {
+    deque<pair<int, int> > const & q = _ready[source];
+    return (!q.empty() && (q.front().first <= time)) ? q.front().second : -1;
+  }
+  inline void Pop( int source ) { _ready[source].pop_front(); }
+
+  void Deliver( int id, int time );
+
+  inline Message const & GetMessage( int id ) const { return _messages[id]; }
+  inline int Messages( ) const { return _messages.size(); }
+  inline int Delivered( ) const { return _delivered; }
+  inline bool Done( ) const { return _delivered == (int)_messages.size(); }
+  inline string const & Name( ) const { return _name; }
+};
+
+#endif
@@ -0,0 +1,195 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <sstream>
+
+#include "collectivetrafficmanager.hpp"
+
+CollectiveTrafficManager::CollectiveTrafficManager( const Configuration &config, 
+						    const vector<Network *> & net )
+: TrafficManager(config, net), _issued(-1),
+  _overall_min_collective_time(0), _overall_avg_collective_time(0),
+  _overall_max_collective_time(0)
+{
+  _collective_class = config.GetInt( "collective_class" );
+  if((_collective_class < 0) || (_collective_class >= _classes)) {
+    ostringstream err;
+    err << "Invalid collective class " << _collective_class;
+    Error( err.str( ) );
+  }
+  if(_use_read_write[_collective_class]) {
+    Error( "The collective class cannot use read/write requests" );
+  }
+  _iterations = config.GetInt( "collective_iterations" );
+
+  _workload = new CollectiveWorkload( config, _nodes );
+  cout << "Collective " << _workload->Name() << ": " 
+       << _workload->Messages() << " messages" << endl;
+
+  _collective_time = new Stats( this, "collective_time", 1.0, 1000 );
+  _stats["collective_time"] = _collective_time;
+}
+
+CollectiveTrafficManager::~CollectiveTrafficManager( )
+{
+  delete _collective_time;
+  delete _workload;
+}
+
+void CollectiveTrafficManager::_RetireFlit( Flit *f, int dest )
+{
+  if(f->cl == _collective_class) {
+    map<int, pair<int, int> >::iterator iter = _outstanding.find(f->mid);
+    assert(iter != _outstanding.end());
+    if(--iter->second.second == 0) {
+      _workload->Deliver(iter->second.first, _time);
+      _outstanding.erase(iter);
+    }
+  }
+  TrafficManager::_RetireFlit(f, dest);
+}
+
+int CollectiveTrafficManager::_IssueMessage( int source, int cl )
+{
+  if(cl != _collective_class) {
+    return TrafficManager::_IssueMessage(source, cl);
+  }
+  if(_workload->Peek(source, _qtime[source][cl]) < 0) {
+    return 0;
+  }
+  _requestsOutstanding[source]++;
+  _message_seq_no[source]++;
+  return 1;
+}
+
+void CollectiveTrafficManager::_NextRequest( int source, int cl, 
+					     int & dest, int & flits )
+{
+  if(cl != _collective_class) {
+    TrafficManager::_NextRequest(source, cl, dest, flits);
+    return;
+  }
+  _issued = _workload->Peek(source, _qtime[source][cl]);
+  assert(_issued >= 0);
+  _workload->Pop(source);
+  CollectiveWorkload::Message const & m = _workload->GetMessage(_issued);
+  assert(m.src == source);
+  dest = m.dest;
+  flits = m.flits;
+}
+
+void CollectiveTrafficManager::_GenerateMessage( int source, int stype, 
+						 int cl, int time )
+{
+  if(cl != _collective_class) {
+    TrafficManager::_GenerateMessage(source, stype, cl, time);
+    return;
+  }
+  int const mid = _cur_mid;
+  TrafficManager::_GenerateMessage(source, stype, cl, time);
+  QueuedMessage const & qm = _queued_messages[source][cl];
+  _outstanding[mid] = make_pair(_issued, qm.packets * qm.packet_size);
+}
+
+void CollectiveTrafficManager::_ClearStats( )
+{
+  TrafficManager::_ClearStats();
+  _collective_time->Clear( );
+}
+
+bool CollectiveTrafficManager::_SingleSim( )
+{
+  _sim_state = running;
+  for(int iteration = 0; iteration < _iterations; ++iteration) {
+    _workload->Reset(_time);
+    int const start_time = _time;
+    cout << "Running collective " << iteration + 1 << " ("
+	 << _workload->Messages() << " messages)..." << endl;
+    while(!_workload->Done()) {
+      _Step();
+      if(_deadlocked) {
+	return false;
+      }
+      if((_time - start_time) % _sample_period == 0) {
+	cout << _workload->Delivered() << " of " << _workload->Messages()
+	     << " messages delivered." << endl;
+      }
+    }
+    cout << "Collective completed in " << _time - start_time << " cycles." 
+	 << endl;
+    _collective_time->AddSample(_time - start_time);
+
+    UpdateStats();
+    DisplayStats();
+  }
+  _sim_state = draining;
+  _drain_time = _time;
+  return 1;
+}
+
+void CollectiveTrafficManager::_UpdateOverallStats() {
+  TrafficManager::_UpdateOverallStats();
+  _overall_min_collective_time += _collective_time->Min();
+  _overall_avg_collective_time += _collective_time->Average();
+  _overall_max_collective_time += _collective_time->Max();
+}
+  
+string CollectiveTrafficManager::_OverallStatsCSV(int c) const
+{
+  ostringstream os;
+  os << TrafficManager::_OverallStatsCSV(c) << ','
+     << _overall_min_collective_time / (double)_total_sims << ','
+     << _overall_avg_collective_time / (double)_total_sims << ','
+     << _overall_max_collective_time / (double)_total_sims;
+  return os.str();
+}
+
+void CollectiveTrafficManager::WriteStats(ostream & os) const
+{
+  TrafficManager::WriteStats(os);
+  os << "collective_time = " << _collective_time->Average() << ";" << endl;
+}    
+
+void CollectiveTrafficManager::DisplayStats(ostream & os) const {
+  TrafficManager::DisplayStats(os);
+  os << "Minimum collective completion time = " << _collective_time->Min() << endl;
+  os << "Average collective completion time = " << _collective_time->Average() << endl;
+  os << "Maximum collective completion time = " << _collective_time->Max() << endl;
+}
+
+void CollectiveTrafficManager::DisplayOverallStats(ostream & os) const {
+  TrafficManager::DisplayOverallStats(os);
+  os << "Overall min collective completion time = " 
+     << _overall_min_collective_time / (double)_total_sims
+     << " (" << _total_sims << " samples)" << endl
+     << "Overall avg collective completion time = " 
+     << _overall_avg_collective_time / (double)_total_sims
+     << " (" << _total_sims << " samples)" << endl
+     << "Overall max collective completion time = " 
+     << _overall_max_collective_time / (double)_total_sims
+     << " (" << _total_sims << " samples)" << endl;
+}
@@ -0,0 +1,85 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _COLLECTIVETRAFFICMANAGER_HPP_
+#define _COLLECTIVETRAFFICMANAGER_HPP_
+
+#include <iostream>
+#include <map>
+
+#include "config_utils.hpp"
+#include "stats.hpp"
+#include "trafficmanager.hpp"
+#include "collective_workload.hpp"
+
+// sim_type = collective: class collective_class runs a closed-loop
+// CollectiveWorkload instead of the traffic pattern and injection process.
+// A message counts as delivered once all of its flits have retired, and
+// the time until every message of the collective has been delivered is
+// reported as the collective completion time.
+class CollectiveTrafficManager : public TrafficManager {
+
+protected:
+
+  int _collective_class;
+  int _iterations;
+  CollectiveWorkload * _workload;
+
+  // workload message being generated by _GenerateMessage
+  int _issued;
+  // simulator message id -> (workload message, flits not yet retired)
+  map<int, pair<int, int> > _outstanding;
+
+  Stats * _collective_time;
+  double _overall_min_collective_time;
+  double _overall_avg_collective_time;
+  double _overall_max_collective_time;
+
+  virtual void _RetireFlit( Flit *f, int dest );
+  virtual int _IssueMessage( int source, int cl );
+  virtual void _GenerateMessage( int source, int stype, int cl, int time );
+  virtual void _NextRequest( int source, int cl, int & dest, int & flits );
+
+  virtual void _ClearStats( );
+  virtual bool _SingleSim( );
+
+  virtual void _UpdateOverallStats( );
+
+  virtual string _OverallStatsCSV(int c = 0) const;
+
+public:
+
+  CollectiveTrafficManager( const Configuration &config, const vector<Network *> & net );
+  virtual ~CollectiveTrafficManager( );
+
+  virtual void WriteStats( ostream & os = cout ) const;
+  virtual void DisplayStats( ostream & os = cout ) const;
+  virtual void DisplayOverallStats( ostream & os = cout ) const;
+
+};
+
+#endif
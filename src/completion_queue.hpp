@@ -0,0 +1,90 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _COMPLETION_QUEUE_HPP_
+#define _COMPLETION_QUEUE_HPP_
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+// Bounded single-producer, single-consumer queue. One thread may Push()
+// while another Pop()s without any locking: the producer only writes
+// _tail and the consumer only writes _head, and each publishes its slot
+// with release/acquire ordering. The capacity is rounded up to a power of
+// two.
+template<class T>
+class CompletionQueue {
+
+  std::vector<T> _slots;
+  size_t _mask;
+
+  // kept on separate cache lines so the two sides do not share a line
+  alignas(64) std::atomic<size_t> _head;
+  alignas(64) std::atomic<size_t> _tail;
+
+public:
+
+  CompletionQueue( size_t capacity ) : _head(0), _tail(0) {
+    size_t size = 1;
+    while(size < capacity) {
+      size <<= 1;
+    }
+    _slots.resize(size);
+    _mask = size - 1;
+  }
+
+  // producer side; false if the queue is full
+  bool Push( T const & value ) {
+    size_t const tail = _tail.load(std::memory_order_relaxed);
+    if(tail - _head.load(std::memory_order_acquire) == _slots.size()) {
+      return false;
+    }
+    _slots[tail & _mask] = value;
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer side; false if the queue is empty
+  bool Pop( T & value ) {
+    size_t const head = _head.load(std::memory_order_relaxed);
+    if(head == _tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+    value = _slots[head & _mask];
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t Size( ) const {
+    size_t const head = _head.load(std::memory_order_acquire);
+    return _tail.load(std::memory_order_acquire) - head;
+  }
+
+};
+
+#endif
@@ -49,8 +49,10 @@ public:
   static int OutStanding();
 private:
 
-  static stack<Credit *> _all;
-  static stack<Credit *> _free;
+  friend class GlobalState;
+
+  static thread_local stack<Credit *> _all;
+  static thread_local stack<Credit *> _free;
 
   Credit();
   ~Credit() {}
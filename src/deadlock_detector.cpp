@@ -0,0 +1,211 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <cassert>
+
+#include "booksim.hpp"
+#include "deadlock_detector.hpp"
+#include "network.hpp"
+#include "router.hpp"
+#include "flitchannel.hpp"
+
+DeadlockDetector::DeadlockDetector( vector<Network *> const & net, int vcs )
+  : _net(net), _vcs(vcs), _supported(true)
+{
+  _base.resize(_net.size());
+  for(size_t s = 0; s < _net.size(); ++s) {
+    vector<Router *> const & routers = _net[s]->GetRouters();
+    for(size_t r = 0; r < routers.size(); ++r) {
+      assert(routers[r]->GetID() == (int)r);
+      if(!routers[r]->HasVCWaitState()) {
+	_supported = false;
+      }
+      _base[s].push_back(_nodes.size());
+      for(int i = 0; i < routers[r]->NumInputs(); ++i) {
+	for(int v = 0; v < _vcs; ++v) {
+	  Node n;
+	  n.subnet = s;
+	  n.router = routers[r];
+	  n.input = i;
+	  n.vc = v;
+	  _nodes.push_back(n);
+	}
+      }
+    }
+  }
+}
+
+int DeadlockDetector::_Index( int subnet, Router const * router, int input, int vc ) const
+{
+  return _base[subnet][router->GetID()] + input * _vcs + vc;
+}
+
+int DeadlockDetector::_Resolve( int subnet, Router const * router, int output, int vc,
+				int waiting ) const
+{
+  int const holder = router->GetOutputVCHolder(output, vc);
+  if(holder >= 0) {
+    int const n = _Index(subnet, router, holder / _vcs, holder % _vcs);
+    if(n != waiting) {
+      return n;
+    }
+  }
+  FlitChannel const * const chan = router->GetOutputChannel(output);
+  if(!chan->GetSink()) {
+    // ejection channels always drain
+    return -1;
+  }
+  if(!chan->GetSink()->GetVCFront(chan->GetSinkPort(), vc)) {
+    // flits or credits still in flight between the routers
+    return -1;
+  }
+  return _Index(subnet, chan->GetSink(), chan->GetSinkPort(), vc);
+}
+
+bool DeadlockDetector::Check( ostream & os )
+{
+  if(!_supported) {
+    return false;
+  }
+
+  int const nodes = _nodes.size();
+  vector<bool> advancing(nodes, false);
+  vector<vector<int> > waits(nodes);
+  vector<vector<int> > waited_by(nodes);
+  vector<int> ready;
+
+  vector<int> out_vcs;
+  for(int n = 0; n < nodes; ++n) {
+    Node const & node = _nodes[n];
+    out_vcs.clear();
+    Router::eVCWait const state = node.router->GetVCWait(node.input, node.vc, &out_vcs);
+    if(state == Router::VC_BLOCKED) {
+      for(size_t i = 0; i < out_vcs.size(); ++i) {
+	int const w = _Resolve(node.subnet, node.router, out_vcs[i] / _vcs, 
+			       out_vcs[i] % _vcs, n);
+	if(w < 0) {
+	  waits[n].clear();
+	  break;
+	}
+	waits[n].push_back(w);
+      }
+    } else if(state == Router::VC_STARVED) {
+      FlitChannel const * const chan = node.router->GetInputChannel(node.input);
+      Router const * const src = chan->GetSource();
+      int const holder = src ? src->GetOutputVCHolder(chan->GetSourcePort(), node.vc) : -1;
+      // a head flit at the holder means the VC was granted to the next
+      // packet, so the rest of this one is already on its way
+      if((holder >= 0) && 
+	 !(src->GetVCFront(holder / _vcs, holder % _vcs) &&
+	   src->GetVCFront(holder / _vcs, holder % _vcs)->head)) {
+	waits[n].push_back(_Index(node.subnet, src, holder / _vcs, holder % _vcs));
+      }
+    }
+    if(waits[n].empty()) {
+      advancing[n] = true;
+      ready.push_back(n);
+    }
+    for(size_t i = 0; i < waits[n].size(); ++i) {
+      waited_by[waits[n][i]].push_back(n);
+    }
+  }
+
+  // everything waiting for a VC that advances advances as well
+  while(!ready.empty()) {
+    int const n = ready.back();
+    ready.pop_back();
+    for(size_t i = 0; i < waited_by[n].size(); ++i) {
+      int const m = waited_by[n][i];
+      if(!advancing[m]) {
+	advancing[m] = true;
+	ready.push_back(m);
+      }
+    }
+  }
+
+  int stuck = 0;
+  int first = -1;
+  for(int n = 0; n < nodes; ++n) {
+    if(!advancing[n]) {
+      ++stuck;
+      if(first < 0) {
+	first = n;
+      }
+    }
+  }
+  if(stuck == 0) {
+    return false;
+  }
+
+  // every VC that cannot advance only waits for others that cannot, so
+  // following any of them from a stuck VC ends in a cycle
+  vector<int> visited(nodes, -1);
+  vector<int> path;
+  int n = first;
+  while(visited[n] < 0) {
+    visited[n] = path.size();
+    path.push_back(n);
+    int next = -1;
+    for(size_t i = 0; i < waits[n].size(); ++i) {
+      if(!advancing[waits[n][i]]) {
+	next = waits[n][i];
+	break;
+      }
+    }
+    assert(next >= 0);
+    n = next;
+  }
+
+  os << "Deadlock at time " << GetSimTime() << ": " << stuck 
+     << " input VCs can never advance. Wait-for cycle:" << endl;
+  for(size_t i = visited[n]; i < path.size(); ++i) {
+    _Describe(os, path[i]);
+  }
+  return true;
+}
+
+void DeadlockDetector::_Describe( ostream & os, int n ) const
+{
+  Node const & node = _nodes[n];
+  os << "  " << node.router->FullName();
+  if(_net.size() > 1) {
+    os << " (subnet " << node.subnet << ")";
+  }
+  os << " input " << node.input << " VC " << node.vc << ": ";
+  Flit const * const f = node.router->GetVCFront(node.input, node.vc);
+  if(f) {
+    // only head flits carry the destination
+    os << "flit " << f->id << " (packet " << f->pid << ", from " << f->src;
+    if(f->head) {
+      os << " to " << f->dest;
+    }
+    os << ", " << f->hops << " hops)";
+  } else {
+    os << "empty, waiting for the rest of its packet";
+  }
+  os << endl;
+}
@@ -0,0 +1,86 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _DEADLOCK_DETECTOR_HPP_
+#define _DEADLOCK_DETECTOR_HPP_
+
+// Confirms network deadlocks from the wait-for graph of the router input
+// VCs. A blocked VC waits for any one of several VCs to drain: the input VC
+// at the same router whose packet holds an output VC it needs, or the
+// downstream input VC that has run out of space. A VC whose packet is
+// still arriving waits for the upstream VC holding the rest of it. VCs
+// that can advance on their own make every VC waiting for them able to
+// advance in turn; the VCs left over can never move, and always contain
+// a wait-for cycle, which is reported.
+
+#include <vector>
+#include <iostream>
+
+class Network;
+class Router;
+
+class DeadlockDetector {
+
+public:
+
+  DeadlockDetector( std::vector<Network *> const & net, int vcs );
+
+  // false if some router type does not keep per-VC wait state
+  bool Supported( ) const { return _supported; }
+
+  // Returns true and describes the deadlock on os if some VCs can never
+  // advance.
+  bool Check( std::ostream & os );
+
+private:
+
+  struct Node {
+    int subnet;
+    Router const * router;
+    int input;
+    int vc;
+  };
+
+  int _Index( int subnet, Router const * router, int input, int vc ) const;
+  // VC that has to drain for an output VC to become usable by the waiting
+  // VC, or -1 if nothing inside the network stands in the way
+  int _Resolve( int subnet, Router const * router, int output, int vc,
+		int waiting ) const;
+
+  void _Describe( std::ostream & os, int n ) const;
+
+  std::vector<Network *> _net;
+  int _vcs;
+  bool _supported;
+
+  // index of the first VC of every router, per subnetwork
+  std::vector<std::vector<int> > _base;
+  std::vector<Node> _nodes;
+
+};
+
+#endif
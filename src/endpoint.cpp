@@ -0,0 +1,154 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <cassert>
+
+#include "random_utils.hpp"
+#include "packet_reply_info.hpp"
+#include "endpoint.hpp"
+
+EndpointModel::EndpointModel(int nodes, int depth)
+  : _nodes(nodes), _depth(depth), _occupancy(nodes, 0), _busy(0)
+{
+}
+
+void EndpointModel::Reset()
+{
+  _occupancy.assign(_nodes, 0);
+  _busy = 0;
+}
+
+EndpointModel * EndpointModel::New(string const & model, int nodes, 
+				   Configuration const * const config)
+{
+  EndpointModel * result = NULL;
+  int const depth = config->GetInt("endpoint_queue_depth");
+  if(model == "banked") {
+    int const banks = config->GetInt("endpoint_banks");
+    int const latency = config->GetInt("endpoint_latency");
+    if((banks <= 0) || (latency < 0)) {
+      cout << "Error: Banked endpoints need endpoint_banks > 0 and endpoint_latency >= 0" << endl;
+      exit(-1);
+    }
+    result = new BankedEndpoint(nodes, depth, banks, latency, 
+				config->GetStr("endpoint_service"),
+				config->GetFloat("endpoint_rate"));
+  } else {
+    cout << "Invalid endpoint model: " << model << endl;
+    exit(-1);
+  }
+  return result;
+}
+
+BankedEndpoint::BankedEndpoint(int nodes, int depth, int banks, int latency,
+			       string const & service, double rate)
+  : EndpointModel(nodes, depth), _banks(banks), _latency(latency), 
+    _waiting(nodes), _in_service(nodes), _next_start(nodes, 0.0)
+{
+  if(service == "fixed") {
+    _service = fixed;
+  } else if(service == "uniform") {
+    _service = uniform;
+  } else if(service == "exponential") {
+    _service = exponential;
+  } else {
+    cout << "Error: Unknown endpoint service time distribution: " << service
+	 << endl;
+    exit(-1);
+  }
+  _interval = (rate > 0.0) ? (1.0 / rate) : 0.0;
+}
+
+BankedEndpoint::~BankedEndpoint()
+{
+  Reset();
+}
+
+int BankedEndpoint::_ServiceTime()
+{
+  switch(_service) {
+  case uniform:
+    return RandomInt(2 * _latency);
+  case exponential:
+    return (int)floor(-(double)_latency * log(1.0 - RandomFloat()) + 0.5);
+  default:
+    return _latency;
+  }
+}
+
+void BankedEndpoint::Arrive(int node, PacketReplyInfo * r, int time)
+{
+  _waiting[node].push_back(r);
+  ++_occupancy[node];
+  ++_busy;
+}
+
+void BankedEndpoint::Step(int time, vector<list<PacketReplyInfo *> > & replies)
+{
+  if(_busy == 0) {
+    return;
+  }
+  for(int n = 0; n < _nodes; ++n) {
+    if(_occupancy[n] == 0) {
+      continue;
+    }
+    multimap<int, PacketReplyInfo *> & serving = _in_service[n];
+    deque<PacketReplyInfo *> & waiting = _waiting[n];
+    while(!waiting.empty() && ((int)serving.size() < _banks) &&
+	  (_next_start[n] <= time)) {
+      serving.insert(make_pair(time + _ServiceTime(), waiting.front()));
+      waiting.pop_front();
+      _next_start[n] = max(_next_start[n], (double)time) + _interval;
+    }
+    while(!serving.empty() && (serving.begin()->first <= time)) {
+      replies[n].push_back(serving.begin()->second);
+      serving.erase(serving.begin());
+      --_occupancy[n];
+      --_busy;
+    }
+  }
+}
+
+void BankedEndpoint::Reset()
+{
+  for(int n = 0; n < _nodes; ++n) {
+    while(!_waiting[n].empty()) {
+      _waiting[n].front()->Free();
+      _waiting[n].pop_front();
+    }
+    multimap<int, PacketReplyInfo *>::iterator iter;
+    for(iter = _in_service[n].begin(); iter != _in_service[n].end(); ++iter) {
+      iter->second->Free();
+    }
+    _in_service[n].clear();
+  }
+  _next_start.assign(_nodes, 0.0);
+  EndpointModel::Reset();
+}
@@ -0,0 +1,96 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _ENDPOINT_HPP_
+#define _ENDPOINT_HPP_
+
+// Service models for the nodes that answer read/write requests. Without a
+// model (endpoint_model = ideal) a reply is ready as soon as its request
+// has arrived. A model instead holds each arriving request until it has
+// been served, at most endpoint_queue_depth of them per node. While a
+// node's model is Full(), the traffic manager keeps newly arrived requests
+// out of it, handing them over in order as it drains, and stops returning
+// credits for request flits, so further requests back up into the network.
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <list>
+#include <string>
+
+#include "config_utils.hpp"
+
+using namespace std;
+
+class PacketReplyInfo;
+
+class EndpointModel {
+protected:
+  int _nodes;
+  int _depth;
+  // requests waiting or in service at each node
+  vector<int> _occupancy;
+  int _busy;
+  EndpointModel(int nodes, int depth);
+public:
+  virtual ~EndpointModel() {}
+  virtual void Arrive(int node, PacketReplyInfo * r, int time) = 0;
+  // hand the requests whose service completes by time over to replies
+  virtual void Step(int time, vector<list<PacketReplyInfo *> > & replies) = 0;
+  virtual void Reset();
+  inline int Occupancy(int node) const { return _occupancy[node]; }
+  inline bool Full(int node) const {
+    return (_depth > 0) && (_occupancy[node] >= _depth);
+  }
+  static EndpointModel * New(string const & model, int nodes, 
+			     Configuration const * const config);
+};
+
+// endpoint_banks requests are served in parallel, each for a service time
+// drawn from endpoint_service (fixed, uniform or exponential, with mean
+// endpoint_latency); endpoint_rate limits how many requests per cycle can
+// start service.
+class BankedEndpoint : public EndpointModel {
+  enum eService { fixed, uniform, exponential };
+  int _banks;
+  int _latency;
+  eService _service;
+  double _interval;
+  vector<deque<PacketReplyInfo *> > _waiting;
+  vector<multimap<int, PacketReplyInfo *> > _in_service;
+  vector<double> _next_start;
+  int _ServiceTime();
+public:
+  BankedEndpoint(int nodes, int depth, int banks, int latency, 
+		 string const & service, double rate);
+  virtual ~BankedEndpoint();
+  virtual void Arrive(int node, PacketReplyInfo * r, int time);
+  virtual void Step(int time, vector<list<PacketReplyInfo *> > & replies);
+  virtual void Reset();
+};
+
+#endif
@@ -0,0 +1,139 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*event_trace.cpp
+ *
+ *Records are appended to a small in-memory ring; when it fills, the whole
+ *ring is copied into the current mapped window of the trace file, and the
+ *window is moved forward (growing the file) as it fills in turn. The
+ *header's record count is brought up to date after each flush.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "event_trace.hpp"
+
+const char * const EventTrace::EventName[NUM_EVENT_TYPES] = {
+  "inject", "hop", "vc_alloc", "sw_grant", "eject", "retire", "credit"
+};
+
+// mapped window size; a multiple of any common page size
+static const size_t TRACE_WINDOW = 16 << 20;
+
+EventTrace::EventTrace( string const & filename, int buffer_records )
+  : _filename(filename), _size(buffer_records), _head(0), _map(NULL),
+    _map_offset(0), _map_pos(0), _window(TRACE_WINDOW), _written(0)
+{
+  if(_size <= 0) {
+    cout << "Error: event_trace_buffer must be greater than zero." << endl;
+    exit(-1);
+  }
+  _fd = open(_filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if(_fd < 0) {
+    cout << "Error: Unable to open event trace file " << _filename << endl;
+    exit(-1);
+  }
+  _ring = new TraceRecord[_size];
+  _Map(0);
+  _map_pos = sizeof(TraceHeader);
+  _WriteHeader();
+}
+
+EventTrace::~EventTrace( )
+{
+  Flush();
+  munmap(_map, _window);
+
+  // drop the unused tail of the last window
+  off_t const bytes = sizeof(TraceHeader) + _written * sizeof(TraceRecord);
+  if(ftruncate(_fd, bytes) != 0) {
+    cout << "Error: Unable to finish event trace file " << _filename << endl;
+  }
+  close(_fd);
+  delete [] _ring;
+}
+
+void EventTrace::Flush( )
+{
+  _Write((char const *)_ring, _head * sizeof(TraceRecord));
+  _written += _head;
+  _head = 0;
+  _WriteHeader();
+}
+
+void EventTrace::_WriteHeader( )
+{
+  TraceHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, "BSTRACE", 8);
+  h.version = VERSION;
+  h.record_size = sizeof(TraceRecord);
+  h.records = _written;
+  if(pwrite(_fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h)) {
+    cout << "Error: Unable to write event trace file " << _filename << endl;
+    exit(-1);
+  }
+}
+
+void EventTrace::_Map( size_t offset )
+{
+  if(ftruncate(_fd, offset + _window) != 0) {
+    cout << "Error: Unable to extend event trace file " << _filename << endl;
+    exit(-1);
+  }
+  void * const p = mmap(NULL, _window, PROT_READ | PROT_WRITE, MAP_SHARED, 
+			_fd, offset);
+  if(p == MAP_FAILED) {
+    cout << "Error: Unable to map event trace file " << _filename << endl;
+    exit(-1);
+  }
+  _map = (char *)p;
+  _map_offset = offset;
+  _map_pos = 0;
+}
+
+void EventTrace::_Write( char const * data, size_t bytes )
+{
+  while(bytes > 0) {
+    if(_map_pos == _window) {
+      munmap(_map, _window);
+      _Map(_map_offset + _window);
+    }
+    size_t const n = min(bytes, _window - _map_pos);
+    memcpy(_map + _map_pos, data, n);
+    _map_pos += n;
+    data += n;
+    bytes -= n;
+  }
+}
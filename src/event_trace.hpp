@@ -0,0 +1,151 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _EVENT_TRACE_HPP_
+#define _EVENT_TRACE_HPP_
+
+// Binary per-flit event trace, enabled with event_trace_out. Fixed-size
+// records are staged in a ring buffer and flushed into a memory-mapped
+// file; booksim_tracedec (make tracedec) converts it to text or CSV.
+//
+// File layout: one TraceHeader followed by TraceHeader::records records.
+// The header is rewritten after every flush, so a trace cut short by an
+// abort still decodes up to the last flush; the file may then be longer
+// than the records it holds.
+
+#include <string>
+
+#include "globals.hpp"
+#include "flit.hpp"
+
+struct TraceHeader {
+  char magic[8];      // "BSTRACE\0"
+  int version;
+  int record_size;    // sizeof(TraceRecord)
+  long long records;
+};
+
+struct TraceRecord {
+  int time;
+  int id;             // flit id; -1 for credits
+  int pid;            // packet id; -1 for credits
+  int node;           // router id, or terminal for inject/eject/retire
+  short port;         // input port at a router
+  short vc;           // VC of the flit (or credited VC)
+  short out_port;     // allocated output port (vc_alloc, sw_grant)
+  short out_vc;       // allocated output VC (vc_alloc, sw_grant)
+  unsigned char type; // EventTrace::EventType
+  signed char subnet; // -1 for credits
+  short cl;
+};
+
+class EventTrace {
+
+public:
+
+  static const int VERSION = 1;
+
+  enum EventType { INJECT   = 0,  // flit enters the network at its source
+                   HOP      = 1,  // flit received at a router input
+                   VC_ALLOC = 2,  // output VC granted to a head flit
+                   SW_GRANT = 3,  // flit granted the switch
+                   EJECT    = 4,  // flit leaves the network at its destination
+                   RETIRE   = 5,  // flit retired by the traffic manager
+                   CREDIT   = 6,  // router returns a credit upstream
+                   NUM_EVENT_TYPES = 7 };
+
+  static const char * const EventName[NUM_EVENT_TYPES];
+
+  EventTrace( std::string const & filename, int buffer_records );
+  ~EventTrace( );
+
+  inline void Record( EventType type, Flit const * f, int node, int port = -1, 
+		      int out_port = -1, int out_vc = -1 ) {
+    TraceRecord & r = _Next();
+    r.id = f->id;
+    r.pid = f->pid;
+    r.node = node;
+    r.port = port;
+    r.vc = f->vc;
+    r.out_port = out_port;
+    r.out_vc = out_vc;
+    r.type = type;
+    r.subnet = f->subnetwork;
+    r.cl = f->cl;
+  }
+
+  inline void RecordCredit( int node, int port, int vc ) {
+    TraceRecord & r = _Next();
+    r.id = -1;
+    r.pid = -1;
+    r.node = node;
+    r.port = port;
+    r.vc = vc;
+    r.out_port = -1;
+    r.out_vc = -1;
+    r.type = CREDIT;
+    r.subnet = -1;
+    r.cl = -1;
+  }
+
+  void Flush( );
+
+  long long Records( ) const { return _written + _head; }
+
+private:
+
+  inline TraceRecord & _Next( ) {
+    if(_head == _size) {
+      Flush();
+    }
+    TraceRecord & r = _ring[_head++];
+    r.time = GetSimTime();
+    return r;
+  }
+
+  void _Write( char const * data, size_t bytes );
+  void _WriteHeader( );
+  void _Map( size_t offset );
+
+  std::string _filename;
+  int _fd;
+
+  // staging ring; flushed in one copy when it wraps
+  TraceRecord * _ring;
+  int _size;
+  int _head;
+
+  // current mapped window of the output file
+  char * _map;
+  size_t _map_offset;
+  size_t _map_pos;
+  size_t _window;
+
+  long long _written;
+};
+
+#endif
@@ -36,9 +36,11 @@
 
 #include "booksim.hpp"
 #include "flit.hpp"
+#include "globals.hpp"
 
-stack<Flit *> Flit::_all;
-stack<Flit *> Flit::_free;
+thread_local stack<Flit *> Flit::_all;
+thread_local stack<Flit *> Flit::_free;
+thread_local vector<FlitTiming> Flit::_timing;
 
 ostream& operator<<( ostream& os, const Flit& f )
 {
@@ -85,18 +87,6 @@ void Flit::Reset()
   msg_head = false;
   msg_tail = false;
 
-#ifdef WAIT_TIME
-  ewtime    = -1 ;
-
-  rc_time   = -1 ;
-  in_time   = -1;
-  wait_time = 0;
-  service_time = 0;
-  service_uptime = 0;
-  service_downtime = 0;
-  see_queue = 0;
-#endif
-
   rtime    = -1 ;
 
   // THO: For randomly small message
@@ -111,12 +101,19 @@ Flit * Flit::New() {
   Flit * f;
   if(_free.empty()) {
     f = new Flit;
+    f->_slot = _all.size();
     _all.push(f);
   } else {
     f = _free.top();
     f->Reset();
     _free.pop();
   }
+  if(gTrackWaitTime) {
+    if(f->_slot >= (int)_timing.size()) {
+      _timing.resize(f->_slot + 1);
+    }
+    _timing[f->_slot] = FlitTiming();
+  }
   return f;
 }
 
@@ -129,4 +126,5 @@ void Flit::FreeAll() {
     delete _all.top();
     _all.pop();
   }
+  _timing.clear();
 }
@@ -30,10 +30,30 @@
 
 #include <iostream>
 #include <stack>
+#include <vector>
 
 #include "booksim.hpp"
 #include "outputset.hpp"
 
+// Per-flit timing collected when track_wait_time is set. It is kept in a
+// side table indexed by the flit's pool slot so that Flit itself does not
+// grow when the statistic is disabled.
+struct FlitTiming {
+  int ewtime; // Waiting time due to endpoint congestion
+
+  int rc_time; // Time when starting RC stage
+  int in_time; // Tme when injected to the input buffer
+  int wait_time; // Then from injection to and ejection from the input buffer
+  int service_time; // Total service time
+  int service_uptime; // Uplink service time
+  int service_downtime; // Downlink service time
+  int see_queue; // Total observed queue before arrival
+
+  FlitTiming() : ewtime(-1), rc_time(-1), in_time(-1), wait_time(0),
+		 service_time(0), service_uptime(0), service_downtime(0),
+		 see_queue(0) {}
+};
+
 class Flit {
 
 public:
@@ -87,18 +107,6 @@ public:
   bool msg_head;
   bool msg_tail;
 
-#ifdef WAIT_TIME
-  mutable int ewtime; // Waiting time due to endpoint congestion
-
-  mutable int rc_time; // Time when starting RC stage
-  mutable int in_time; // Tme when injected to the input buffer
-  mutable int wait_time; // Then from injection to and ejection from the input buffer
-  mutable int service_time; // Total service time
-  mutable int service_uptime; // Uplink service time
-  mutable int service_downtime; // Downlink service time
-  mutable int see_queue; // Total observed queue before arrival
-#endif
-
   int rtime; // Time when entering reordering buffer
 
   // HANS: Additionals for reordering
@@ -116,17 +124,28 @@ public:
 
   void Reset();
 
+  // only valid while track_wait_time is enabled
+  inline FlitTiming & Timing() const {
+    assert(_slot < (int)_timing.size());
+    return _timing[_slot];
+  }
+
   static Flit * New();
   void Free();
   static void FreeAll();
 
 private:
 
+  friend class GlobalState;
+
   Flit();
   ~Flit() {}
 
-  static stack<Flit *> _all;
-  static stack<Flit *> _free;
+  static thread_local stack<Flit *> _all;
+  static thread_local stack<Flit *> _free;
+
+  int _slot; // position in _all, indexes the side tables
+  static thread_local vector<FlitTiming> _timing;
 
 };
 
@@ -47,7 +47,7 @@
 // ----------------------------------------------------------------------
 FlitChannel::FlitChannel(Module * parent, string const & name, int classes)
 : Channel<Flit>(parent, name), _routerSource(NULL), _routerSourcePort(-1), 
-  _routerSink(NULL), _routerSinkPort(-1), _idle(0) {
+  _routerSink(NULL), _routerSinkPort(-1), _busy(0), _idle(0) {
   _active.resize(classes, 0);
 }
 
@@ -64,6 +64,7 @@ void FlitChannel::SetSink(Router const * const router, int port) {
 void FlitChannel::Send(Flit * f) {
   if(f) {
     ++_active[f->cl];
+    ++_busy;
   } else {
     ++_idle;
   }
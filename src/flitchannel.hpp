@@ -71,6 +71,10 @@ public:
   inline vector<int> const & GetActivity() const {
     return _active;
   }
+  // Cycles in which a flit was sent, across all classes
+  inline int GetBusyCycles() const {
+    return _busy;
+  }
 
   // Send flit 
   virtual void Send(Flit * flit);
@@ -93,6 +97,7 @@ private:
 
   // Statistics for Activity Factors
   vector<int> _active;
+  int _busy;
   int _idle;
 };
 
@@ -0,0 +1,408 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*flow_model.cpp
+ *
+ *Fluid approximation of the network. Each sampled (src, dest) flow is
+ *traced once through the routing function, and the resulting channel
+ *loads are used to compute a max-min fair rate allocation. This is
+ *several orders of magnitude faster than the cycle-accurate
+ *TrafficManager and is meant to narrow down injection rate sweeps.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <queue>
+#include <functional>
+#include <limits>
+#include <cmath>
+#include <sys/time.h>
+
+#include "booksim.hpp"
+#include "flow_model.hpp"
+#include "random_utils.hpp"
+#include "outputset.hpp"
+#include "misc_utils.hpp"
+
+FlowModel::FlowModel( Configuration const & config, Network * net )
+  : Module( 0, "flow_model" ), _net(net)
+{
+  _nodes = _net->NumNodes( );
+
+  string rf = config.GetStr("routing_function") + "_" + config.GetStr("topology");
+  map<string, tRoutingFunction>::const_iterator rf_iter = gRoutingFunctionMap.find(rf);
+  if(rf_iter == gRoutingFunctionMap.end()) {
+    Error("Invalid routing function: " + rf);
+  }
+  _rf = rf_iter->second;
+
+  // only the first traffic class is modeled
+  string traffic = config.GetStrArray("traffic").front();
+  if((traffic == "rand_hotspot") || (traffic == "sel_hotspot")) {
+    Error("Hotspot traffic is not supported by the flow model: " + traffic);
+  }
+  _traffic_pattern = TrafficPattern::New(traffic, _nodes, &config);
+
+  _samples = config.GetInt("flow_samples");
+  if(_samples <= 0) {
+    Error("flow_samples must be positive");
+  }
+  _offered = config.GetFloat("flow_injection_rate");
+  _top_links = config.GetInt("flow_top_links");
+  _util_out = config.GetStr("flow_util_out");
+
+  if(config.GetStr("seed") == "time") {
+    int seed = int(time(NULL));
+    cout << "SEED: seed=" << seed << endl;
+    RandomSeed(seed);
+  } else {
+    RandomSeed(config.GetInt("seed"));
+  }
+
+  // same clustered compute/memory placement as the TrafficManager
+  int num_compute_nodes = config.GetInt("compute_nodes");
+  int num_memory_nodes = config.GetInt("memory_nodes");
+  _compute_nodes.clear();
+  _memory_nodes.clear();
+  for (int c = 0; c < num_compute_nodes; c++)
+    _compute_nodes.insert(c);
+  for (int m = 0; m < num_memory_nodes; m++)
+    _memory_nodes.insert(_nodes - m - 1);
+  assert((int)(_compute_nodes.size() + _memory_nodes.size()) == _nodes);
+  UpdateNodeRoles(_nodes);
+}
+
+FlowModel::~FlowModel( )
+{
+  delete _traffic_pattern;
+}
+
+void FlowModel::_BuildLinks( )
+{
+  vector<FlitChannel *> const & inject = _net->GetInject( );
+  _links.assign(inject.begin(), inject.end());
+
+  vector<Router *> const & routers = _net->GetRouters( );
+  _out_link.resize(routers.size());
+  for(size_t r = 0; r < routers.size(); ++r) {
+    Router const * const router = routers[r];
+    assert(router->GetID() == (int)r);
+    int const outputs = router->NumOutputs( );
+    _out_link[r].resize(outputs);
+    for(int o = 0; o < outputs; ++o) {
+      _out_link[r][o] = _links.size();
+      _links.push_back(router->GetOutputChannel(o));
+    }
+  }
+}
+
+void FlowModel::_TracePath( int src, int dest, int id )
+{
+  Flit * f = Flit::New( );
+  f->id = id;
+  f->pid = id;
+  f->src = src;
+  f->dest = dest;
+  f->cl = 0;
+  f->head = true;
+  f->tail = true;
+  f->ctime = 0;
+
+  OutputSet route;
+  _rf(NULL, f, -1, &route, true);
+  f->vc = route.GetSet().begin()->vc_start;
+
+  FlitChannel const * channel = _links[src];
+  _path_links.push_back(src);
+
+  // a path can never visit more channels than exist in the network
+  int const max_hops = _links.size();
+
+  while(channel->GetSink()) {
+    Router const * const router = channel->GetSink();
+    int const in_channel = channel->GetSinkPort();
+    if(f->hops > max_hops) {
+      ostringstream err;
+      err << "Flow " << src << " -> " << dest << " did not reach its destination";
+      Error(err.str());
+    }
+    route.Clear( );
+    _rf(router, f, in_channel, &route, false);
+    set<OutputSet::sSetElement> const & os = route.GetSet();
+    assert(!os.empty());
+    // highest priority output, as preferred by the VC allocator
+    OutputSet::sSetElement const & se = *os.begin();
+    assert((se.output_port >= 0) && (se.output_port < router->NumOutputs()));
+    f->vc = se.vc_start;
+    int const l = _out_link[router->GetID()][se.output_port];
+    _path_links.push_back(l);
+    channel = _links[l];
+    ++f->hops;
+  }
+  f->Free( );
+}
+
+void FlowModel::_BuildFlows( )
+{
+  double const weight = 1.0 / (double)_samples;
+  int id = 0;
+  for(set<int>::const_iterator i = _compute_nodes.begin(); i != _compute_nodes.end(); ++i) {
+    int const src = *i;
+    for(int s = 0; s < _samples; ++s) {
+      int const dest = _traffic_pattern->dest(src);
+      assert((dest >= 0) && (dest < _nodes));
+      _flow_src.push_back(src);
+      _flow_weight.push_back(weight);
+      _path_start.push_back(_path_links.size());
+      _TracePath(src, dest, id++);
+    }
+  }
+  _path_start.push_back(_path_links.size());
+}
+
+void FlowModel::_ComputeLoad( )
+{
+  _load.assign(_links.size(), 0.0);
+  for(size_t i = 0; i < _flow_src.size(); ++i) {
+    for(int p = _path_start[i]; p < _path_start[i+1]; ++p) {
+      _load[_path_links[p]] += _flow_weight[i];
+    }
+  }
+}
+
+// Progressive filling: all unfrozen flows grow at the same per-source rate
+// until a channel fills up or the offered load is reached; the flows
+// crossing saturated channels are then frozen at their current rate.
+// Freezing flows can only raise the fill level of the other channels, so
+// the channels are visited in order through a lazily updated min-heap.
+void FlowModel::_MaxMinFair( )
+{
+  int const flows = _flow_src.size();
+  int const links = _links.size();
+
+  // channel -> flows crossing it
+  vector<int> link_start(links + 1, 0);
+  for(size_t p = 0; p < _path_links.size(); ++p) {
+    ++link_start[_path_links[p] + 1];
+  }
+  for(int l = 0; l < links; ++l) {
+    link_start[l+1] += link_start[l];
+  }
+  vector<int> link_flows(_path_links.size());
+  vector<int> fill(link_start.begin(), link_start.end() - 1);
+  for(int i = 0; i < flows; ++i) {
+    for(int p = _path_start[i]; p < _path_start[i+1]; ++p) {
+      link_flows[fill[_path_links[p]]++] = i;
+    }
+  }
+
+  double const eps = 1e-9;
+
+  vector<double> active_weight(_load);
+  vector<double> frozen_rate(links, 0.0);
+  vector<bool> frozen(flows, false);
+  _flow_rate.assign(flows, 0.0);
+
+  // (fill level, channel); stale entries are skipped when popped
+  priority_queue<pair<double, int>, vector<pair<double, int> >,
+                 greater<pair<double, int> > > heap;
+  vector<double> fill_level(links, numeric_limits<double>::max());
+  for(int l = 0; l < links; ++l) {
+    if(active_weight[l] > eps) {
+      fill_level[l] = 1.0 / active_weight[l];
+      heap.push(make_pair(fill_level[l], l));
+    }
+  }
+
+  while(!heap.empty()) {
+    double const level = heap.top().first;
+    int const l = heap.top().second;
+    heap.pop();
+    if((level != fill_level[l]) || (active_weight[l] <= eps)) {
+      continue;
+    }
+    if(level >= _offered) {
+      break;
+    }
+    for(int j = link_start[l]; j < link_start[l+1]; ++j) {
+      int const i = link_flows[j];
+      if(frozen[i]) {
+        continue;
+      }
+      frozen[i] = true;
+      _flow_rate[i] = _flow_weight[i] * level;
+      for(int p = _path_start[i]; p < _path_start[i+1]; ++p) {
+        int const k = _path_links[p];
+        frozen_rate[k] += _flow_rate[i];
+        active_weight[k] -= _flow_weight[i];
+      }
+    }
+    // refresh the fill level of every channel touched by the frozen flows
+    for(int j = link_start[l]; j < link_start[l+1]; ++j) {
+      int const i = link_flows[j];
+      for(int p = _path_start[i]; p < _path_start[i+1]; ++p) {
+        int const k = _path_links[p];
+        if(active_weight[k] > eps) {
+          double const level_k = max(level, (1.0 - frozen_rate[k]) / active_weight[k]);
+          if(level_k != fill_level[k]) {
+            fill_level[k] = level_k;
+            heap.push(make_pair(level_k, k));
+          }
+        } else {
+          fill_level[k] = numeric_limits<double>::max();
+        }
+      }
+    }
+  }
+
+  // whatever is left is limited by the offered load only
+  for(int i = 0; i < flows; ++i) {
+    if(!frozen[i]) {
+      _flow_rate[i] = _flow_weight[i] * _offered;
+      for(int p = _path_start[i]; p < _path_start[i+1]; ++p) {
+        frozen_rate[_path_links[p]] += _flow_rate[i];
+      }
+    }
+  }
+
+  _link_rate.swap(frozen_rate);
+}
+
+void FlowModel::Run( )
+{
+  struct timeval start_time, end_time;
+  gettimeofday(&start_time, NULL);
+
+  _BuildLinks( );
+  _BuildFlows( );
+  _ComputeLoad( );
+  _MaxMinFair( );
+
+  gettimeofday(&end_time, NULL);
+  double const total_time = ((double)(end_time.tv_sec) + (double)(end_time.tv_usec)/1000000.0)
+    - ((double)(start_time.tv_sec) + (double)(start_time.tv_usec)/1000000.0);
+
+  DisplayStats( );
+  cout << "Flow model time = " << total_time << endl;
+
+  if(!_util_out.empty()) {
+    ofstream os(_util_out.c_str());
+    WriteUtilization(os);
+  }
+}
+
+void FlowModel::_DisplayLink( int l, ostream & os ) const
+{
+  FlitChannel const * const c = _links[l];
+  if(c->GetSource()) {
+    os << "router " << c->GetSource()->GetID() << " port " << c->GetSourcePort();
+  } else {
+    os << "node " << l;
+  }
+  os << " -> ";
+  if(c->GetSink()) {
+    os << "router " << c->GetSink()->GetID() << " port " << c->GetSinkPort();
+  } else {
+    os << "node";
+  }
+}
+
+void FlowModel::DisplayStats( ostream & os ) const
+{
+  int const links = _links.size();
+
+  double max_load = 0.0;
+  for(int l = 0; l < links; ++l) {
+    max_load = max(max_load, _load[l]);
+  }
+
+  vector<double> accepted(_nodes, 0.0);
+  for(size_t i = 0; i < _flow_src.size(); ++i) {
+    accepted[_flow_src[i]] += _flow_rate[i];
+  }
+  double acc_sum = 0.0;
+  double acc_min = numeric_limits<double>::max();
+  double acc_max = 0.0;
+  for(set<int>::const_iterator i = _compute_nodes.begin(); i != _compute_nodes.end(); ++i) {
+    acc_sum += accepted[*i];
+    acc_min = min(acc_min, accepted[*i]);
+    acc_max = max(acc_max, accepted[*i]);
+  }
+  double const sources = (double)_compute_nodes.size();
+
+  double util_sum = 0.0;
+  double util_max = 0.0;
+  for(int l = 0; l < links; ++l) {
+    util_sum += _link_rate[l];
+    util_max = max(util_max, _link_rate[l]);
+  }
+
+  os << "====== Flow model ======" << endl
+     << "Flows = " << _flow_src.size() << " (" << _samples << " per source)" << endl
+     << "Channels = " << links << endl
+     << "Max channel load = " << max_load << " (per unit injection)" << endl
+     << "Saturation throughput = " << ((max_load > 0.0) ? (1.0 / max_load) : 0.0)
+     << " (flits/cycle/node)" << endl
+     << "Offered rate = " << _offered << " (flits/cycle/node)" << endl
+     << "Accepted rate average = " << acc_sum / sources << endl
+     << "\tminimum = " << acc_min << endl
+     << "\tmaximum = " << acc_max << endl
+     << "Channel utilization average = " << util_sum / (double)links << endl
+     << "\tmaximum = " << util_max << endl;
+
+  if(_top_links > 0) {
+    vector<pair<double, int> > order(links);
+    for(int l = 0; l < links; ++l) {
+      order[l] = make_pair(-_load[l], l);
+    }
+    int const top = min(_top_links, links);
+    partial_sort(order.begin(), order.begin() + top, order.end());
+    os << "Most loaded channels:" << endl;
+    for(int t = 0; t < top; ++t) {
+      int const l = order[t].second;
+      os << "\t";
+      _DisplayLink(l, os);
+      os << " : load = " << _load[l] << ", utilization = " << _link_rate[l] << endl;
+    }
+  }
+}
+
+void FlowModel::WriteUtilization( ostream & os ) const
+{
+  os << "channel,src_router,src_port,dest_router,dest_port,load,utilization" << endl;
+  for(size_t l = 0; l < _links.size(); ++l) {
+    FlitChannel const * const c = _links[l];
+    os << l << ','
+       << (c->GetSource() ? c->GetSource()->GetID() : -1) << ','
+       << c->GetSourcePort() << ','
+       << (c->GetSink() ? c->GetSink()->GetID() : -1) << ','
+       << c->GetSinkPort() << ','
+       << _load[l] << ',' << _link_rate[l] << endl;
+  }
+}
@@ -0,0 +1,87 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _FLOW_MODEL_HPP_
+#define _FLOW_MODEL_HPP_
+
+#include <vector>
+#include <string>
+
+#include "module.hpp"
+#include "config_utils.hpp"
+#include "network.hpp"
+#include "routefunc.hpp"
+#include "traffic.hpp"
+
+// Flow-level (fluid) approximation of a network: every (src, dest) flow is
+// a rate carried over the channels chosen by the configured routing
+// function, and channel bandwidth is shared with max-min fairness. Used
+// with sim_type = flow to estimate saturation before cycle-accurate runs.
+class FlowModel : public Module {
+
+  Network * _net;
+  int _nodes;
+
+  tRoutingFunction _rf;
+  TrafficPattern * _traffic_pattern;
+
+  int _samples;
+  double _offered;
+  int _top_links;
+  string _util_out;
+
+  // channel index space: injection channels first, then router outputs
+  vector<FlitChannel *> _links;
+  vector<vector<int> > _out_link;
+
+  // sampled flows; each one is a path with a weight (fraction of a source)
+  vector<int> _flow_src;
+  vector<double> _flow_weight;
+  vector<int> _path_start;
+  vector<int> _path_links;
+
+  vector<double> _load;
+  vector<double> _flow_rate;
+  vector<double> _link_rate;
+
+  void _BuildLinks( );
+  void _TracePath( int src, int dest, int id );
+  void _BuildFlows( );
+  void _ComputeLoad( );
+  void _MaxMinFair( );
+  void _DisplayLink( int l, ostream & os ) const;
+
+public:
+  FlowModel( Configuration const & config, Network * net );
+  ~FlowModel( );
+
+  void Run( );
+  void DisplayStats( ostream & os = cout ) const;
+  void WriteUtilization( ostream & os ) const;
+};
+
+#endif
@@ -0,0 +1,119 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+
+#include "globals.hpp"
+#include "global_state.hpp"
+#include "dragonfly.hpp"
+#include "anynet.hpp"
+#include "flatfly_onchip.hpp"
+#include "cmesh.hpp"
+
+GlobalState::GlobalState( )
+  : _traffic_manager(NULL), _print_activity(false), _k(0), _n(0), _c(0),
+    _nodes(0), _trace(false), _track_chan_utils(false),
+    _track_wait_time(false), _track_flows(false), _track_stalls(false),
+    _track_buffers(false), _track_credits(false), _watch_out(NULL),
+    _event_trace(NULL), _hs_send_all(false), _node_roles_epoch(0),
+    _num_vcs(0), _read_req_begin_vc(0), _read_req_end_vc(0),
+    _write_req_begin_vc(0), _write_req_end_vc(0), _read_reply_begin_vc(0),
+    _read_reply_end_vc(0), _write_reply_begin_vc(0), _write_reply_end_vc(0),
+    _flowlet_gap(0), _dragonfly_p(0), _dragonfly_a(0), _dragonfly_g(0),
+    _anynet_routing_table(NULL), _flatfly_xcount(0), _flatfly_ycount(0),
+    _flatfly_xrouter(0), _flatfly_yrouter(0), _cmesh_cx(0), _cmesh_cy(0),
+    _cmesh_node_shift_x(0), _cmesh_node_shift_y(0), _cmesh_port_shift_y(0)
+{
+}
+
+void GlobalState::Swap( )
+{
+  using std::swap;
+
+  swap(_traffic_manager, trafficManager);
+
+  swap(_print_activity, gPrintActivity);
+  swap(_k, gK);
+  swap(_n, gN);
+  swap(_c, gC);
+  swap(_nodes, gNodes);
+  swap(_trace, gTrace);
+  swap(_track_chan_utils, gTrackChanUtils);
+  swap(_track_wait_time, gTrackWaitTime);
+  swap(_track_flows, gTrackFlows);
+  swap(_track_stalls, gTrackStalls);
+  swap(_track_buffers, gTrackBuffers);
+  swap(_track_credits, gTrackCredits);
+  swap(_watch_out, gWatchOut);
+  swap(_event_trace, gEventTrace);
+
+  _compute_nodes.swap(::_compute_nodes);
+  _memory_nodes.swap(::_memory_nodes);
+  _hs_dests.swap(::_hs_dests);
+  _hs_srcs.swap(::_hs_srcs);
+  swap(_hs_send_all, ::_hs_send_all);
+  _node_roles.swap(gNodeRoles);
+  swap(_node_roles_epoch, gNodeRolesEpoch);
+  _faulty_links_0.swap(faulty_links_0);
+  _faulty_links_1.swap(faulty_links_1);
+
+  _routing_function_map.swap(gRoutingFunctionMap);
+  swap(_num_vcs, gNumVCs);
+  swap(_read_req_begin_vc, gReadReqBeginVC);
+  swap(_read_req_end_vc, gReadReqEndVC);
+  swap(_write_req_begin_vc, gWriteReqBeginVC);
+  swap(_write_req_end_vc, gWriteReqEndVC);
+  swap(_read_reply_begin_vc, gReadReplyBeginVC);
+  swap(_read_reply_end_vc, gReadReplyEndVC);
+  swap(_write_reply_begin_vc, gWriteReplyBeginVC);
+  swap(_write_reply_end_vc, gWriteReplyEndVC);
+  swap(_flowlet_gap, gFlowletGap);
+
+  swap(_dragonfly_p, gP);
+  swap(_dragonfly_a, gA);
+  swap(_dragonfly_g, gG);
+  swap(_anynet_routing_table, global_routing_table);
+  swap(_flatfly_xcount, ::_xcount);
+  swap(_flatfly_ycount, ::_ycount);
+  swap(_flatfly_xrouter, ::_xrouter);
+  swap(_flatfly_yrouter, ::_yrouter);
+  swap(_cmesh_cx, CMesh::_cX);
+  swap(_cmesh_cy, CMesh::_cY);
+  swap(_cmesh_node_shift_x, CMesh::_memo_NodeShiftX);
+  swap(_cmesh_node_shift_y, CMesh::_memo_NodeShiftY);
+  swap(_cmesh_port_shift_y, CMesh::_memo_PortShiftY);
+
+  _flits.swap(Flit::_all);
+  _free_flits.swap(Flit::_free);
+  _flit_timing.swap(Flit::_timing);
+  _credits.swap(Credit::_all);
+  _free_credits.swap(Credit::_free);
+  _reply_info.swap(PacketReplyInfo::_all);
+  _free_reply_info.swap(PacketReplyInfo::_free);
+
+  SwapRandomState(_random);
+}
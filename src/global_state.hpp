@@ -0,0 +1,105 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _GLOBAL_STATE_HPP_
+#define _GLOBAL_STATE_HPP_
+
+#include <map>
+#include <set>
+#include <stack>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "flit.hpp"
+#include "credit.hpp"
+#include "packet_reply_info.hpp"
+#include "routefunc.hpp"
+#include "random_utils.hpp"
+
+class TrafficManager;
+class EventTrace;
+
+// A private copy of everything the simulator keeps outside its objects: the
+// globals in globals.hpp and routefunc.hpp, topology parameters shared with
+// the routing functions, the flit/credit/reply pools and the random number
+// generators. All of these are per thread, and Swap() exchanges them with
+// this copy. An embedded simulator instance (libbooksim.hpp) swaps its copy
+// in on entry and back out on exit, so independent instances can share a
+// thread or run concurrently on different ones.
+class GlobalState {
+
+  TrafficManager * _traffic_manager;
+
+  bool _print_activity;
+  int _k, _n, _c;
+  int _nodes;
+  bool _trace;
+  bool _track_chan_utils, _track_wait_time, _track_flows;
+  bool _track_stalls, _track_buffers, _track_credits;
+  std::ostream * _watch_out;
+  EventTrace * _event_trace;
+
+  std::set<int> _compute_nodes, _memory_nodes;
+  std::set<int> _hs_dests, _hs_srcs;
+  bool _hs_send_all;
+  std::vector<unsigned char> _node_roles;
+  int _node_roles_epoch;
+  std::set<int> _faulty_links_0, _faulty_links_1;
+
+  std::map<std::string, tRoutingFunction> _routing_function_map;
+  int _num_vcs;
+  int _read_req_begin_vc, _read_req_end_vc;
+  int _write_req_begin_vc, _write_req_end_vc;
+  int _read_reply_begin_vc, _read_reply_end_vc;
+  int _write_reply_begin_vc, _write_reply_end_vc;
+  int _flowlet_gap;
+
+  // topology parameters
+  int _dragonfly_p, _dragonfly_a, _dragonfly_g;
+  std::map<int, int> * _anynet_routing_table;
+  int _flatfly_xcount, _flatfly_ycount, _flatfly_xrouter, _flatfly_yrouter;
+  int _cmesh_cx, _cmesh_cy;
+  int _cmesh_node_shift_x, _cmesh_node_shift_y, _cmesh_port_shift_y;
+
+  std::stack<Flit *> _flits, _free_flits;
+  std::vector<FlitTiming> _flit_timing;
+  std::stack<Credit *> _credits, _free_credits;
+  std::stack<PacketReplyInfo *> _reply_info, _free_reply_info;
+
+  RandomState _random;
+
+public:
+
+  // the state of a freshly started process
+  GlobalState( );
+
+  void Swap( );
+
+};
+
+#endif
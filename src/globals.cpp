@@ -0,0 +1,163 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*globals.cpp
+ *
+ *Definitions of the simulator-wide globals declared in globals.hpp, kept
+ *apart from main() so that other drivers can link against the simulator
+ */
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <set>
+
+#include "booksim.hpp"
+#include "globals.hpp"
+#include "config_utils.hpp"
+#include "routefunc.hpp"
+#include "event_trace.hpp"
+#include "trafficmanager.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+//Global declarations
+//////////////////////
+
+ /* the current traffic manager instance */
+thread_local TrafficManager * trafficManager = NULL;
+
+// drivers without a traffic manager (flow model, benchmarks) run at time 0
+int GetSimTime() {
+  return trafficManager ? trafficManager->getTime() : 0;
+}
+
+class Stats;
+Stats * GetStats(const std::string & name) {
+  Stats* test =  trafficManager->getStats(name);
+  if(test == 0){
+    cout << "warning statistics " << name << " not found" << endl;
+  }
+  return test;
+}
+
+void InitializeGlobals(Configuration const & config) {
+  InitializeRoutingMap( config );
+
+  gPrintActivity = (config.GetInt("print_activity") > 0);
+  gTrace = (config.GetInt("viewer_trace") > 0);
+
+  gTrackChanUtils = (config.GetInt("track_chan_utils") > 0);
+  gTrackWaitTime = (config.GetInt("track_wait_time") > 0);
+  gTrackFlows = (config.GetInt("track_flows") > 0);
+  gTrackStalls = (config.GetInt("track_stalls") > 0);
+  gTrackBuffers = (config.GetInt("track_buffers") > 0);
+  gTrackCredits = (config.GetInt("track_credits") > 0);
+  
+  string watch_out_file = config.GetStr( "watch_out" );
+  if(watch_out_file == "") {
+    gWatchOut = NULL;
+  } else if(watch_out_file == "-") {
+    gWatchOut = &cout;
+  } else {
+    gWatchOut = new ofstream(watch_out_file.c_str());
+  }
+
+  string event_trace_file = config.GetStr( "event_trace_out" );
+  if(event_trace_file != "") {
+    gEventTrace = new EventTrace(event_trace_file, config.GetInt("event_trace_buffer"));
+  }
+}
+
+void FreeGlobals() {
+  if(gEventTrace) {
+    delete gEventTrace;
+    gEventTrace = NULL;
+  }
+  if(gWatchOut && (gWatchOut != &cout)) {
+    delete gWatchOut;
+  }
+  gWatchOut = NULL;
+}
+
+/* printing activity factor*/
+thread_local bool gPrintActivity;
+
+thread_local int gK;//radix
+thread_local int gN;//dimension
+thread_local int gC;//concentration
+
+thread_local int gNodes;
+
+//generate nocviewer trace
+thread_local bool gTrace;
+
+//optional statistics; all collection sites are skipped unless enabled
+thread_local bool gTrackChanUtils = false;
+thread_local bool gTrackWaitTime = false;
+thread_local bool gTrackFlows = false;
+thread_local bool gTrackStalls = false;
+thread_local bool gTrackBuffers = false;
+thread_local bool gTrackCredits = false;
+
+thread_local ostream * gWatchOut;
+
+thread_local EventTrace * gEventTrace = NULL;
+
+// THO: Compute:Memory configuration
+thread_local set<int> _compute_nodes;
+thread_local set<int> _memory_nodes;
+
+// THO: Hotspot sets
+thread_local set<int> _hs_dests;
+thread_local set<int> _hs_srcs;
+thread_local bool _hs_send_all;
+
+thread_local vector<unsigned char> gNodeRoles;
+thread_local int gNodeRolesEpoch = 0;
+
+static void _MarkRole(set<int> const & nodes, unsigned char role)
+{
+  for(set<int>::const_iterator i = nodes.begin(); i != nodes.end(); ++i) {
+    assert((*i >= 0) && (*i < (int)gNodeRoles.size()));
+    gNodeRoles[*i] |= role;
+  }
+}
+
+void UpdateNodeRoles(int nodes)
+{
+  gNodeRoles.assign(nodes, 0);
+  _MarkRole(_compute_nodes, NODE_COMPUTE);
+  _MarkRole(_memory_nodes, NODE_MEMORY);
+  _MarkRole(_hs_srcs, NODE_HS_SRC);
+  _MarkRole(_hs_dests, NODE_HS_DEST);
+  ++gNodeRolesEpoch;
+}
+
+thread_local set<int> faulty_links_0;
+thread_local set<int> faulty_links_1;
+
+// vector<int> destination_stats;
@@ -33,38 +33,73 @@
 
 #include <set>
 
-/*all declared in main.cpp*/
+/*all defined in globals.cpp; each thread has its own copy, and the library
+  interface (libbooksim.hpp) swaps a per-instance copy in around each call*/
+
+class TrafficManager;
+extern thread_local TrafficManager * trafficManager;
 
 int GetSimTime();
 
 class Stats;
 Stats * GetStats(const std::string & name);
 
-extern bool gPrintActivity;
+// Sets the globals below and the routing functions up from the
+// configuration; FreeGlobals() closes the watch and event trace outputs.
+class Configuration;
+void InitializeGlobals(Configuration const & config);
+void FreeGlobals();
+
+extern thread_local bool gPrintActivity;
+
+extern thread_local int gK;
+extern thread_local int gN;
+extern thread_local int gC;
 
-extern int gK;
-extern int gN;
-extern int gC;
+extern thread_local int gNodes;
 
-extern int gNodes;
+extern thread_local bool gTrace;
 
-extern bool gTrace;
+// optional statistics, selected per run by the track_* options
+extern thread_local bool gTrackChanUtils;
+extern thread_local bool gTrackWaitTime;
+extern thread_local bool gTrackFlows;
+extern thread_local bool gTrackStalls;
+extern thread_local bool gTrackBuffers;
+extern thread_local bool gTrackCredits;
 
-extern std::ostream * gWatchOut;
+extern thread_local std::ostream * gWatchOut;
+
+// binary event trace, NULL unless event_trace_out is set
+class EventTrace;
+extern thread_local EventTrace * gEventTrace;
 
 // THO: Additionals for selecting active nodes
-extern std::set<int> _compute_nodes;
-extern std::set<int> _memory_nodes;
+extern thread_local std::set<int> _compute_nodes;
+extern thread_local std::set<int> _memory_nodes;
 
 // THO: Hotspot related
-extern std::set<int> _hs_dests;
-extern std::set<int> _hs_srcs;
-extern bool _hs_send_all;
+extern thread_local std::set<int> _hs_dests;
+extern thread_local std::set<int> _hs_srcs;
+extern thread_local bool _hs_send_all;
 // extern std::vector<int> destination_stats;
 
+// Dense per-node copy of the role sets above for hot-path lookups. Call
+// UpdateNodeRoles() after changing any of the sets; gNodeRolesEpoch counts
+// the updates so that cached per-role tables know when to rebuild.
+enum { NODE_COMPUTE = 1, NODE_MEMORY = 2, NODE_HS_SRC = 4, NODE_HS_DEST = 8 };
+extern thread_local std::vector<unsigned char> gNodeRoles;
+extern thread_local int gNodeRolesEpoch;
+void UpdateNodeRoles(int nodes);
+
+inline bool IsComputeNode(int node) { return gNodeRoles[node] & NODE_COMPUTE; }
+inline bool IsMemoryNode(int node) { return gNodeRoles[node] & NODE_MEMORY; }
+inline bool IsHotspotSrc(int node) { return gNodeRoles[node] & NODE_HS_SRC; }
+inline bool IsHotspotDest(int node) { return gNodeRoles[node] & NODE_HS_DEST; }
+
 // THO: Faulty channels
-extern std::set<int> faulty_links_0;
-extern std::set<int> faulty_links_1;
+extern thread_local std::set<int> faulty_links_0;
+extern thread_local std::set<int> faulty_links_1;
 
 
 #endif
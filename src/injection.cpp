@@ -162,10 +162,10 @@ HotspotInjectionProcess::HotspotInjectionProcess(int nodes, double rate)
 bool HotspotInjectionProcess::test(int source)
 {
   assert((source >= 0) && (source < _nodes));
-  if (_hs_dests.count(source) != 0)
+  if (IsHotspotDest(source))
     return false;
   else {
-    if (_hs_srcs.count(source) == 0)
+    if (!IsHotspotSrc(source))
       return false;
     else
       return (RandomFloat() < _rate);
@@ -182,7 +182,7 @@ BackgroundInjectionProcess::BackgroundInjectionProcess(int nodes, double rate)
 bool BackgroundInjectionProcess::test(int source)
 {
   assert((source >= 0) && (source < _nodes));
-  if (_hs_srcs.count(source) != 0 || _hs_dests.count(source) != 0)
+  if (IsHotspotSrc(source) || IsHotspotDest(source))
     return false;
   else
     return (RandomFloat() < _rate);
@@ -0,0 +1,136 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <sstream>
+
+#include "booksim.hpp"
+#include "globals.hpp"
+#include "global_state.hpp"
+#include "network.hpp"
+#include "librarytrafficmanager.hpp"
+#include "libbooksim.hpp"
+
+BookSimContext::BookSimContext( Configuration const & config )
+  : _state(new GlobalState), _traffic_manager(NULL),
+    _completions(config.GetInt("completion_queue_size"))
+{
+  _state->Swap( );
+
+  InitializeGlobals( config );
+
+  int const subnets = config.GetInt("subnets");
+  _net.resize(subnets);
+  for (int i = 0; i < subnets; ++i) {
+    ostringstream name;
+    name << "network_" << i;
+    _net[i] = Network::New( config, name.str() );
+  }
+  _nodes = _net[0]->NumNodes( );
+
+  _traffic_manager = new LibraryTrafficManager( config, _net );
+  trafficManager = _traffic_manager;
+
+  _state->Swap( );
+}
+
+BookSimContext::~BookSimContext( )
+{
+  _state->Swap( );
+
+  for (int i = 0; i < (int)_net.size(); ++i) {
+    delete _net[i];
+  }
+  delete _traffic_manager;
+  trafficManager = NULL;
+
+  FreeGlobals( );
+
+  _state->Swap( );
+  delete _state;
+}
+
+int BookSimContext::Nodes( ) const
+{
+  return _nodes;
+}
+
+int BookSimContext::Time( ) const
+{
+  return _traffic_manager->getTime( );
+}
+
+int BookSimContext::Pending( ) const
+{
+  return _traffic_manager->Pending( );
+}
+
+// only touches the traffic manager's own queues, so the simulator-wide
+// state does not need to be swapped in
+void BookSimContext::Inject( int src, int dest, int flits, long long tag, int cl )
+{
+  _traffic_manager->Inject( src, dest, flits, tag, cl );
+}
+
+bool BookSimContext::Step( int cycles )
+{
+  _state->Swap( );
+  for (int i = 0; (i < cycles) && !_traffic_manager->Deadlocked( ); ++i) {
+    _traffic_manager->Step( );
+    _Dispatch( );
+  }
+  bool const running = !_traffic_manager->Deadlocked( );
+  _state->Swap( );
+  return running;
+}
+
+void BookSimContext::SetDeliveryCallback( DeliveryCallback callback )
+{
+  _callback = callback;
+}
+
+bool BookSimContext::PollDelivery( Delivery & d )
+{
+  return _completions.Pop( d );
+}
+
+void BookSimContext::_Dispatch( )
+{
+  while(!_overflow.empty() && _completions.Push(_overflow.front())) {
+    _overflow.pop_front();
+  }
+
+  vector<Delivery> const & delivered = _traffic_manager->Delivered( );
+  for (size_t i = 0; i < delivered.size(); ++i) {
+    Delivery const & d = delivered[i];
+    if(_callback) {
+      _callback(d);
+    } else if(!_overflow.empty() || !_completions.Push(d)) {
+      _overflow.push_back(d);
+    }
+  }
+  _traffic_manager->ClearDelivered( );
+}
@@ -0,0 +1,108 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _LIBBOOKSIM_HPP_
+#define _LIBBOOKSIM_HPP_
+
+#include <deque>
+#include <vector>
+#include <functional>
+
+#include "config_utils.hpp"
+#include "completion_queue.hpp"
+
+class Network;
+class GlobalState;
+class LibraryTrafficManager;
+
+// A message handed to BookSimContext::Inject, reported back on delivery
+struct Delivery {
+  int src;
+  int dest;
+  int flits;
+  int cl;
+  long long tag;
+  int mid;          // simulator message id, numbered from 0 per context
+  int inject_time;  // cycle of the Inject() call
+  int deliver_time; // cycle in which its last flit retired
+};
+
+// Embeddable simulator for co-simulation, built as libbooksim.a by
+// "make lib". A context owns a complete simulator instance: its networks,
+// traffic manager and a private copy of the simulator-wide state (see
+// global_state.hpp). The host injects messages and advances the clock;
+// delivered messages go to the delivery callback if one is set, and are
+// otherwise buffered in a lock-free queue that another thread may drain
+// with PollDelivery(). Any number of contexts can exist in one process.
+// Each one must only be driven by one thread at a time, but different
+// contexts may be stepped concurrently on different threads.
+class BookSimContext {
+
+public:
+
+  typedef std::function<void(Delivery const &)> DeliveryCallback;
+
+  BookSimContext( Configuration const & config );
+  ~BookSimContext( );
+
+  int Nodes( ) const;
+  int Time( ) const;
+  // messages injected but not yet delivered
+  int Pending( ) const;
+
+  // queue a message of the given size in flits; it enters the network
+  // once earlier messages of the same source and class have
+  void Inject( int src, int dest, int flits, long long tag, int cl = 0 );
+  // returns false, and stops advancing the clock, once a network deadlock
+  // has been confirmed (deadlock_abort)
+  bool Step( int cycles = 1 );
+
+  // called from Step() for every delivered message
+  void SetDeliveryCallback( DeliveryCallback callback );
+  // may be called from another thread than the one calling Step()
+  bool PollDelivery( Delivery & d );
+
+private:
+
+  GlobalState * _state;
+  std::vector<Network *> _net;
+  LibraryTrafficManager * _traffic_manager;
+  int _nodes;
+
+  DeliveryCallback _callback;
+  CompletionQueue<Delivery> _completions;
+  // deliveries that did not fit into the completion queue yet
+  std::deque<Delivery> _overflow;
+
+  void _Dispatch( );
+
+  BookSimContext( BookSimContext const & );
+  BookSimContext & operator=( BookSimContext const & );
+
+};
+
+#endif
@@ -0,0 +1,124 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <sstream>
+
+#include "librarytrafficmanager.hpp"
+
+LibraryTrafficManager::LibraryTrafficManager( const Configuration &config, 
+					      const vector<Network *> & net )
+: TrafficManager(config, net), _pending(0)
+{
+  for(int c = 0; c < _classes; ++c) {
+    if(_use_read_write[c]) {
+      Error( "The library interface cannot use read/write requests" );
+    }
+  }
+  _requests.resize(_nodes, vector<deque<Delivery> >(_classes));
+  _sim_state = running;
+}
+
+void LibraryTrafficManager::Inject( int source, int dest, int flits, 
+				    long long tag, int cl )
+{
+  if((source < 0) || (source >= _nodes) || (dest < 0) || (dest >= _nodes)) {
+    ostringstream err;
+    err << "Invalid message from " << source << " to " << dest;
+    Error( err.str( ) );
+  }
+  if((cl < 0) || (cl >= _classes)) {
+    ostringstream err;
+    err << "Invalid message class " << cl;
+    Error( err.str( ) );
+  }
+  if(flits <= 0) {
+    ostringstream err;
+    err << "Invalid message size " << flits;
+    Error( err.str( ) );
+  }
+  Delivery d;
+  d.src = source;
+  d.dest = dest;
+  d.flits = flits;
+  d.cl = cl;
+  d.tag = tag;
+  d.mid = -1;
+  d.inject_time = _time;
+  d.deliver_time = -1;
+  _requests[source][cl].push_back(d);
+  ++_pending;
+}
+
+void LibraryTrafficManager::Step( )
+{
+  _Step( );
+}
+
+void LibraryTrafficManager::_RetireFlit( Flit *f, int dest )
+{
+  map<int, pair<Delivery, int> >::iterator iter = _outstanding.find(f->mid);
+  assert(iter != _outstanding.end());
+  if(--iter->second.second == 0) {
+    iter->second.first.deliver_time = _time;
+    _delivered.push_back(iter->second.first);
+    _outstanding.erase(iter);
+    --_pending;
+  }
+  TrafficManager::_RetireFlit(f, dest);
+}
+
+int LibraryTrafficManager::_IssueMessage( int source, int cl )
+{
+  deque<Delivery> const & requests = _requests[source][cl];
+  if(requests.empty() || (requests.front().inject_time > _qtime[source][cl])) {
+    return 0;
+  }
+  _requestsOutstanding[source]++;
+  _message_seq_no[source]++;
+  return 1;
+}
+
+void LibraryTrafficManager::_NextRequest( int source, int cl, 
+					  int & dest, int & flits )
+{
+  deque<Delivery> & requests = _requests[source][cl];
+  assert(!requests.empty());
+  _issued = requests.front();
+  requests.pop_front();
+  dest = _issued.dest;
+  flits = _issued.flits;
+}
+
+void LibraryTrafficManager::_GenerateMessage( int source, int stype, 
+					      int cl, int time )
+{
+  int const mid = _cur_mid;
+  TrafficManager::_GenerateMessage(source, stype, cl, time);
+  _issued.mid = mid;
+  QueuedMessage const & qm = _queued_messages[source][cl];
+  _outstanding[mid] = make_pair(_issued, qm.packets * qm.packet_size);
+}
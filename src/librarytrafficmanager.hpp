@@ -0,0 +1,89 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _LIBRARYTRAFFICMANAGER_HPP_
+#define _LIBRARYTRAFFICMANAGER_HPP_
+
+#include <deque>
+#include <map>
+
+#include "config_utils.hpp"
+#include "trafficmanager.hpp"
+#include "libbooksim.hpp"
+
+// Traffic manager behind the library interface (libbooksim.hpp). Instead
+// of the traffic patterns and injection processes, every class injects the
+// messages queued by the host through Inject(); a message is delivered once
+// all of its flits have retired. The simulation never warms up or drains,
+// it runs for as long as the host keeps stepping it.
+class LibraryTrafficManager : public TrafficManager {
+
+protected:
+
+  // host messages waiting for their source, per source and class
+  vector<vector<deque<Delivery> > > _requests;
+
+  // host message being generated by _GenerateMessage
+  Delivery _issued;
+  // simulator message id -> (host message, flits not yet retired)
+  map<int, pair<Delivery, int> > _outstanding;
+
+  vector<Delivery> _delivered;
+  int _pending;
+
+  virtual void _RetireFlit( Flit *f, int dest );
+  virtual int _IssueMessage( int source, int cl );
+  virtual void _GenerateMessage( int source, int stype, int cl, int time );
+  virtual void _NextRequest( int source, int cl, int & dest, int & flits );
+
+public:
+
+  LibraryTrafficManager( const Configuration &config, const vector<Network *> & net );
+
+  void Inject( int source, int dest, int flits, long long tag, int cl );
+  void Step( );
+
+  // messages delivered since the last call to ClearDelivered()
+  inline vector<Delivery> const & Delivered( ) const {
+    return _delivered;
+  }
+  inline void ClearDelivered( ) {
+    _delivered.clear( );
+  }
+
+  // messages injected but not yet delivered
+  inline int Pending( ) const {
+    return _pending;
+  }
+
+  inline bool Deadlocked( ) const {
+    return _deadlocked;
+  }
+
+};
+
+#endif
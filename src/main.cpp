@@ -35,6 +35,7 @@
  *
  */
 #include <sys/time.h>
+#include <sys/resource.h>
 
 #include <string>
 #include <cstdlib>
@@ -53,63 +54,18 @@
 #include "network.hpp"
 #include "injection.hpp"
 #include "power_module.hpp"
+#include "flow_model.hpp"
+#include "profiler.hpp"
 
 
 
-///////////////////////////////////////////////////////////////////////////////
-//Global declarations
-//////////////////////
-
- /* the current traffic manager instance */
-TrafficManager * trafficManager = NULL;
-
-int GetSimTime() {
-  return trafficManager->getTime();
-}
-
-class Stats;
-Stats * GetStats(const std::string & name) {
-  Stats* test =  trafficManager->getStats(name);
-  if(test == 0){
-    cout << "warning statistics " << name << " not found" << endl;
-  }
-  return test;
-}
-
-/* printing activity factor*/
-bool gPrintActivity;
-
-int gK;//radix
-int gN;//dimension
-int gC;//concentration
-
-int gNodes;
-
-//generate nocviewer trace
-bool gTrace;
-
-ostream * gWatchOut;
-
-// THO: Compute:Memory configuration
-set<int> _compute_nodes;
-set<int> _memory_nodes;
-
-// THO: Hotspot sets
-set<int> _hs_dests;
-set<int> _hs_srcs;
-bool _hs_send_all;
-
-set<int> faulty_links_0;
-set<int> faulty_links_1;
-
-// vector<int> destination_stats;
-
-/////////////////////////////////////////////////////////////////////////////
-
 bool Simulate( BookSimConfig const & config )
 {
   vector<Network *> net;
 
+  struct timeval build_start, build_end;
+  gettimeofday(&build_start, NULL);
+
   int subnets = config.GetInt("subnets");
   /*To include a new network, must register the network here
    *add an else if statement with the name of the network
@@ -121,6 +77,16 @@ bool Simulate( BookSimConfig const & config )
     net[i] = Network::New( config, name.str() );
   }
 
+  // THO: Flow-level estimate, no cycle-accurate simulation
+  if(config.GetStr("sim_type") == "flow") {
+    FlowModel flow_model(config, net[0]);
+    flow_model.Run();
+    for (int i=0; i<subnets; ++i) {
+      delete net[i];
+    }
+    return true;
+  }
+
   /*tcc and characterize are legacy
    *not sure how to use them 
    */
@@ -128,6 +94,10 @@ bool Simulate( BookSimConfig const & config )
   assert(trafficManager == NULL);
   trafficManager = TrafficManager::New( config, net ) ;
 
+  gettimeofday(&build_end, NULL);
+  double const build_time = ((double)(build_end.tv_sec) + (double)(build_end.tv_usec)/1000000.0)
+            - ((double)(build_start.tv_sec) + (double)(build_start.tv_usec)/1000000.0);
+
   /*Start the simulation run
    */
 
@@ -145,6 +115,26 @@ bool Simulate( BookSimConfig const & config )
 
   cout << "Total run time " << total_time << endl;
 
+#ifdef TRACK_PROFILE
+  Profiler::Display(cout, GetSimTime(), total_time);
+#endif
+
+  if(config.GetInt("print_perf_stats") > 0) {
+    // ru_maxrss is in kilobytes on Linux
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    int const cycles = GetSimTime();
+    int const flits = trafficManager->getFlitCount();
+    cout << "perf:construction_time=" << build_time
+	 << ",run_time=" << total_time
+	 << ",cycles=" << cycles
+	 << ",flits=" << flits
+	 << ",cycles_per_sec=" << (total_time > 0.0 ? cycles / total_time : 0.0)
+	 << ",flits_per_sec=" << (total_time > 0.0 ? flits / total_time : 0.0)
+	 << ",peak_rss_kb=" << usage.ru_maxrss
+	 << endl;
+  }
+
   for (int i=0; i<subnets; ++i) {
 
     ///Power analysis
@@ -177,23 +167,12 @@ int main( int argc, char **argv )
   
   /*initialize routing, traffic, injection functions
    */
-  InitializeRoutingMap( config );
-
-  gPrintActivity = (config.GetInt("print_activity") > 0);
-  gTrace = (config.GetInt("viewer_trace") > 0);
-  
-  string watch_out_file = config.GetStr( "watch_out" );
-  if(watch_out_file == "") {
-    gWatchOut = NULL;
-  } else if(watch_out_file == "-") {
-    gWatchOut = &cout;
-  } else {
-    gWatchOut = new ofstream(watch_out_file.c_str());
-  }
-  
+  InitializeGlobals( config );
 
   /*configure and run the simulator
    */
   bool result = Simulate( config );
+
+  FreeGlobals( );
   return result ? -1 : 0;
 }
@@ -0,0 +1,151 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "message_trace.hpp"
+
+// records consumed by a source before the pages behind its cursor are
+// handed back to the kernel (4 MB of records)
+static const long long TRACE_RELEASE_RECORDS = 
+  (4 << 20) / sizeof(MessageTraceRecord);
+
+MessageTrace::MessageTrace( string const & filename, int nodes )
+  : _filename(filename), _map(NULL), _bytes(0)
+{
+  _fd = open(_filename.c_str(), O_RDONLY);
+  struct stat st;
+  if((_fd < 0) || (fstat(_fd, &st) != 0)) {
+    cout << "Error: Unable to open message trace " << _filename << endl;
+    exit(-1);
+  }
+  _bytes = st.st_size;
+  if(_bytes < sizeof(MessageTraceHeader)) {
+    cout << "Error: " << _filename << " is not a message trace" << endl;
+    exit(-1);
+  }
+  void * const p = mmap(NULL, _bytes, PROT_READ, MAP_PRIVATE, _fd, 0);
+  if(p == MAP_FAILED) {
+    cout << "Error: Unable to map message trace " << _filename << endl;
+    exit(-1);
+  }
+  _map = (char *)p;
+
+  MessageTraceHeader const * const h = (MessageTraceHeader const *)_map;
+  if(memcmp(h->magic, "BSMSGTR", 8) || (h->version != VERSION)) {
+    cout << "Error: " << _filename << " is not a version " << VERSION
+	 << " message trace" << endl;
+    exit(-1);
+  }
+  if(h->nodes > nodes) {
+    cout << "Error: Message trace " << _filename << " has " << h->nodes
+	 << " sources but the network only has " << nodes << " nodes" << endl;
+    exit(-1);
+  }
+  MessageTraceIndex const * const index = (MessageTraceIndex const *)(h + 1);
+  _records = (MessageTraceRecord const *)(index + h->nodes);
+  size_t const header_bytes = (char const *)_records - _map;
+  if((header_bytes > _bytes) || 
+     (header_bytes + h->messages * sizeof(MessageTraceRecord) > _bytes)) {
+    cout << "Error: Message trace " << _filename << " is truncated" << endl;
+    exit(-1);
+  }
+
+  _index.resize(nodes);
+  long long total = 0;
+  for(int s = 0; s < nodes; ++s) {
+    if(s < h->nodes) {
+      _index[s] = index[s];
+      if((_index[s].first < 0) || (_index[s].count < 0) ||
+	 (_index[s].first + _index[s].count > h->messages)) {
+	cout << "Error: Message trace " << _filename 
+	     << " has a bad index for source " << s << endl;
+	exit(-1);
+      }
+    } else {
+      _index[s].first = 0;
+      _index[s].count = 0;
+    }
+    total += _index[s].count;
+  }
+  if(total != h->messages) {
+    cout << "Error: Message trace " << _filename << " index covers " << total
+	 << " of " << h->messages << " messages" << endl;
+    exit(-1);
+  }
+
+  Reset();
+}
+
+MessageTrace::~MessageTrace( )
+{
+  munmap(_map, _bytes);
+  close(_fd);
+}
+
+void MessageTrace::Reset( )
+{
+  _next.assign(_index.size(), 0);
+  _kept.assign(_index.size(), 0);
+  _remaining = 0;
+  for(size_t s = 0; s < _index.size(); ++s) {
+    _remaining += _index[s].count;
+  }
+}
+
+void MessageTrace::Pop( int source )
+{
+  assert(Peek(source));
+  ++_next[source];
+  --_remaining;
+  if(_next[source] - _kept[source] >= TRACE_RELEASE_RECORDS) {
+    _Release(source);
+  }
+}
+
+void MessageTrace::_Release( int source )
+{
+  // only whole pages that lie entirely behind the cursor can go
+  size_t const page = sysconf(_SC_PAGESIZE);
+  char const * const base = (char const *)&_records[_index[source].first];
+  size_t begin = (base + _kept[source] * sizeof(MessageTraceRecord)) - _map;
+  size_t end = (base + _next[source] * sizeof(MessageTraceRecord)) - _map;
+  begin = (begin + page - 1) / page * page;
+  end = end / page * page;
+  if(end > begin) {
+    madvise(_map + begin, end - begin, MADV_DONTNEED);
+  }
+  _kept[source] = _next[source];
+}
@@ -0,0 +1,102 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _MESSAGE_TRACE_HPP_
+#define _MESSAGE_TRACE_HPP_
+
+// Binary message trace replayed by sim_type = trace. The file holds a
+// MessageTraceHeader, one MessageTraceIndex per source node, and then the
+// records of each source in turn, sorted by time within a source. The
+// file is memory-mapped and each source is read through its own cursor;
+// pages behind the cursors are released as they are consumed, so only the
+// current window of a trace of any length is resident.
+//
+// booksim_msgtrace (make msgtrace) converts a text trace into this format.
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct MessageTraceHeader {
+  char magic[8];      // "BSMSGTR\0"
+  int version;
+  int nodes;          // number of source indices that follow
+  long long messages;
+};
+
+struct MessageTraceIndex {
+  long long first;    // first record of this source
+  long long count;
+};
+
+struct MessageTraceRecord {
+  long long time;     // injection cycle
+  int dest;
+  int size;           // in flits; 0 for the configured message size
+  int type;           // 0 = any, 1 = read request, 2 = write request
+  int reserved;
+};
+
+class MessageTrace {
+
+  string _filename;
+  int _fd;
+  char * _map;
+  size_t _bytes;
+
+  MessageTraceRecord const * _records;
+  vector<MessageTraceIndex> _index;
+  vector<long long> _next;
+  // start of the part of each source's records that may still be resident
+  vector<long long> _kept;
+  long long _remaining;
+
+  void _Release( int source );
+
+public:
+
+  static const int VERSION = 2;
+
+  MessageTrace( string const & filename, int nodes );
+  ~MessageTrace( );
+
+  // next message of a source, or NULL once its records are exhausted
+  inline MessageTraceRecord const * Peek( int source ) const {
+    return (_next[source] < _index[source].count) ? 
+      &_records[_index[source].first + _next[source]] : NULL;
+  }
+  void Pop( int source );
+
+  void Reset( );
+
+  inline bool Done( ) const { return _remaining == 0; }
+  inline long long Remaining( ) const { return _remaining; }
+  inline int Nodes( ) const { return _index.size(); }
+};
+
+#endif
@@ -64,6 +64,9 @@ public:
   void InsertRandomFaults( const Configuration &config ){}
 };
 
+// routing table of the most recently built AnyNet
+extern thread_local map<int, int>* global_routing_table;
+
 void min_anynet( const Router *r, const Flit *f, int in_channel, 
 		      OutputSet *outputs, bool inject );
 #endif
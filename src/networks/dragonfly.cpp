@@ -37,7 +37,7 @@
 
 #define DRAGON_LATENCY
 
-int gP, gA, gG;
+thread_local int gP, gA, gG;
 
 //calculate the hop count between src and estination
 int dragonflynew_hopcnt(int src, int dest) 
@@ -64,6 +64,10 @@ public:
   void InsertRandomFaults( const Configuration &config );
 
 };
+
+// group geometry shared with the routing functions
+extern thread_local int gP, gA, gG;
+
 int dragonfly_port(int rID, int source, int dest);
 
 void ugal_dragonflynew( const Router *r, const Flit *f, int in_channel,
@@ -60,10 +60,10 @@
 
 //#define DEBUG_FLATFLY
 
-static int _xcount;
-static int _ycount;
-static int _xrouter;
-static int _yrouter;
+thread_local int _xcount;
+thread_local int _ycount;
+thread_local int _xrouter;
+thread_local int _yrouter;
 
 FlatFlyOnChip::FlatFlyOnChip( const Configuration &config, const string & name ) :
   Network( config, name )
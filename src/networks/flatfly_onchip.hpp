@@ -79,6 +79,12 @@ void ugal_pni_flatfly_onchip( const Router *r, const Flit *f, int in_channel,
 void valiant_flatfly( const Router *r, const Flit *f, int in_channel,
 			  OutputSet *outputs, bool inject );
 
+// topology parameters shared with the routing functions
+extern thread_local int _xcount;
+extern thread_local int _ycount;
+extern thread_local int _xrouter;
+extern thread_local int _yrouter;
+
 int find_distance (int src, int dest);
 int find_ran_intm (int src, int dest);
 int flatfly_outport(int dest, int rID);
@@ -37,6 +37,7 @@
 
 #include "booksim.hpp"
 #include "network.hpp"
+#include "profiler.hpp"
 
 #include "kncube.hpp"
 #include "fly.hpp"
@@ -187,6 +188,7 @@ void Network::_Alloc( )
 
 void Network::ReadInputs( )
 {
+  PROFILE_SCOPE("Network::ReadInputs");
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
@@ -196,6 +198,7 @@ void Network::ReadInputs( )
 
 void Network::Evaluate( )
 {
+  PROFILE_SCOPE("Network::Evaluate");
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
@@ -205,6 +208,7 @@ void Network::Evaluate( )
 
 void Network::WriteOutputs( )
 {
+  PROFILE_SCOPE("Network::WriteOutputs");
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
@@ -294,11 +298,3 @@ void Network::DumpNodeMap( ostream & os, string const & prefix ) const
        << _eject[s]->GetSource()->GetID() << ','
        << _inject[s]->GetSink()->GetID() << endl;
 }
-
-#ifdef CHAN_UTILS
-int Network::GetChanUtil( int r, int o )
-{
-  assert((r >= 0) && (r < _size));
-  return _routers[r]->GetChanUtil(o);
-}
-#endif
\ No newline at end of file
@@ -112,10 +112,6 @@ public:
   const vector<Router *> & GetRouters(){return _routers;}
   Router * GetRouter(int index) {return _routers[index];}
   int NumRouters() const {return _size;}
-
-#ifdef CHAN_UTILS
-  int GetChanUtil (int r, int o);
-#endif
 };
 
 #endif 
@@ -47,8 +47,10 @@ public:
 
 private:
 
-  static stack<PacketReplyInfo*> _all;
-  static stack<PacketReplyInfo*> _free;
+  friend class GlobalState;
+
+  static thread_local stack<PacketReplyInfo*> _all;
+  static thread_local stack<PacketReplyInfo*> _free;
 
   PacketReplyInfo() {}
   ~PacketReplyInfo() {}
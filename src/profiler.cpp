@@ -0,0 +1,100 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "profiler.hpp"
+
+#ifdef TRACK_PROFILE
+
+#include <algorithm>
+#include <iomanip>
+
+std::vector<Profiler::Entry> Profiler::_entries;
+
+int Profiler::Register( std::string const & name )
+{
+  for(size_t i = 0; i < _entries.size(); ++i) {
+    if(_entries[i].name == name) {
+      return i;
+    }
+  }
+  Entry e;
+  e.name = name;
+  e.ns = 0;
+  e.calls = 0;
+  _entries.push_back(e);
+  return _entries.size() - 1;
+}
+
+void Profiler::Reset( )
+{
+  for(size_t i = 0; i < _entries.size(); ++i) {
+    _entries[i].ns = 0;
+    _entries[i].calls = 0;
+  }
+}
+
+static bool _ByTime( std::pair<long long, int> const & a,
+		     std::pair<long long, int> const & b )
+{
+  return a.first > b.first;
+}
+
+void Profiler::Display( std::ostream & os, int cycles, double run_time )
+{
+  std::vector<std::pair<long long, int> > order;
+  for(size_t i = 0; i < _entries.size(); ++i) {
+    if(_entries[i].calls > 0) {
+      order.push_back(std::make_pair(_entries[i].ns, (int)i));
+    }
+  }
+  std::sort(order.begin(), order.end(), _ByTime);
+
+  os << "Profile (inclusive wall time per stage):" << std::endl;
+  os << std::setw(36) << std::left << "stage" << std::right
+     << std::setw(14) << "calls"
+     << std::setw(12) << "time (s)"
+     << std::setw(8) << "%run"
+     << std::setw(12) << "ns/call" << std::endl;
+  for(size_t i = 0; i < order.size(); ++i) {
+    Entry const & e = _entries[order[i].second];
+    double const secs = (double)e.ns / 1e9;
+    os << std::setw(36) << std::left << e.name << std::right
+       << std::setw(14) << e.calls
+       << std::setw(12) << std::fixed << std::setprecision(3) << secs
+       << std::setw(8) << std::setprecision(1)
+       << ((run_time > 0.0) ? (100.0 * secs / run_time) : 0.0)
+       << std::setw(12) << std::setprecision(1) << ((double)e.ns / e.calls)
+       << std::endl;
+  }
+  os.unsetf(std::ios::fixed);
+  os << std::setprecision(6);
+  if(run_time > 0.0) {
+    os << "Simulated cycles per second = " << (double)cycles / run_time << std::endl;
+  }
+}
+
+#endif
@@ -0,0 +1,91 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _PROFILER_HPP_
+#define _PROFILER_HPP_
+
+// Hot-path profiling counters, compiled in only with -DTRACK_PROFILE.
+// PROFILE_SCOPE("name") accumulates wall time and call count for the
+// enclosing block under the given name; scopes may nest, so reported times
+// are inclusive of any nested scopes.
+
+#ifdef TRACK_PROFILE
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <time.h>
+
+class Profiler {
+
+  struct Entry {
+    std::string name;
+    long long ns;
+    long long calls;
+  };
+
+  static std::vector<Entry> _entries;
+
+public:
+  static int Register( std::string const & name );
+
+  static inline long long Now( ) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+  }
+
+  static inline void Add( int id, long long ns ) {
+    _entries[id].ns += ns;
+    ++_entries[id].calls;
+  }
+
+  static void Reset( );
+  static void Display( std::ostream & os, int cycles, double run_time );
+};
+
+class ProfileScope {
+  int _id;
+  long long _start;
+public:
+  ProfileScope( int id ) : _id(id), _start(Profiler::Now()) {}
+  ~ProfileScope( ) { Profiler::Add(_id, Profiler::Now() - _start); }
+};
+
+#define PROFILE_CAT2(a, b) a##b
+#define PROFILE_CAT(a, b) PROFILE_CAT2(a, b)
+#define PROFILE_SCOPE(name)						\
+  static int const PROFILE_CAT(_profile_id_, __LINE__) = Profiler::Register(name); \
+  ProfileScope PROFILE_CAT(_profile_scope_, __LINE__)(PROFILE_CAT(_profile_id_, __LINE__))
+
+#else
+
+#define PROFILE_SCOPE(name)
+
+#endif
+
+#endif
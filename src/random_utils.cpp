@@ -29,9 +29,16 @@
 #include <algorithm>
 #include <cassert>
 
-extern long ran_x[];
-extern double ran_u[];
+extern thread_local long ran_x[];
+extern thread_local long ran_arr_buf[];
+extern thread_local long * ran_arr_ptr;
+extern long ran_arr_dummy, ran_arr_started;
+extern thread_local double ran_u[];
+extern thread_local double ranf_arr_buf[];
+extern thread_local double * ranf_arr_ptr;
+extern double ranf_arr_dummy, ranf_arr_started;
 #define KK 100
+#define QUALITY 1009
 
 void SaveRandomState( std::vector<long> & save_x, std::vector<double> & save_u ) {
   save_x.assign(ran_x, ran_x + KK);
@@ -44,3 +51,42 @@ void RestoreRandomState( std::vector<long> const & save_x, std::vector<double> c
   assert(save_u.size() == KK);
   std::copy(save_u.begin(), save_u.end(), ran_u);
 }
+
+RandomState::RandomState( )
+  : x(KK), buf(QUALITY), u(KK), fbuf(QUALITY), pos(-1), fpos(-1)
+{
+}
+
+template<class T>
+static int _PointerToPos( T * ptr, T * buf, T * dummy, T * started ) {
+  if(ptr == dummy) {
+    return -1;
+  } else if(ptr == started) {
+    return -2;
+  }
+  return ptr - buf;
+}
+
+template<class T>
+static T * _PosToPointer( int pos, T * buf, T * dummy, T * started ) {
+  if(pos == -1) {
+    return dummy;
+  } else if(pos == -2) {
+    return started;
+  }
+  return buf + pos;
+}
+
+void SwapRandomState( RandomState & state ) {
+  std::swap_ranges(state.x.begin(), state.x.end(), ran_x);
+  std::swap_ranges(state.buf.begin(), state.buf.end(), ran_arr_buf);
+  int pos = _PointerToPos(ran_arr_ptr, ran_arr_buf, &ran_arr_dummy, &ran_arr_started);
+  ran_arr_ptr = _PosToPointer(state.pos, ran_arr_buf, &ran_arr_dummy, &ran_arr_started);
+  state.pos = pos;
+
+  std::swap_ranges(state.u.begin(), state.u.end(), ran_u);
+  std::swap_ranges(state.fbuf.begin(), state.fbuf.end(), ranf_arr_buf);
+  int fpos = _PointerToPos(ranf_arr_ptr, ranf_arr_buf, &ranf_arr_dummy, &ranf_arr_started);
+  ranf_arr_ptr = _PosToPointer(state.fpos, ranf_arr_buf, &ranf_arr_dummy, &ranf_arr_started);
+  state.fpos = fpos;
+}
@@ -66,4 +66,17 @@ void SaveRandomState( std::vector<long> & save_x, std::vector<double> & save_u )
 // Restores the generator state from previously saved values
 void RestoreRandomState( std::vector<long> const & save_x, std::vector<double> const & save_u );
 
+// Complete state of both generators, including their buffered output. The
+// generators are per thread; swapping a RandomState in and out gives an
+// embedded simulator instance a private stream (see global_state.hpp).
+struct RandomState {
+  std::vector<long> x, buf;
+  std::vector<double> u, fbuf;
+  int pos, fpos; // next buffered value, or -1 unseeded / -2 seeded
+
+  RandomState( );
+};
+
+void SwapRandomState( RandomState & state );
+
 #endif
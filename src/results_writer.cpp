@@ -0,0 +1,112 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
+#include "booksim.hpp"
+#include "results_writer.hpp"
+
+ResultsWriter::ResultsWriter( string const & filename )
+  : _filename(filename)
+{
+  _out.open(_filename.c_str(), ios::binary | ios::trunc);
+  if(!_out) {
+    cout << "Error: Unable to open results file " << _filename << endl;
+    exit(-1);
+  }
+  ResultsHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, "BSRESLT", 8);
+  h.version = VERSION;
+  _out.write((char const *)&h, sizeof(h));
+  _out.flush();
+  _header.rows = -1;
+}
+
+ResultsWriter::~ResultsWriter( )
+{
+  assert(_header.rows < 0);
+  _out.close();
+}
+
+void ResultsWriter::Begin( string const & name, int sim, int time,
+			   vector<string> const & columns )
+{
+  assert(_header.rows < 0);
+  assert(name.size() < sizeof(_header.name));
+  memset(&_header, 0, sizeof(_header));
+  strncpy(_header.name, name.c_str(), sizeof(_header.name) - 1);
+  _header.sim = sim;
+  _header.time = time;
+  _header.rows = 0;
+  _header.columns = columns.size();
+  _names = columns;
+  _columns.assign(columns.size(), vector<double>());
+}
+
+void ResultsWriter::Row( vector<double> const & values )
+{
+  assert(_header.rows >= 0);
+  assert(values.size() == _columns.size());
+  for(size_t i = 0; i < values.size(); ++i) {
+    _columns[i].push_back(values[i]);
+  }
+  ++_header.rows;
+}
+
+void ResultsWriter::End( )
+{
+  assert(_header.rows >= 0);
+
+  string names;
+  for(size_t i = 0; i < _names.size(); ++i) {
+    names += _names[i];
+    names += '\0';
+  }
+  names.resize((names.size() + 7) & ~(size_t)7, '\0');
+
+  _header.bytes = names.size() + 
+    (long long)_header.rows * _header.columns * sizeof(double);
+
+  _out.write((char const *)&_header, sizeof(_header));
+  _out.write(names.data(), names.size());
+  for(size_t i = 0; i < _columns.size(); ++i) {
+    if(!_columns[i].empty()) {
+      _out.write((char const *)&_columns[i][0], 
+		 _columns[i].size() * sizeof(double));
+    }
+  }
+  _out.flush();
+  if(!_out) {
+    cout << "Error: Unable to write results file " << _filename << endl;
+    exit(-1);
+  }
+  _header.rows = -1;
+}
@@ -0,0 +1,97 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _RESULTS_WRITER_HPP_
+#define _RESULTS_WRITER_HPP_
+
+// Columnar binary simulation results, enabled with results_out. Every
+// table is appended and flushed as soon as it is complete, so the tables
+// written before an aborted run remain readable; booksim_resultsdec (make
+// resultsdec) lists the tables and prints them as CSV.
+//
+// File layout: one ResultsHeader, then any number of tables. A table is a
+// ResultsTableHeader, the NUL-terminated column names padded with zeros to
+// a multiple of 8 bytes, and rows x columns doubles stored column by
+// column. ResultsTableHeader::bytes covers the names and the values, so
+// readers can skip tables they do not know. Tables written by the traffic
+// manager:
+//
+//   sample     per class, after every sample period
+//   overall    per class, after all simulations
+//   *_hist     latency, fragmentation and hop count histograms, per
+//              simulation (class, bin, count)
+//   pair       per class, source and destination, per simulation
+//              (pair_stats = 1)
+//   channel    per link utilization, per simulation (track_chan_utils = 1)
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+struct ResultsHeader {
+  char magic[8];      // "BSRESLT\0"
+  int version;
+  int reserved;
+};
+
+struct ResultsTableHeader {
+  char name[16];      // NUL-terminated table name
+  int sim;            // simulation the table belongs to
+  int time;           // cycle in which it was written
+  int rows;
+  int columns;
+  long long bytes;    // size of the names and values that follow
+};
+
+class ResultsWriter {
+
+public:
+
+  static const int VERSION = 1;
+
+  ResultsWriter( std::string const & filename );
+  ~ResultsWriter( );
+
+  // Tables are built one row at a time between Begin() and End(), and are
+  // written out by End().
+  void Begin( std::string const & name, int sim, int time,
+	      std::vector<std::string> const & columns );
+  void Row( std::vector<double> const & values );
+  void End( );
+
+private:
+
+  std::string _filename;
+  std::ofstream _out;
+
+  ResultsTableHeader _header;
+  std::vector<std::string> _names;
+  std::vector<std::vector<double> > _columns;
+
+};
+
+#endif
@@ -0,0 +1,111 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _RINGFIFO_HPP_
+#define _RINGFIFO_HPP_
+
+#include <vector>
+#include <cassert>
+
+// FIFO on a power-of-two ring buffer. Unlike deque, popping and pushing in
+// steady state never touches the heap; the buffer only grows (doubling) when
+// more entries are outstanding than ever before.
+template<class T> class RingFIFO {
+  std::vector<T> _data;
+  unsigned int _mask;
+  unsigned int _head;
+  unsigned int _size;
+
+  void _Grow( );
+
+public:
+  class iterator {
+    RingFIFO<T> * _q;
+    unsigned int _pos;
+  public:
+    iterator( RingFIFO<T> * q, unsigned int pos ) : _q(q), _pos(pos) {}
+    T & operator*( ) const { return _q->_data[(_q->_head + _pos) & _q->_mask]; }
+    T * operator->( ) const { return &**this; }
+    iterator & operator++( ) { ++_pos; return *this; }
+    bool operator==( iterator const & i ) const { return _pos == i._pos; }
+    bool operator!=( iterator const & i ) const { return _pos != i._pos; }
+  };
+  friend class iterator;
+
+  RingFIFO( unsigned int capacity = 16 );
+
+  bool empty( ) const { return _size == 0; }
+  unsigned int size( ) const { return _size; }
+
+  T & front( ) { assert(_size > 0); return _data[_head]; }
+  void push_back( T const & val );
+  void pop_front( );
+
+  iterator begin( ) { return iterator(this, 0); }
+  iterator end( ) { return iterator(this, _size); }
+};
+
+template<class T> RingFIFO<T>::RingFIFO( unsigned int capacity )
+  : _head(0), _size(0)
+{
+  unsigned int c = 1;
+  while(c < capacity) {
+    c <<= 1;
+  }
+  _data.resize(c);
+  _mask = c - 1;
+}
+
+template<class T> void RingFIFO<T>::_Grow( )
+{
+  unsigned int const c = _data.size();
+  std::vector<T> data(2 * c);
+  for(unsigned int i = 0; i < _size; ++i) {
+    data[i] = _data[(_head + i) & _mask];
+  }
+  _data.swap(data);
+  _mask = 2 * c - 1;
+  _head = 0;
+}
+
+template<class T> void RingFIFO<T>::push_back( T const & val )
+{
+  if(_size == _data.size()) {
+    _Grow();
+  }
+  _data[(_head + _size) & _mask] = val;
+  ++_size;
+}
+
+template<class T> void RingFIFO<T>::pop_front( )
+{
+  assert(_size > 0);
+  _head = (_head + 1) & _mask;
+  --_size;
+}
+
+#endif
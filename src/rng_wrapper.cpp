@@ -25,6 +25,8 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+// generator state is per thread, see random_utils.hpp
+#define RNG_STATE thread_local
 #define main rng_main
 #include "rng.c"
 
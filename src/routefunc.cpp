@@ -59,11 +59,11 @@
 
 
 
-map<string, tRoutingFunction> gRoutingFunctionMap;
+thread_local map<string, tRoutingFunction> gRoutingFunctionMap;
 
 /* Global information used by routing functions */
 
-int gNumVCs;
+thread_local int gNumVCs;
 
 /* Add more functions here
  *
@@ -71,10 +71,13 @@ int gNumVCs;
 
 // ============================================================
 //  Balfour-Schultz
-int gReadReqBeginVC, gReadReqEndVC;
-int gWriteReqBeginVC, gWriteReqEndVC;
-int gReadReplyBeginVC, gReadReplyEndVC;
-int gWriteReplyBeginVC, gWriteReplyEndVC;
+thread_local int gReadReqBeginVC, gReadReqEndVC;
+thread_local int gWriteReqBeginVC, gWriteReqEndVC;
+thread_local int gReadReplyBeginVC, gReadReplyEndVC;
+thread_local int gWriteReplyBeginVC, gWriteReplyEndVC;
+
+// Flowlet switching: minimum idle gap (cycles) before re-picking a port
+thread_local int gFlowletGap;
 
 // ============================================================
 //  QTree: Nearest Common Ancestor
@@ -1620,6 +1623,108 @@ void fattree_nca_portlimit( const Router *r, const Flit *f,
 
 
 
+// Flowlet switching: packets of a (src, dest, type) flow keep their up-port
+// while they arrive back to back, and only re-pick the least loaded up-port
+// (by used credits) once the flow has been idle for more than flowlet_gap
+// cycles. The gap lets earlier packets drain, so the switch does not cause
+// reordering at the destination. Flows that hash to the same table entry
+// share it: the port is only re-picked once the entry itself has been idle
+// for the gap, so a colliding flow never moves a live one mid-burst.
+void fattree_nca_flowlet( const Router *r, const Flit *f,
+                int in_channel, OutputSet* outputs, bool inject)
+{
+
+  int vcBegin = 0, vcEnd = gNumVCs-1;
+  if ( f->type == Flit::READ_REQUEST ) {
+    vcBegin = gReadReqBeginVC;
+    vcEnd = gReadReqEndVC;
+  } else if ( f->type == Flit::WRITE_REQUEST ) {
+    vcBegin = gWriteReqBeginVC;
+    vcEnd = gWriteReqEndVC;
+  } else if ( f->type ==  Flit::READ_REPLY ) {
+    vcBegin = gReadReplyBeginVC;
+    vcEnd = gReadReplyEndVC;
+  } else if ( f->type ==  Flit::WRITE_REPLY ) {
+    vcBegin = gWriteReplyBeginVC;
+    vcEnd = gWriteReplyEndVC;
+  }
+  assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
+
+
+  int out_port;
+
+  if(inject) {
+
+    out_port = -1;
+
+  } else {
+
+
+    int dest = f->dest;
+    int router_id = r->GetID(); //routers are numbered with smallest at the top level
+    int routers_per_level = powi(gK, gN-1);
+    int pos = router_id%routers_per_level;
+    int router_depth  = router_id/ routers_per_level; //which level
+    int routers_per_neighborhood = powi(gK,gN-router_depth-1);
+    int router_neighborhood = pos/routers_per_neighborhood; //coverage of this tree
+    int router_coverage = powi(gK, gN-router_depth);  //span of the tree from this router
+    
+
+    //NCA reached going down
+    if(dest <(router_neighborhood+1)* router_coverage && 
+       dest >=router_neighborhood* router_coverage){
+      //down ports are numbered first
+
+      //ejection
+      if(router_depth == gN-1){
+        out_port = dest%gK;
+      } else {	
+        //find the down port for the destination
+        int router_branch_coverage = powi(gK, gN-(router_depth+1)); 
+        out_port = (dest-router_neighborhood* router_coverage)/router_branch_coverage;
+      }
+    } else {
+      //up ports are numbered last
+      assert(in_channel < gK); //came from a up channel
+
+      // key 0 marks an empty entry
+      unsigned long key = ((unsigned long)f->src * gNodes + f->dest) * Flit::NUM_FLIT_TYPES + f->type + 1;
+      // murmur2 mix before indexing the table
+      unsigned long mix = key;
+      mix ^= mix >> 13;
+      mix *= 0x5bd1e995;
+      mix ^= mix >> 15;
+      assert(!r->flowlet_key.empty()); // table is only set up by the iq router
+      int entry = mix % r->flowlet_key.size();
+
+      int now = GetSimTime();
+      int up_port = r->flowlet_port[entry];
+      if ((r->flowlet_key[entry] == 0) || (now - r->flowlet_time[entry] > gFlowletGap)) {
+        // new flowlet: least used credits, ties broken from a random start
+        int start = RandomInt(gK-1);
+        int min_credit = -1;
+        for (int i = 0; i < gK; i++) {
+          int port = (start + i) % gK;
+          int credit = r->GetUsedCredit(gK + port);
+          if ((min_credit < 0) || (credit < min_credit)) {
+            min_credit = credit;
+            up_port = port;
+          }
+        }
+        r->flowlet_key[entry] = key;
+        r->flowlet_port[entry] = up_port;
+      }
+      r->flowlet_time[entry] = now;
+
+      out_port = gK + up_port;
+    }
+  }  
+  outputs->Clear( );
+  
+  outputs->AddRange( out_port, vcBegin, vcEnd );
+}
+
+
 // ============================================================
 //  Mesh - adatpive XY,YX Routing 
 //         pick xy or yx min routing adaptively at the source router
@@ -3181,6 +3286,8 @@ void InitializeRoutingMap( const Configuration & config )
     gWriteReplyEndVC = gNumVCs - 1;
   }
 
+  gFlowletGap = config.GetInt("flowlet_gap");
+
   /* Register routing functions here */
 
   // ===================================================
@@ -3218,6 +3325,7 @@ void InitializeRoutingMap( const Configuration & config )
   gRoutingFunctionMap["nca_fibonacci_fattree"]            = &fattree_nca_fibonacci;
   gRoutingFunctionMap["nca_murmurhash3_fattree"]          = &fattree_nca_murmurhash3;
   gRoutingFunctionMap["nca_crc_fattree"]                  = &fattree_nca_crc;
+  gRoutingFunctionMap["nca_flowlet_fattree"]              = &fattree_nca_flowlet;
   // End Tho
   // ===================================================
 
@@ -33,6 +33,7 @@
 
 #include "chaos_router.hpp"
 #include "random_utils.hpp"
+#include "profiler.hpp"
 #include "globals.hpp"
 
 ChaosRouter::ChaosRouter( const Configuration& config,
@@ -128,6 +129,7 @@ ChaosRouter::~ChaosRouter( )
   
 void ChaosRouter::ReadInputs( )
 {
+  PROFILE_SCOPE("ChaosRouter::ReadInputs");
   Flit   *f;
   Credit *c;
 
@@ -226,6 +228,7 @@ void ChaosRouter::ReadInputs( )
 
 void ChaosRouter::_InternalStep( )
 {
+  PROFILE_SCOPE("ChaosRouter::_InternalStep");
   _NextInterestingChannel( );
   _OutputAdvance( );
 
@@ -234,6 +237,7 @@ void ChaosRouter::_InternalStep( )
 
 void ChaosRouter::WriteOutputs( )
 {
+  PROFILE_SCOPE("ChaosRouter::WriteOutputs");
   _SendFlits( );
   _SendCredits( );
 }
@@ -120,10 +120,8 @@ public:
   virtual int GetUsedCreditVC(int o, int v) const {return 0;}
   virtual int GetInjectedPacket(int o) const {return 0;}
 
-#ifdef TRACK_BUFFERS
   virtual int GetUsedCreditForClass(int output, int cl) const {return 0;}
   virtual int GetBufferOccupancyForClass(int input, int cl) const {return 0;}
-#endif
 
   virtual vector<int> UsedCredits() const { return vector<int>(); }
   virtual vector<int> FreeCredits() const { return vector<int>(); }
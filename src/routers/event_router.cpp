@@ -34,6 +34,7 @@
 #include "event_router.hpp"
 #include "stats.hpp"
 #include "globals.hpp"
+#include "profiler.hpp"
 
 EventRouter::EventRouter( const Configuration& config,
 		    Module *parent, const string & name, int id,
@@ -160,12 +161,14 @@ EventRouter::~EventRouter( )
   
 void EventRouter::ReadInputs( )
 {
+  PROFILE_SCOPE("EventRouter::ReadInputs");
   _ReceiveFlits( );
   _ReceiveCredits( );
 }
 
 void EventRouter::_InternalStep( )
 {
+  PROFILE_SCOPE("EventRouter::_InternalStep");
   // Receive incoming flits
   _IncomingFlits( );
 
@@ -214,6 +217,7 @@ void EventRouter::_InternalStep( )
 
 void EventRouter::WriteOutputs( )
 {
+  PROFILE_SCOPE("EventRouter::WriteOutputs");
   _SendFlits( );
   _SendCredits( );
 }
@@ -35,6 +35,7 @@
 #include <cassert>
 #include <limits>
 #include <numeric>
+#include <algorithm>
 
 #include "globals.hpp"
 #include "random_utils.hpp"
@@ -47,6 +48,8 @@
 #include "allocator.hpp"
 #include "switch_monitor.hpp"
 #include "buffer_monitor.hpp"
+#include "profiler.hpp"
+#include "event_trace.hpp"
 
 IQRouter::IQRouter( Configuration const & config, Module *parent, 
 		    string const & name, int id, int inputs, int outputs )
@@ -163,42 +166,47 @@ IQRouter::IQRouter( Configuration const & config, Module *parent,
   _output_buffer.resize(_outputs); 
   _credit_buffer.resize(_inputs); 
 
+  // Per-cycle staging; sized up front so steady-state cycles do not allocate
+  _in_queue_flits.reserve(_inputs);
+  _out_queue_credits.resize(_inputs, NULL);
+  _out_queue_inputs.reserve(_inputs);
+
   // Switch configuration (when held for multiple cycles)
   _hold_switch_for_packet = (config.GetInt("hold_switch_for_packet") > 0);
   _switch_hold_in.resize(_inputs*_input_speedup, -1);
   _switch_hold_out.resize(_outputs*_output_speedup, -1);
   _switch_hold_vc.resize(_inputs*_input_speedup, -1);
 
+  // Pick a pipeline specialized for the configured options; anything not
+  // covered here falls back to checking the options at run time.
+  _step = &IQRouter::_Step<_RuntimePipe>;
+  if (config.GetInt("iq_specialize") > 0 && !_noq && !_vc_prioritize_empty &&
+      (_output_buffer_size == -1)) {
+    if (!_speculative && !_hold_switch_for_packet) {
+      _step = &IQRouter::_Step<_FixedPipe<false, false, false, false, true> >;
+    } else if (_speculative && !_hold_switch_for_packet &&
+               _spec_check_elig && _spec_check_cred && !_spec_mask_by_reqs) {
+      _step = &IQRouter::_Step<_FixedPipe<true, false, false, false, true> >;
+    } else if (!_speculative && _hold_switch_for_packet) {
+      _step = &IQRouter::_Step<_FixedPipe<false, true, false, false, true> >;
+    }
+  }
+
   _bufferMonitor = new BufferMonitor(inputs, _classes);
   _switchMonitor = new SwitchMonitor(inputs, outputs, _classes);
 
-#ifdef TRACK_FLOWS
-  for(int c = 0; c < _classes; ++c) {
-    _stored_flits[c].resize(_inputs, 0);
-    _active_packets[c].resize(_inputs, 0);
+  if(gTrackFlows) {
+    for(int c = 0; c < _classes; ++c) {
+      _stored_flits[c].resize(_inputs, 0);
+      _active_packets[c].resize(_inputs, 0);
+    }
+    _outstanding_classes.resize(_outputs, vector<queue<int> >(_vcs));
   }
-  _outstanding_classes.resize(_outputs, vector<queue<int> >(_vcs));
-#endif
-
-
-#ifdef CHAN_UTILS
-  _util_vect.resize(_outputs);
-#endif
 
   _injected_packets_vect.resize(gK, 0);
   
 
-  spread_pid.resize(gK, 0);
-  switch_flag.resize(gK, false);
-
-
-  flit_count.resize(_outputs, 0);
-  latest_port.resize(gK, 0);
-  for (int i = 0; i < gK; i++) {
-    latest_port[i] = i;
-  }
-
-  GenerateCyclic(gK, pattern_init);
+  _InitRoutingState(config);
 
 }
 
@@ -240,19 +248,26 @@ void IQRouter::AddOutputChannel(FlitChannel * channel, CreditChannel * backchann
 
 void IQRouter::ReadInputs( )
 {
+  PROFILE_SCOPE("IQRouter::ReadInputs");
   bool have_flits = _ReceiveFlits( );
   bool have_credits = _ReceiveCredits( );
   _active = _active || have_flits || have_credits;
 }
 
 void IQRouter::_InternalStep( )
+{
+  PROFILE_SCOPE("IQRouter::_InternalStep");
+  (this->*_step)( );
+}
+
+template<class P> void IQRouter::_Step( )
 #ifdef SINGLE_CYCLE
 {
   if (!_active) {
     return;
   }
 
-  _InputQueuing( );
+  _InputQueuing<P>( );
 
   bool activity = !_proc_credits.empty();
 
@@ -261,31 +276,31 @@ void IQRouter::_InternalStep( )
   }
 
   if (!_route_vcs.empty()) {
-    _RouteUpdate( );
+    _RouteUpdate<P>( );
     activity = activity || !_route_vcs.empty();
   }
 
   if (_vc_allocator) {
     _vc_allocator->Clear();
     if (!_vc_alloc_vcs.empty()){
-      _VCAllocEvaluate( );
+      _VCAllocEvaluate<P>( );
     }
   }
 
   if (!_vc_alloc_vcs.empty()) {
-    _VCAllocUpdate( );
+    _VCAllocUpdate<P>( );
     activity = activity || !_vc_alloc_vcs.empty();
   }
 
-  if (_hold_switch_for_packet) {
+  if (P::hold_switch_for_packet(this)) {
     if (!_sw_hold_vcs.empty()){
       _SWHoldEvaluate( );
     }
   }
 
-  if (_hold_switch_for_packet) {
+  if (P::hold_switch_for_packet(this)) {
     if (!_sw_hold_vcs.empty()) {
-      _SWHoldUpdate( );
+      _SWHoldUpdate<P>( );
       activity = activity || !_sw_hold_vcs.empty();
     }
   }
@@ -296,11 +311,11 @@ void IQRouter::_InternalStep( )
 
 
   if (!_sw_alloc_vcs.empty()){
-    _SWAllocEvaluate( );
+    _SWAllocEvaluate<P>( );
   }
 
   if (!_sw_alloc_vcs.empty()) {
-    _SWAllocUpdate( );
+    _SWAllocUpdate<P>( );
     activity = activity || !_sw_alloc_vcs.empty();
   }
 
@@ -326,7 +341,7 @@ void IQRouter::_InternalStep( )
     return;
   }
 
-  _InputQueuing( );
+  _InputQueuing<P>( );
   bool activity = !_proc_credits.empty();
 
   if (!_route_vcs.empty())
@@ -334,9 +349,9 @@ void IQRouter::_InternalStep( )
   if (_vc_allocator) {
     _vc_allocator->Clear();
     if (!_vc_alloc_vcs.empty())
-      _VCAllocEvaluate( );
+      _VCAllocEvaluate<P>( );
   }
-  if (_hold_switch_for_packet) {
+  if (P::hold_switch_for_packet(this)) {
     if (!_sw_hold_vcs.empty())
       _SWHoldEvaluate( );
   }
@@ -344,26 +359,26 @@ void IQRouter::_InternalStep( )
   if (_spec_sw_allocator)
     _spec_sw_allocator->Clear();
   if (!_sw_alloc_vcs.empty())
-    _SWAllocEvaluate( );
+    _SWAllocEvaluate<P>( );
   if (!_crossbar_flits.empty())
     _SwitchEvaluate( );
 
   if (!_route_vcs.empty()) {
-    _RouteUpdate( );
+    _RouteUpdate<P>( );
     activity = activity || !_route_vcs.empty();
   }
   if (!_vc_alloc_vcs.empty()) {
-    _VCAllocUpdate( );
+    _VCAllocUpdate<P>( );
     activity = activity || !_vc_alloc_vcs.empty();
   }
-  if (_hold_switch_for_packet) {
+  if (P::hold_switch_for_packet(this)) {
     if (!_sw_hold_vcs.empty()) {
-      _SWHoldUpdate( );
+      _SWHoldUpdate<P>( );
       activity = activity || !_sw_hold_vcs.empty();
     }
   }
   if (!_sw_alloc_vcs.empty()) {
-    _SWAllocUpdate( );
+    _SWAllocUpdate<P>( );
     activity = activity || !_sw_alloc_vcs.empty();
   }
   if (!_crossbar_flits.empty()) {
@@ -382,6 +397,7 @@ void IQRouter::_InternalStep( )
 
 void IQRouter::WriteOutputs( )
 {
+  PROFILE_SCOPE("IQRouter::WriteOutputs");
   _SendFlits( );
   _SendCredits( );
 }
@@ -398,9 +414,9 @@ bool IQRouter::_ReceiveFlits( )
     Flit * const f = _input_channels[input]->Receive();
     if (f) {
 
-#ifdef TRACK_FLOWS
-      ++_received_flits[f->cl][input];
-#endif
+      if(gTrackFlows) {
+        ++_received_flits[f->cl][input];
+      }
 
       if (f->watch) {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -408,7 +424,10 @@ bool IQRouter::_ReceiveFlits( )
                    << " from channel at input " << input
                    << "." << endl;
       }
-      _in_queue_flits.insert(make_pair(input, f));
+      if (gEventTrace) {
+        gEventTrace->Record(EventTrace::HOP, f, GetID(), input);
+      }
+      _in_queue_flits.push_back(make_pair(input, f));
       activity = true;
     }
   }
@@ -433,9 +452,10 @@ bool IQRouter::_ReceiveCredits( )
 // input queuing
 //------------------------------------------------------------------------------
 
-void IQRouter::_InputQueuing( )
+template<class P> void IQRouter::_InputQueuing( )
 {
-  for(map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();
+  PROFILE_SCOPE("IQRouter::_InputQueuing");
+  for(vector<pair<int, Flit *> >::const_iterator iter = _in_queue_flits.begin();
       iter != _in_queue_flits.end();
       ++iter) {
 
@@ -465,18 +485,18 @@ void IQRouter::_InputQueuing( )
       *gWatchOut << ")." << endl;
     }
 
-#ifdef WAIT_TIME
-    if (f->head){
-      f->in_time = GetSimTime();
+    if(gTrackWaitTime) {
+      if (f->head){
+        f->Timing().in_time = GetSimTime();
+      }
     }
-#endif
     
     cur_buf->AddFlit(vc, f);
 
-#ifdef TRACK_FLOWS
-    ++_stored_flits[f->cl][input];
-    if (f->head) ++_active_packets[f->cl][input];
-#endif
+    if(gTrackFlows) {
+      ++_stored_flits[f->cl][input];
+      if (f->head) ++_active_packets[f->cl][input];
+    }
 
     _bufferMonitor->write(input, f) ;
 
@@ -489,9 +509,9 @@ void IQRouter::_InputQueuing( )
 	      cur_buf->SetState(vc, VC::routing);
 	      _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
 
-#ifdef WAIT_TIME
-        f->rc_time = GetSimTime();
-#endif
+        if(gTrackWaitTime) {
+          f->Timing().rc_time = GetSimTime();
+        }
       } else {
         if (f->watch) {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -502,13 +522,13 @@ void IQRouter::_InputQueuing( )
         }
         cur_buf->SetRouteSet(vc, &f->la_route_set);
         cur_buf->SetState(vc, VC::vc_alloc);
-        if (_speculative) {
+        if (P::speculative(this)) {
           _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc), -1)));
         }
         if (_vc_allocator) {
           _vc_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc), -1)));
         }
-        if (_noq) {
+        if (P::noq(this)) {
           _UpdateNOQ(input, vc, f);
         }
       }
@@ -540,16 +560,16 @@ void IQRouter::_InputQueuing( )
     
     BufferState * const dest_buf = _next_buf[output];
     
-#ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
-      int const vc = *iter;
-      assert(!_outstanding_classes[output][vc].empty());
-      int cl = _outstanding_classes[output][vc].front();
-      _outstanding_classes[output][vc].pop();
-      assert(_outstanding_credits[cl][output] > 0);
-      --_outstanding_credits[cl][output];
+    if(gTrackFlows) {
+      for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+        int const vc = *iter;
+        assert(!_outstanding_classes[output][vc].empty());
+        int cl = _outstanding_classes[output][vc].front();
+        _outstanding_classes[output][vc].pop();
+        assert(_outstanding_credits[cl][output] > 0);
+        --_outstanding_credits[cl][output];
+      }
     }
-#endif
 
     dest_buf->ProcessCredit(c);
     c->Free();
@@ -564,9 +584,10 @@ void IQRouter::_InputQueuing( )
 
 void IQRouter::_RouteEvaluate( )
 {
+  PROFILE_SCOPE("IQRouter::_RouteEvaluate");
   assert(_routing_delay);
 
-  for(deque<pair<int, pair<int, int> > >::iterator iter = _route_vcs.begin();
+  for(RingFIFO<pair<int, pair<int, int> > >::iterator iter = _route_vcs.begin();
       iter != _route_vcs.end();
       ++iter) {
     
@@ -590,13 +611,13 @@ void IQRouter::_RouteEvaluate( )
     assert(f->vc == vc);
     assert(f->head);
 
-#ifdef WAIT_TIME
-    // f->rc_time = GetSimTime();
+    if(gTrackWaitTime) {
+      // f->Timing().rc_time = GetSimTime();
 
-    if (((f->dest / gC) + gK)== this->GetID()){
-      f->ewtime = GetSimTime();
+      if (((f->dest / gC) + gK)== this->GetID()){
+        f->Timing().ewtime = GetSimTime();
+      }
     }
-#endif
 
     if (f->watch) {
       *gWatchOut  << GetSimTime() << " | " << FullName() << " | "
@@ -608,8 +629,9 @@ void IQRouter::_RouteEvaluate( )
   }    
 }
 
-void IQRouter::_RouteUpdate( )
+template<class P> void IQRouter::_RouteUpdate( )
 {
+  PROFILE_SCOPE("IQRouter::_RouteUpdate");
   assert(_routing_delay);
 
   inc_hash = 0;
@@ -653,7 +675,7 @@ void IQRouter::_RouteUpdate( )
 
     cur_buf->Route(vc, _rf, this, f, input);
     cur_buf->SetState(vc, VC::vc_alloc);
-    if (_speculative) {
+    if (P::speculative(this)) {
       _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
     }
     if (_vc_allocator) {
@@ -668,13 +690,7 @@ void IQRouter::_RouteUpdate( )
     }
 
   }
-  offset += inc_hash;
-
-  if ((offset / gK) != packet_cnt_check) {
-    random_offset = random_offset + (GetSimTime() % gK);
-    random_src_offset = GetSimTime() % gK;
-  }
-  packet_cnt_check = offset / gK;
+  _UpdateRouteOffsets();
 
 
   // for(int i = 0; i < committed_packet.size(); i++)
@@ -690,13 +706,14 @@ void IQRouter::_RouteUpdate( )
 // VC allocation
 //------------------------------------------------------------------------------
 
-void IQRouter::_VCAllocEvaluate( )
+template<class P> void IQRouter::_VCAllocEvaluate( )
 {
+  PROFILE_SCOPE("IQRouter::_VCAllocEvaluate");
   assert(_vc_allocator);
 
   bool watched = false;
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
+  for(RingFIFO<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
       iter != _vc_alloc_vcs.end();
       ++iter) {
 
@@ -739,7 +756,7 @@ void IQRouter::_VCAllocEvaluate( )
     bool cred = false;
     bool reserved = false;
 
-    assert(!_noq || (setlist.size() == 1));
+    assert(!P::noq(this) || (setlist.size() == 1));
 
     for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
         iset != setlist.end();
@@ -753,7 +770,7 @@ void IQRouter::_VCAllocEvaluate( )
       int vc_start;
       int vc_end;
       
-      if (_noq && _noq_next_output_port[input][vc] >= 0) {
+      if (P::noq(this) && _noq_next_output_port[input][vc] >= 0) {
         assert(!_routing_delay);
         vc_start = _noq_next_vc_start[input][vc];
         vc_end = _noq_next_vc_end[input][vc];
@@ -769,7 +786,7 @@ void IQRouter::_VCAllocEvaluate( )
         assert((out_vc >= 0) && (out_vc < _vcs));
 
         int in_priority = iset->pri;
-        if (_vc_prioritize_empty && !dest_buf->IsEmptyFor(out_vc)) {
+        if (P::vc_prioritize_empty(this) && !dest_buf->IsEmptyFor(out_vc)) {
           assert(in_priority >= 0);
           in_priority += numeric_limits<int>::min();
         }
@@ -847,7 +864,7 @@ void IQRouter::_VCAllocEvaluate( )
     _vc_allocator->PrintGrants( gWatchOut );
   }
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
+  for(RingFIFO<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
       iter != _vc_alloc_vcs.end();
       ++iter) {
 
@@ -917,7 +934,7 @@ void IQRouter::_VCAllocEvaluate( )
     return;
   }
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
+  for(RingFIFO<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
       iter != _vc_alloc_vcs.end();
       ++iter) {
     
@@ -979,8 +996,9 @@ void IQRouter::_VCAllocEvaluate( )
   }
 }
 
-void IQRouter::_VCAllocUpdate( )
+template<class P> void IQRouter::_VCAllocUpdate( )
 {
+  PROFILE_SCOPE("IQRouter::_VCAllocUpdate");
   assert(_vc_allocator);
 
   while(!_vc_alloc_vcs.empty()) {
@@ -1037,10 +1055,14 @@ void IQRouter::_VCAllocUpdate( )
       assert(dest_buf->IsAvailableFor(match_vc));
       
       dest_buf->TakeBuffer(match_vc, input*_vcs + vc);
+
+      if (gEventTrace) {
+        gEventTrace->Record(EventTrace::VC_ALLOC, f, GetID(), input, match_output, match_vc);
+      }
 	
       cur_buf->SetOutput(vc, match_output, match_vc);
       cur_buf->SetState(vc, VC::active);
-      if (!_speculative) {
+      if (!P::speculative(this)) {
         _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
       }
 
@@ -1050,15 +1072,15 @@ void IQRouter::_VCAllocUpdate( )
                    << "  No output VC allocated." << endl;
       }
 
-#ifdef TRACK_STALLS
-      assert((output_and_vc == STALL_BUFFER_BUSY) ||
-	     (output_and_vc == STALL_BUFFER_CONFLICT));
-      if (output_and_vc == STALL_BUFFER_BUSY) {
-	++_buffer_busy_stalls[f->cl];
-      } else if (output_and_vc == STALL_BUFFER_CONFLICT) {
-	++_buffer_conflict_stalls[f->cl];
+      if(gTrackStalls) {
+        assert((output_and_vc == STALL_BUFFER_BUSY) ||
+	       (output_and_vc == STALL_BUFFER_CONFLICT));
+        if (output_and_vc == STALL_BUFFER_BUSY) {
+	  ++_buffer_busy_stalls[f->cl];
+        } else if (output_and_vc == STALL_BUFFER_CONFLICT) {
+	  ++_buffer_conflict_stalls[f->cl];
+        }
       }
-#endif
 
       _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
     }
@@ -1073,9 +1095,10 @@ void IQRouter::_VCAllocUpdate( )
 
 void IQRouter::_SWHoldEvaluate( )
 {
+  PROFILE_SCOPE("IQRouter::_SWHoldEvaluate");
   assert(_hold_switch_for_packet);
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_hold_vcs.begin();
+  for(RingFIFO<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_hold_vcs.begin();
       iter != _sw_hold_vcs.end();
       ++iter) {
     
@@ -1145,9 +1168,10 @@ void IQRouter::_SWHoldEvaluate( )
   }
 }
 
-void IQRouter::_SWHoldUpdate( )
+template<class P> void IQRouter::_SWHoldUpdate( )
 {
-  assert(_hold_switch_for_packet);
+  PROFILE_SCOPE("IQRouter::_SWHoldUpdate");
+  assert(P::hold_switch_for_packet(this));
 
   while(!_sw_hold_vcs.empty()) {
     
@@ -1187,7 +1211,7 @@ void IQRouter::_SWHoldUpdate( )
     
     int const expanded_output = item.second.second;
     
-    if (expanded_output >= 0 && ( _output_buffer_size==-1 || _output_buffer[expanded_output/_output_speedup].size()<size_t(_output_buffer_size))) {
+    if (expanded_output >= 0 && ( P::unbounded_output_buffer(this) || _output_buffer[expanded_output/_output_speedup].size()<size_t(_output_buffer_size))) {
       
       assert(_switch_hold_in[expanded_input] == expanded_output);
       assert(_switch_hold_out[expanded_output] == expanded_input);
@@ -1209,13 +1233,17 @@ void IQRouter::_SWHoldUpdate( )
                     << "." << (expanded_output % _output_speedup)
                     << "." << endl;
       }
+
+      if (gEventTrace) {
+        gEventTrace->Record(EventTrace::SW_GRANT, f, GetID(), input, output, match_vc);
+      }
       
       cur_buf->RemoveFlit(vc);
 
-#ifdef TRACK_FLOWS
-      --_stored_flits[f->cl][input];
-      if (f->tail) --_active_packets[f->cl][input];
-#endif
+      if(gTrackFlows) {
+        --_stored_flits[f->cl][input];
+        if (f->tail) --_active_packets[f->cl][input];
+      }
 
       _bufferMonitor->read(input, f) ;
       
@@ -1226,7 +1254,7 @@ void IQRouter::_SWHoldUpdate( )
         const FlitChannel * channel = _output_channels[output];
         const Router * router = channel->GetSink();
         if (router) {
-          if (_noq) {
+          if (P::noq(this)) {
             if (f->watch) {
               *gWatchOut  << GetSimTime() << " | " << FullName() << " | "
                           << "Updating lookahead routing information for flit " << f->id
@@ -1260,19 +1288,20 @@ void IQRouter::_SWHoldUpdate( )
         }
       }
 
-#ifdef TRACK_FLOWS
-      ++_outstanding_credits[f->cl][output];
-      _outstanding_classes[output][f->vc].push(f->cl);
-#endif
+      if(gTrackFlows) {
+        ++_outstanding_credits[f->cl][output];
+        _outstanding_classes[output][f->vc].push(f->cl);
+      }
 
       dest_buf->SendingFlit(f);
 
       _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
       
-      if (_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if (!_out_queue_credits[input]) {
+        _out_queue_credits[input] = Credit::New();
+        _out_queue_inputs.push_back(input);
       }
-      _out_queue_credits.find(input)->second->vc.insert(vc);
+      _out_queue_credits[input]->vc.insert(vc);
       
       if (cur_buf->Empty(vc)) {
         if (f->watch) {
@@ -1321,13 +1350,13 @@ void IQRouter::_SWHoldUpdate( )
             }
             cur_buf->SetRouteSet(vc, &nf->la_route_set);
             cur_buf->SetState(vc, VC::vc_alloc);
-            if (_speculative) {
+            if (P::speculative(this)) {
               _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
             }
             if (_vc_allocator) {
               _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
             }
-            if (_noq) {
+            if (P::noq(this)) {
               _UpdateNOQ(input, vc, nf);
             }
           }
@@ -1338,7 +1367,7 @@ void IQRouter::_SWHoldUpdate( )
     } else {
       //when internal speedup >1.0, the buffer stall stats may not be accruate
       assert((expanded_output == STALL_BUFFER_FULL) ||
-	     (expanded_output == STALL_BUFFER_RESERVED) || !( _output_buffer_size==-1 || _output_buffer[expanded_output/_output_speedup].size()<size_t(_output_buffer_size)));
+	     (expanded_output == STALL_BUFFER_RESERVED) || !( P::unbounded_output_buffer(this) || _output_buffer[expanded_output/_output_speedup].size()<size_t(_output_buffer_size)));
 
       int const held_expanded_output = _switch_hold_in[expanded_input];
       assert(held_expanded_output >= 0);
@@ -1365,7 +1394,7 @@ void IQRouter::_SWHoldUpdate( )
 // switch allocation
 //------------------------------------------------------------------------------
 
-bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
+template<class P> bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
 {
   assert(input >= 0 && input < _inputs);
   assert(vc >= 0 && vc < _vcs);
@@ -1381,7 +1410,7 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
   Buffer const * const cur_buf = _buf[input];
   assert(!cur_buf->Empty(vc));
   assert((cur_buf->GetState(vc) == VC::active) || 
-	 (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	 (P::speculative(this) && (cur_buf->GetState(vc) == VC::vc_alloc)));
   
   Flit const * const f = cur_buf->FrontFlit(vc);
   assert(f);
@@ -1393,7 +1422,7 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
     Allocator * allocator = _sw_allocator;
     int prio = cur_buf->GetPriority(vc);
     
-    if (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)) {
+    if (P::speculative(this) && (cur_buf->GetState(vc) == VC::vc_alloc)) {
       if (_spec_sw_allocator) {
         allocator = _spec_sw_allocator;
       } else {
@@ -1467,11 +1496,12 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
   return false;
 }
 
-void IQRouter::_SWAllocEvaluate( )
+template<class P> void IQRouter::_SWAllocEvaluate( )
 {
+  PROFILE_SCOPE("IQRouter::_SWAllocEvaluate");
   bool watched = false;
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
+  for(RingFIFO<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
       iter != _sw_alloc_vcs.end();
       ++iter) {
 
@@ -1492,7 +1522,7 @@ void IQRouter::_SWAllocEvaluate( )
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
     assert((cur_buf->GetState(vc) == VC::active) || 
-	   (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	   (P::speculative(this) && (cur_buf->GetState(vc) == VC::vc_alloc)));
     
     Flit const * const f = cur_buf->FrontFlit(vc);
     assert(f);
@@ -1515,7 +1545,7 @@ void IQRouter::_SWAllocEvaluate( )
       
       BufferState const * const dest_buf = _next_buf[dest_output];
       
-      if (dest_buf->IsFullFor(dest_vc) || ( _output_buffer_size!=-1  && _output_buffer[dest_output].size()>=(size_t)(_output_buffer_size))) {
+      if (dest_buf->IsFullFor(dest_vc) || ( !P::unbounded_output_buffer(this)  && _output_buffer[dest_output].size()>=(size_t)(_output_buffer_size))) {
         if (f->watch) {
           *gWatchOut  << GetSimTime() << " | " << FullName() << " | "
                       << "  VC " << dest_vc 
@@ -1525,11 +1555,11 @@ void IQRouter::_SWAllocEvaluate( )
         iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
         continue;
       }
-      bool const requested = _SWAllocAddReq(input, vc, dest_output);
+      bool const requested = _SWAllocAddReq<P>(input, vc, dest_output);
       watched |= requested && f->watch;
       continue;
     }
-    assert(_speculative && (cur_buf->GetState(vc) == VC::vc_alloc));
+    assert(P::speculative(this) && (cur_buf->GetState(vc) == VC::vc_alloc));
     assert(f->head);
       
     // The following models the speculative VC allocation aspects of the 
@@ -1542,7 +1572,7 @@ void IQRouter::_SWAllocEvaluate( )
     
     set<OutputSet::sSetElement> const setlist = route_set->GetSet();
     
-    assert(!_noq || (setlist.size() == 1));
+    assert(!P::noq(this) || (setlist.size() == 1));
 
     for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
         iset != setlist.end();
@@ -1559,14 +1589,14 @@ void IQRouter::_SWAllocEvaluate( )
       bool elig = false;
       bool cred = false;
 
-      if (_spec_check_elig) {
+      if (P::spec_check_elig(this)) {
         // for higher levels of speculation, check if at least one suitable VC 
         // is available at the current output
         
         int vc_start;
         int vc_end;
         
-        if (_noq && _noq_next_output_port[input][vc] >= 0) {
+        if (P::noq(this) && _noq_next_output_port[input][vc] >= 0) {
           assert(!_routing_delay);
           vc_start = _noq_next_vc_start[input][vc];
           vc_end = _noq_next_vc_end[input][vc];
@@ -1581,9 +1611,9 @@ void IQRouter::_SWAllocEvaluate( )
         for(int dest_vc = vc_start; dest_vc <= vc_end; ++dest_vc) {
           assert((dest_vc >= 0) && (dest_vc < _vcs));
           
-          if (dest_buf->IsAvailableFor(dest_vc) && ( _output_buffer_size==-1 || _output_buffer[dest_output].size()<(size_t)(_output_buffer_size))) {
+          if (dest_buf->IsAvailableFor(dest_vc) && ( P::unbounded_output_buffer(this) || _output_buffer[dest_output].size()<(size_t)(_output_buffer_size))) {
             elig = true;
-            if (!_spec_check_cred || !dest_buf->IsFullFor(dest_vc)) {
+            if (!P::spec_check_cred(this) || !dest_buf->IsFullFor(dest_vc)) {
               cred = true;
               break;
             }
@@ -1591,14 +1621,14 @@ void IQRouter::_SWAllocEvaluate( )
         }
       }
       
-      if (_spec_check_elig && !elig) {
+      if (P::spec_check_elig(this) && !elig) {
         if (f->watch) {
           *gWatchOut  << GetSimTime() << " | " << FullName() << " | "
                       << "  Output " << dest_output 
                       << " has no suitable VCs available." << endl;
         }
         iter->second.second = STALL_BUFFER_BUSY;
-      } else if (_spec_check_cred && !cred) {
+      } else if (P::spec_check_cred(this) && !cred) {
         if (f->watch) {
           *gWatchOut  << GetSimTime() << " | " << FullName() << " | "
                       << "  All suitable VCs at output " << dest_output 
@@ -1606,7 +1636,7 @@ void IQRouter::_SWAllocEvaluate( )
         }
         iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
       } else {
-        bool const requested = _SWAllocAddReq(input, vc, dest_output);
+        bool const requested = _SWAllocAddReq<P>(input, vc, dest_output);
         watched |= requested && f->watch;
       }
     }
@@ -1634,7 +1664,7 @@ void IQRouter::_SWAllocEvaluate( )
     }
   }
   
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
+  for(RingFIFO<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
       iter != _sw_alloc_vcs.end();
       ++iter) {
 
@@ -1658,7 +1688,7 @@ void IQRouter::_SWAllocEvaluate( )
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
     assert((cur_buf->GetState(vc) == VC::active) || 
-	   (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	   (P::speculative(this) && (cur_buf->GetState(vc) == VC::vc_alloc)));
     
     Flit const * const f = cur_buf->FrontFlit(vc);
     assert(f);
@@ -1696,7 +1726,7 @@ void IQRouter::_SWAllocEvaluate( )
       expanded_output = _spec_sw_allocator->OutputAssigned(expanded_input);
       if (expanded_output >= 0) {
         assert((expanded_output % _output_speedup) == (input % _output_speedup));
-        if (_spec_mask_by_reqs && 
+        if (P::spec_mask_by_reqs(this) && 
           _sw_allocator->OutputHasRequests(expanded_output)) {
           if (f->watch) {
             *gWatchOut  << GetSimTime() << " | " << FullName() << " | "
@@ -1708,7 +1738,7 @@ void IQRouter::_SWAllocEvaluate( )
                         << " has non-speculative requests." << endl;
           }
           iter->second.second = STALL_CROSSBAR_CONFLICT;
-        } else if (!_spec_mask_by_reqs && (_sw_allocator->InputAssigned(expanded_output) >= 0)) {
+        } else if (!P::spec_mask_by_reqs(this) && (_sw_allocator->InputAssigned(expanded_output) >= 0)) {
           if (f->watch) {
             *gWatchOut  << GetSimTime() << " | " << FullName() << " | "
                         << "Discarding speculative grant for VC " << vc
@@ -1763,11 +1793,11 @@ void IQRouter::_SWAllocEvaluate( )
     }
   }
   
-  if (!_speculative && (_sw_alloc_delay <= 1)) {
+  if (!P::speculative(this) && (_sw_alloc_delay <= 1)) {
     return;
   }
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
+  for(RingFIFO<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
       iter != _sw_alloc_vcs.end();
       ++iter) {
 
@@ -1800,7 +1830,7 @@ void IQRouter::_SWAllocEvaluate( )
       Buffer const * const cur_buf = _buf[input];
       assert(!cur_buf->Empty(vc));
       assert((cur_buf->GetState(vc) == VC::active) ||
-	     (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	     (P::speculative(this) && (cur_buf->GetState(vc) == VC::vc_alloc)));
       
       Flit const * const f = cur_buf->FrontFlit(vc);
       assert(f);
@@ -1827,7 +1857,7 @@ void IQRouter::_SWAllocEvaluate( )
           *gWatchOut << "." << endl;
         }
         iter->second.second = STALL_CROSSBAR_CONFLICT;
-      } else if (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)) {
+      } else if (P::speculative(this) && (cur_buf->GetState(vc) == VC::vc_alloc)) {
         assert(f->head);
 
         if (_vc_allocator) { // separate VC and switch allocators
@@ -1879,7 +1909,7 @@ void IQRouter::_SWAllocEvaluate( )
           bool full = true;
           bool reserved = false;
 
-          assert(!_noq || (setlist.size() == 1));
+          assert(!P::noq(this) || (setlist.size() == 1));
 
           for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
               iset != setlist.end();
@@ -1889,7 +1919,7 @@ void IQRouter::_SWAllocEvaluate( )
               int vc_start;
               int vc_end;
               
-              if (_noq && _noq_next_output_port[input][vc] >= 0) {
+              if (P::noq(this) && _noq_next_output_port[input][vc] >= 0) {
                 assert(!_routing_delay);
                 vc_start = _noq_next_vc_start[input][vc];
                 vc_end = _noq_next_vc_end[input][vc];
@@ -1965,8 +1995,9 @@ void IQRouter::_SWAllocEvaluate( )
   }
 }
 
-void IQRouter::_SWAllocUpdate( )
+template<class P> void IQRouter::_SWAllocUpdate( )
 {
+  PROFILE_SCOPE("IQRouter::_SWAllocUpdate");
   while(!_sw_alloc_vcs.empty()) {
 
     pair<int, pair<pair<int, int>, int> > const & item = _sw_alloc_vcs.front();
@@ -1985,7 +2016,7 @@ void IQRouter::_SWAllocUpdate( )
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
     assert((cur_buf->GetState(vc) == VC::active) ||
-	   (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	   (P::speculative(this) && (cur_buf->GetState(vc) == VC::vc_alloc)));
     
     Flit * const f = cur_buf->FrontFlit(vc);
     assert(f);
@@ -2029,7 +2060,7 @@ void IQRouter::_SWAllocUpdate( )
         const OutputSet * route_set = cur_buf->GetRouteSet(vc);
         set<OutputSet::sSetElement> const setlist = route_set->GetSet();
         
-        assert(!_noq || (setlist.size() == 1));
+        assert(!P::noq(this) || (setlist.size() == 1));
         
         for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
             iset != setlist.end();
@@ -2039,7 +2070,7 @@ void IQRouter::_SWAllocUpdate( )
             int vc_start;
             int vc_end;
             
-            if (_noq && _noq_next_output_port[input][vc] >= 0) {
+            if (P::noq(this) && _noq_next_output_port[input][vc] >= 0) {
               assert(!_routing_delay);
               vc_start = _noq_next_vc_start[input][vc];
               vc_end = _noq_next_vc_end[input][vc];
@@ -2055,7 +2086,7 @@ void IQRouter::_SWAllocUpdate( )
               assert((out_vc >= 0) && (out_vc < _vcs));
               
               int vc_prio = iset->pri;
-              if (_vc_prioritize_empty && !dest_buf->IsEmptyFor(out_vc)) {
+              if (P::vc_prioritize_empty(this) && !dest_buf->IsEmptyFor(out_vc)) {
                 assert(vc_prio >= 0);
                 vc_prio += numeric_limits<int>::min();
               }
@@ -2088,6 +2119,10 @@ void IQRouter::_SWAllocUpdate( )
         cur_buf->SetOutput(vc, output, match_vc);
         dest_buf->TakeBuffer(match_vc, input*_vcs + vc);
 
+        if (gEventTrace) {
+          gEventTrace->Record(EventTrace::VC_ALLOC, f, GetID(), input, output, match_vc);
+        }
+
         _vc_rr_offset[output*_classes+cl] = (match_vc + 1) % _vcs;
 
       } else {
@@ -2105,6 +2140,10 @@ void IQRouter::_SWAllocUpdate( )
                     << "." << endl;
       }
 
+      if (gEventTrace) {
+        gEventTrace->Record(EventTrace::SW_GRANT, f, GetID(), input, output, match_vc);
+      }
+
       cur_buf->RemoveFlit(vc);
       // if (f->head && (f->hops == 0))
       //   offset++;
@@ -2113,39 +2152,40 @@ void IQRouter::_SWAllocUpdate( )
       flit_count[output]--;
       assert(flit_count[output] >= 0);
 
-#ifdef WAIT_TIME
-      if (f->head){
-        if (f->rc_time < 0)
-          cout << GetSimTime() << " - fID: " << f->id << " | RC time: " << f->rc_time << endl;
-
-        assert(f->rc_time >= 0);
-
+      if(gTrackWaitTime) {
+        FlitTiming & t = f->Timing();
         if (f->head){
-          f->wait_time += GetSimTime() - f->in_time;
-          // Use hop count to check service time of 2-level Fat-tree
-          if (f->hops == 0)
-            f->service_uptime += GetSimTime() - f->rc_time;
-          if (f->hops == 1)
-            f->service_downtime += GetSimTime() - f->rc_time;
-          f->service_time += GetSimTime() - f->rc_time;
+          if (t.rc_time < 0)
+            cout << GetSimTime() << " - fID: " << f->id << " | RC time: " << t.rc_time << endl;
+
+          assert(t.rc_time >= 0);
+
+          if (f->head){
+            t.wait_time += GetSimTime() - t.in_time;
+            // Use hop count to check service time of 2-level Fat-tree
+            if (f->hops == 0)
+              t.service_uptime += GetSimTime() - t.rc_time;
+            if (f->hops == 1)
+              t.service_downtime += GetSimTime() - t.rc_time;
+            t.service_time += GetSimTime() - t.rc_time;
+          }
+
+          if (f->watch){
+            cout << GetSimTime() << " - Service time for flit " << f->id << ", packet " << f->pid << ", message " << f->mid << " at router " << this->GetID() << " is " << GetSimTime() - t.rc_time << endl;
+          }
         }
 
-        if (f->watch){
-          cout << GetSimTime() << " - Service time for flit " << f->id << ", packet " << f->pid << ", message " << f->mid << " at router " << this->GetID() << " is " << GetSimTime() - f->rc_time << endl;
+        if ((f->head) && (((f->dest / gC) + gK)== this->GetID())){
+          int temp = t.ewtime;
+          assert(temp >= 0);
+          t.ewtime = GetSimTime() - temp;
         }
       }
 
-      if ((f->head) && (((f->dest / gC) + gK)== this->GetID())){
-        int temp = f->ewtime;
-        assert(temp >= 0);
-        f->ewtime = GetSimTime() - temp;
+      if(gTrackFlows) {
+        --_stored_flits[f->cl][input];
+        if (f->tail) --_active_packets[f->cl][input];
       }
-#endif
-
-#ifdef TRACK_FLOWS
-      --_stored_flits[f->cl][input];
-      if (f->tail) --_active_packets[f->cl][input];
-#endif
 
       _bufferMonitor->read(input, f) ;
 
@@ -2156,7 +2196,7 @@ void IQRouter::_SWAllocUpdate( )
         const FlitChannel * channel = _output_channels[output];
         const Router * router = channel->GetSink();
         if (router) {
-          if (_noq) {
+          if (P::noq(this)) {
             if (f->watch) {
               *gWatchOut  << GetSimTime() << " | " << FullName() << " | "
                           << "Updating lookahead routing information for flit " << f->id
@@ -2190,19 +2230,20 @@ void IQRouter::_SWAllocUpdate( )
         }
       }
 
-#ifdef TRACK_FLOWS
-      ++_outstanding_credits[f->cl][output];
-      _outstanding_classes[output][f->vc].push(f->cl);
-#endif
+      if(gTrackFlows) {
+        ++_outstanding_credits[f->cl][output];
+        _outstanding_classes[output][f->vc].push(f->cl);
+      }
 
       dest_buf->SendingFlit(f);
 
       _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
 
-      if (_out_queue_credits.count(input) == 0) {
-        _out_queue_credits.insert(make_pair(input, Credit::New()));
+      if (!_out_queue_credits[input]) {
+        _out_queue_credits[input] = Credit::New();
+        _out_queue_inputs.push_back(input);
       }
-      _out_queue_credits.find(input)->second->vc.insert(vc);
+      _out_queue_credits[input]->vc.insert(vc);
 
       if (cur_buf->Empty(vc)) {
         if (f->tail) {
@@ -2218,9 +2259,9 @@ void IQRouter::_SWAllocUpdate( )
             cur_buf->SetState(vc, VC::routing);
             _route_vcs.push_back(make_pair(-1, item.second.first));
 
-#ifdef WAIT_TIME
-            nf->rc_time = GetSimTime();
-#endif
+            if(gTrackWaitTime) {
+              nf->Timing().rc_time = GetSimTime();
+            }
           } else {
             if (nf->watch) {
               *gWatchOut  << GetSimTime() << " | " << FullName() << " | "
@@ -2231,18 +2272,18 @@ void IQRouter::_SWAllocUpdate( )
             }
             cur_buf->SetRouteSet(vc, &nf->la_route_set);
             cur_buf->SetState(vc, VC::vc_alloc);
-            if (_speculative) {
+            if (P::speculative(this)) {
               _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
             }
             if (_vc_allocator) {
               _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
             }
-            if (_noq) {
+            if (P::noq(this)) {
               _UpdateNOQ(input, vc, nf);
             }
           }
         } else {
-          if (_hold_switch_for_packet) {
+          if (P::hold_switch_for_packet(this)) {
             if (f->watch) {
               *gWatchOut  << GetSimTime() << " | " << FullName() << " | "
                           << "Setting up switch hold for VC " << vc
@@ -2267,25 +2308,25 @@ void IQRouter::_SWAllocUpdate( )
                     << "  No output port allocated." << endl;
       }
 
-#ifdef TRACK_STALLS
-      assert((expanded_output == -1) || // for stalls that are accounted for in VC allocation path
-	     (expanded_output == STALL_BUFFER_BUSY) ||
-	     (expanded_output == STALL_BUFFER_CONFLICT) ||
-	     (expanded_output == STALL_BUFFER_FULL) ||
-	     (expanded_output == STALL_BUFFER_RESERVED) ||
-	     (expanded_output == STALL_CROSSBAR_CONFLICT));
-      if (expanded_output == STALL_BUFFER_BUSY) {
-	++_buffer_busy_stalls[f->cl];
-      } else if (expanded_output == STALL_BUFFER_CONFLICT) {
-	++_buffer_conflict_stalls[f->cl];
-      } else if (expanded_output == STALL_BUFFER_FULL) {
-	++_buffer_full_stalls[f->cl];
-      } else if (expanded_output == STALL_BUFFER_RESERVED) {
-	++_buffer_reserved_stalls[f->cl];
-      } else if (expanded_output == STALL_CROSSBAR_CONFLICT) {
-	++_crossbar_conflict_stalls[f->cl];
+      if(gTrackStalls) {
+        assert((expanded_output == -1) || // for stalls that are accounted for in VC allocation path
+	       (expanded_output == STALL_BUFFER_BUSY) ||
+	       (expanded_output == STALL_BUFFER_CONFLICT) ||
+	       (expanded_output == STALL_BUFFER_FULL) ||
+	       (expanded_output == STALL_BUFFER_RESERVED) ||
+	       (expanded_output == STALL_CROSSBAR_CONFLICT));
+        if (expanded_output == STALL_BUFFER_BUSY) {
+	  ++_buffer_busy_stalls[f->cl];
+        } else if (expanded_output == STALL_BUFFER_CONFLICT) {
+	  ++_buffer_conflict_stalls[f->cl];
+        } else if (expanded_output == STALL_BUFFER_FULL) {
+	  ++_buffer_full_stalls[f->cl];
+        } else if (expanded_output == STALL_BUFFER_RESERVED) {
+	  ++_buffer_reserved_stalls[f->cl];
+        } else if (expanded_output == STALL_CROSSBAR_CONFLICT) {
+	  ++_crossbar_conflict_stalls[f->cl];
+        }
       }
-#endif
 
       _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
     }
@@ -2300,7 +2341,8 @@ void IQRouter::_SWAllocUpdate( )
 
 void IQRouter::_SwitchEvaluate( )
 {
-  for(deque<pair<int, pair<Flit *, pair<int, int> > > >::iterator iter = _crossbar_flits.begin();
+  PROFILE_SCOPE("IQRouter::_SwitchEvaluate");
+  for(RingFIFO<pair<int, pair<Flit *, pair<int, int> > > >::iterator iter = _crossbar_flits.begin();
       iter != _crossbar_flits.end();
       ++iter) {
     
@@ -2330,6 +2372,7 @@ void IQRouter::_SwitchEvaluate( )
 
 void IQRouter::_SwitchUpdate( )
 {
+  PROFILE_SCOPE("IQRouter::_SwitchUpdate");
   while(!_crossbar_flits.empty()) {
 
     pair<int, pair<Flit *, pair<int, int> > > const & item = _crossbar_flits.front();
@@ -2382,20 +2425,25 @@ void IQRouter::_SwitchUpdate( )
 
 void IQRouter::_OutputQueuing( )
 {
-  for(map<int, Credit *>::const_iterator iter = _out_queue_credits.begin();
-      iter != _out_queue_credits.end();
+  PROFILE_SCOPE("IQRouter::_OutputQueuing");
+  // credits are released in input order, as the switch grants may arrive in
+  // any order
+  sort(_out_queue_inputs.begin(), _out_queue_inputs.end());
+  for(vector<int>::const_iterator iter = _out_queue_inputs.begin();
+      iter != _out_queue_inputs.end();
       ++iter) {
 
-    int const input = iter->first;
+    int const input = *iter;
     assert((input >= 0) && (input < _inputs));
 
-    Credit * const c = iter->second;
+    Credit * const c = _out_queue_credits[input];
     assert(c);
     assert(!c->vc.empty());
 
     _credit_buffer[input].push(c);
+    _out_queue_credits[input] = NULL;
   }
-  _out_queue_credits.clear();
+  _out_queue_inputs.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -2410,9 +2458,9 @@ void IQRouter::_SendFlits( )
       assert(f);
       _output_buffer[output].pop( );
 
-#ifdef TRACK_FLOWS
-      ++_sent_flits[f->cl][output];
-#endif
+      if(gTrackFlows) {
+        ++_sent_flits[f->cl][output];
+      }
 
       if (f->watch)
         *gWatchOut  << GetSimTime() << " | " << FullName() << " | "
@@ -2423,14 +2471,6 @@ void IQRouter::_SendFlits( )
         cout << "Outport " << output << endl << "Stop Mark" << endl;
       }
       _output_channels[output]->Send( f );
-
-      // Record utilization
-      // if (this->GetID() == 0)
-        // cout << GetSimTime() << " - Send flit ID: " << f->id << ", type: " << f->type << ", output: " << output << ", src: " << f->src << ", dest: " << f->dest << endl;
-
-#ifdef CHAN_UTILS
-      _util_vect[output].push(GetSimTime());
-#endif
     }
   }
 }
@@ -2442,6 +2482,11 @@ void IQRouter::_SendCredits( )
       Credit * const c = _credit_buffer[input].front( );
       assert(c);
       _credit_buffer[input].pop( );
+      if (gEventTrace) {
+        for (set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+          gEventTrace->RecordCredit(GetID(), input, *iter);
+        }
+      }
       _input_credits[input]->Send( c );
     }
   }
@@ -2485,7 +2530,6 @@ int IQRouter::GetInjectedPacket(int o) const {
 }
 
 
-#ifdef TRACK_BUFFERS
 int IQRouter::GetUsedCreditForClass(int output, int cl) const
 {
   assert((output >= 0) && (output < _outputs));
@@ -2498,7 +2542,6 @@ int IQRouter::GetBufferOccupancyForClass(int input, int cl) const
   assert((input >= 0) && (input < _inputs));
   return _buf[input]->GetOccupancyForClass(cl);
 }
-#endif
 
 vector<int> IQRouter::UsedCredits() const
 {
@@ -2533,6 +2576,72 @@ vector<int> IQRouter::MaxCredits() const
   return result;
 }
 
+Router::eVCWait IQRouter::GetVCWait( int input, int vc, vector<int> * waits ) const
+{
+  assert((input >= 0) && (input < _inputs));
+  assert((vc >= 0) && (vc < _vcs));
+  Buffer const * const cur_buf = _buf[input];
+  VC::eVCState const state = cur_buf->GetState(vc);
+
+  if(cur_buf->Empty(vc)) {
+    return (state == VC::active) ? VC_STARVED : VC_FREE;
+  }
+
+  if(state == VC::active) {
+    int const output = cur_buf->GetOutputPort(vc);
+    int const out_vc = cur_buf->GetOutputVC(vc);
+    if(!_next_buf[output]->IsFullFor(out_vc)) {
+      return VC_ADVANCING;
+    }
+    waits->push_back(output * _vcs + out_vc);
+    return VC_BLOCKED;
+  }
+
+  if(state == VC::vc_alloc) {
+    // blocked only if every output VC the route allows is taken
+    set<OutputSet::sSetElement> const setlist = cur_buf->GetRouteSet(vc)->GetSet();
+    for(set<OutputSet::sSetElement>::const_iterator iter = setlist.begin();
+	iter != setlist.end(); ++iter) {
+      BufferState const * const dest_buf = _next_buf[iter->output_port];
+      for(int out_vc = iter->vc_start; out_vc <= iter->vc_end; ++out_vc) {
+	if(dest_buf->IsAvailableFor(out_vc) && 
+	   !(_vc_busy_when_full && dest_buf->IsFullFor(out_vc))) {
+	  return VC_ADVANCING;
+	}
+	waits->push_back(iter->output_port * _vcs + out_vc);
+      }
+    }
+    return VC_BLOCKED;
+  }
+
+  return VC_ADVANCING;
+}
+
+int IQRouter::GetOutputVCHolder( int output, int vc ) const
+{
+  assert((output >= 0) && (output < _outputs));
+  assert((vc >= 0) && (vc < _vcs));
+  int const tag = _next_buf[output]->UsedBy(vc);
+  if(tag < 0) {
+    return -1;
+  }
+  Buffer const * const cur_buf = _buf[tag / _vcs];
+  int const in_vc = tag % _vcs;
+  // the tail may already have left while the output VC is still reserved
+  if((cur_buf->GetState(in_vc) != VC::active) || 
+     (cur_buf->GetOutputPort(in_vc) != output) ||
+     (cur_buf->GetOutputVC(in_vc) != vc)) {
+    return -1;
+  }
+  return tag;
+}
+
+Flit const * IQRouter::GetVCFront( int input, int vc ) const
+{
+  assert((input >= 0) && (input < _inputs));
+  return _buf[input]->FrontFlit(vc);
+}
+
 void IQRouter::_UpdateNOQ(int input, int vc, Flit const * f) {
   assert(!_routing_delay);
   assert(f);
@@ -2575,93 +2684,3 @@ void IQRouter::_UpdateNOQ(int input, int vc, Flit const * f) {
     }
   }
 }
-
-#ifdef CHAN_UTILS
-int IQRouter::GetChanUtil(int output){
-  if (output >= _outputs){
-    cout << "Output error: " << output << " at router " << this->GetID() << endl;
-  }
-
-  assert((output >= 0) && (output < _outputs));
-
-  int window = 1;
-  while ((!_util_vect[output].empty()) && (_util_vect[output].front() + window) <= GetSimTime()){
-    _util_vect[output].pop();
-  }
-
-  return (int)_util_vect[output].size();
-}
-#endif
-
-
-
-// THO: Some additionals for routing purpose
-// Cyclic: Function to generate n non-repeating random numbers
-int IQRouter::GenerateCyclic(int n, vector<int>& src_avai) const{
-     // Fill the vector
-    if (src_avai.empty()) {
-        for (int i = 0; i < n; i++)
-            src_avai.push_back(i);
-    }
- 
-    int m = src_avai.size();
- 
-    // Make sure the number is within the index range
-    int index = rand() % m;
- 
-    // Get random number from the vector
-    int num = src_avai[index];
- 
-    // Remove the number from the vector
-    swap(src_avai[index], src_avai[m - 1]);
-    src_avai.pop_back();
-
-    return num;
-}
-
-// THO: CRC8 for char type
-char IQRouter::CRC8(const char *data,int length) const
-{
-   char crc = 0x00;
-   char extract;
-   char sum;
-   for(int i=0;i<length;i++)
-   {
-      extract = *data;
-      for (char tempI = 8; tempI; tempI--) 
-      {
-        sum = (crc ^ extract) & 0x01;
-        crc >>= 1;
-        if (sum)
-          crc ^= 0xB8;
-        extract >>= 1;
-      }
-      data++;
-   }
-   return crc;
-}
-
-
-// THO: CRC16 for int type
-uint16_t IQRouter::crc16(const uint8_t* data, size_t length) const {
-  uint16_t crc = 0;
-  const uint16_t CRC16_POLY = 0x1021;
-  // const uint16_t CRC16_POLY = 0xA8F4;
-  for (size_t i = 0; i < length; ++i) {
-    crc ^= (uint16_t)data[i] << 8;
-    for (size_t j = 0; j < 8; ++j) {
-      if (crc & 0x8000) {
-        crc = (crc << 1) ^ CRC16_POLY;
-      } else {
-        crc <<= 1;
-      }
-    }
-  }
-  return crc;
-}
-
-uint16_t IQRouter::crc16_int(uint32_t data) const {
-  uint8_t bytes[4];
-  std::memcpy(bytes, &data, sizeof(data));
-  return crc16(bytes, sizeof(bytes));
-}
\ No newline at end of file
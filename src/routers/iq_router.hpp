@@ -36,6 +36,7 @@
 
 #include "router.hpp"
 #include "routefunc.hpp"
+#include "ringfifo.hpp"
 
 using namespace std;
 
@@ -67,18 +68,19 @@ class IQRouter : public Router {
   int _vc_alloc_delay;
   int _sw_alloc_delay;
   
-  map<int, Flit *> _in_queue_flits;
+  vector<pair<int, Flit *> > _in_queue_flits;
 
-  deque<pair<int, pair<Credit *, int> > > _proc_credits;
+  RingFIFO<pair<int, pair<Credit *, int> > > _proc_credits;
 
-  deque<pair<int, pair<int, int> > > _route_vcs;
-  deque<pair<int, pair<pair<int, int>, int> > > _vc_alloc_vcs;  
-  deque<pair<int, pair<pair<int, int>, int> > > _sw_hold_vcs;
-  deque<pair<int, pair<pair<int, int>, int> > > _sw_alloc_vcs;
+  RingFIFO<pair<int, pair<int, int> > > _route_vcs;
+  RingFIFO<pair<int, pair<pair<int, int>, int> > > _vc_alloc_vcs;  
+  RingFIFO<pair<int, pair<pair<int, int>, int> > > _sw_hold_vcs;
+  RingFIFO<pair<int, pair<pair<int, int>, int> > > _sw_alloc_vcs;
 
-  deque<pair<int, pair<Flit *, pair<int, int> > > > _crossbar_flits;
+  RingFIFO<pair<int, pair<Flit *, pair<int, int> > > > _crossbar_flits;
 
-  map<int, Credit *> _out_queue_credits;
+  vector<Credit *> _out_queue_credits;
+  vector<int> _out_queue_inputs;
 
   vector<Buffer *> _buf;
   vector<BufferState *> _next_buf;
@@ -107,36 +109,61 @@ class IQRouter : public Router {
   vector<vector<int> > _noq_next_vc_start;
   vector<vector<int> > _noq_next_vc_end;
 
-#ifdef CHAN_UTILS
-  vector<queue<int> > _util_vect;
-#endif
-
   vector<int> _injected_packets_vect;
 
-
-#ifdef TRACK_FLOWS
   vector<vector<queue<int> > > _outstanding_classes;
-#endif
+
+  // Pipeline policies: _RuntimePipe consults the configured options on every
+  // use, while each _FixedPipe instance turns them into constants so that
+  // the corresponding branches are compiled out of the stage functions.
+  struct _RuntimePipe {
+    static bool speculative(IQRouter const * r) { return r->_speculative; }
+    static bool spec_check_elig(IQRouter const * r) { return r->_spec_check_elig; }
+    static bool spec_check_cred(IQRouter const * r) { return r->_spec_check_cred; }
+    static bool spec_mask_by_reqs(IQRouter const * r) { return r->_spec_mask_by_reqs; }
+    static bool hold_switch_for_packet(IQRouter const * r) { return r->_hold_switch_for_packet; }
+    static bool noq(IQRouter const * r) { return r->_noq; }
+    static bool vc_prioritize_empty(IQRouter const * r) { return r->_vc_prioritize_empty; }
+    static bool unbounded_output_buffer(IQRouter const * r) { return r->_output_buffer_size == -1; }
+  };
+
+  // The speculation checks only matter when spec is set.
+  template<bool spec, bool hold, bool noq_, bool prio_empty, bool unbounded,
+	   bool elig = true, bool cred = true, bool mask = false>
+  struct _FixedPipe {
+    static bool speculative(IQRouter const *) { return spec; }
+    static bool spec_check_elig(IQRouter const *) { return elig; }
+    static bool spec_check_cred(IQRouter const *) { return cred; }
+    static bool spec_mask_by_reqs(IQRouter const *) { return mask; }
+    static bool hold_switch_for_packet(IQRouter const *) { return hold; }
+    static bool noq(IQRouter const *) { return noq_; }
+    static bool vc_prioritize_empty(IQRouter const *) { return prio_empty; }
+    static bool unbounded_output_buffer(IQRouter const *) { return unbounded; }
+  };
+
+  void (IQRouter::*_step)( );
 
   bool _ReceiveFlits( );
   bool _ReceiveCredits( );
 
   virtual void _InternalStep( );
 
-  bool _SWAllocAddReq(int input, int vc, int output);
+  template<class P> void _Step( );
 
-  void _InputQueuing( );
+  template<class P> bool _SWAllocAddReq(int input, int vc, int output);
+
+  template<class P> void _InputQueuing( );
 
   void _RouteEvaluate( );
-  void _VCAllocEvaluate( );
+  template<class P> void _VCAllocEvaluate( );
   void _SWHoldEvaluate( );
-  void _SWAllocEvaluate( );
+  template<class P> void _SWAllocEvaluate( );
   void _SwitchEvaluate( );
 
-  void _RouteUpdate( );
-  void _VCAllocUpdate( );
-  void _SWHoldUpdate( );
-  void _SWAllocUpdate( );
+  template<class P> void _RouteUpdate( );
+  template<class P> void _VCAllocUpdate( );
+  template<class P> void _SWHoldUpdate( );
+  template<class P> void _SWAllocUpdate( );
   void _SwitchUpdate( );
 
   void _OutputQueuing( );
@@ -176,27 +203,21 @@ public:
   virtual int GetUsedCreditVC(int o, int v) const;
   virtual int GetInjectedPacket(int o) const;
 
-#ifdef TRACK_BUFFERS
   virtual int GetUsedCreditForClass(int output, int cl) const;
   virtual int GetBufferOccupancyForClass(int input, int cl) const;
-#endif
 
   virtual vector<int> UsedCredits() const;
   virtual vector<int> FreeCredits() const;
   virtual vector<int> MaxCredits() const;
 
+  virtual bool HasVCWaitState( ) const { return true; }
+  virtual eVCWait GetVCWait( int input, int vc, vector<int> * waits ) const;
+  virtual int GetOutputVCHolder( int output, int vc ) const;
+  virtual Flit const * GetVCFront( int input, int vc ) const;
+
   SwitchMonitor const * const GetSwitchMonitor() const {return _switchMonitor;}
   BufferMonitor const * const GetBufferMonitor() const {return _bufferMonitor;}
 
-#ifdef CHAN_UTILS
-  virtual int GetChanUtil(int output);
-#endif
-
-  // THO: Some additionals for routing purpose
-  virtual int GenerateCyclic(int n, vector<int>& src_avai) const;
-  virtual char CRC8(const char *data,int length) const;
-  virtual uint16_t crc16(const uint8_t* data, size_t length) const;
-  virtual uint16_t crc16_int(uint32_t data) const;
 };
 
 #endif
@@ -0,0 +1,324 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "lite_router.hpp"
+
+#include <string>
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+
+#include "globals.hpp"
+#include "outputset.hpp"
+#include "profiler.hpp"
+#include "event_trace.hpp"
+
+LiteRouter::LiteRouter( Configuration const & config, Module *parent, 
+			string const & name, int id, int inputs, int outputs )
+: Router( config, parent, name, id, inputs, outputs ), _rr_offset(0)
+{
+  _vcs = config.GetInt( "num_vcs" );
+
+  // same total capacity as the input buffers of the IQ router
+  _input_buffer_size = config.GetInt( "buf_size" );
+  if ( _input_buffer_size < 0 ) {
+    _input_buffer_size = _vcs * config.GetInt( "vc_buf_size" );
+  }
+  _output_buffer_size = config.GetInt( "lite_output_buffer_size" );
+  if ( _output_buffer_size < 0 ) {
+    _output_buffer_size = config.GetInt( "vc_buf_size" );
+  }
+  if ( _input_buffer_size <= 0 || _output_buffer_size <= 0 ) {
+    Error("Lite router requires non-empty input and output buffers.");
+  }
+
+  // routing, VC and switch allocation collapse into a single fixed delay;
+  // as in the IQ router, a stage with delay d completes d-1 cycles after
+  // the flit reaches it
+  _pipeline_delay = config.GetInt( "lite_pipeline_delay" );
+  if ( _pipeline_delay < 0 ) {
+    _pipeline_delay = max(config.GetInt( "routing_delay" ) - 1, 0) + 
+      (config.GetInt( "vc_alloc_delay" ) - 1) + (config.GetInt( "sw_alloc_delay" ) - 1);
+  }
+
+  // Routing
+  string const rf = config.GetStr("routing_function") + "_" + config.GetStr("topology");
+  map<string, tRoutingFunction>::const_iterator rf_iter = gRoutingFunctionMap.find(rf);
+  if (rf_iter == gRoutingFunctionMap.end()) {
+    Error("Invalid routing function: " + rf);
+  }
+  _rf = rf_iter->second;
+
+  _input_queue.resize(_inputs, RingFIFO<pair<int, Flit *> >(_input_buffer_size));
+  _output_queue.resize(_outputs, RingFIFO<pair<int, Flit *> >(_output_buffer_size));
+  _credit_queue.resize(_inputs);
+
+  _in_output.resize(_inputs, -1);
+  _in_out_vc.resize(_inputs, -1);
+  _out_owner.resize(_outputs, -1);
+  _out_credits.resize(_outputs, _input_buffer_size);
+  _out_moved.resize(_outputs, -1);
+  _steps = 0;
+
+  _injected_packets_vect.resize(gK, 0);
+
+  _InitRoutingState(config);
+}
+
+LiteRouter::~LiteRouter( )
+{
+}
+
+void LiteRouter::ReadInputs( )
+{
+  PROFILE_SCOPE("LiteRouter::ReadInputs");
+  int const now = GetSimTime();
+
+  for ( int input = 0; input < _inputs; ++input ) {
+    Flit * const f = _input_channels[input]->Receive();
+    if ( f ) {
+      if ( f->watch ) {
+	*gWatchOut << now << " | " << FullName() << " | "
+		   << "Received flit " << f->id
+		   << " from channel at input " << input
+		   << "." << endl;
+      }
+      if ( gEventTrace ) {
+	gEventTrace->Record(EventTrace::HOP, f, GetID(), input);
+      }
+      assert((int)_input_queue[input].size() < _input_buffer_size);
+      _input_queue[input].push_back(make_pair(now + _pipeline_delay, f));
+    }
+  }
+
+  for ( int output = 0; output < _outputs; ++output ) {
+    Credit * const c = _output_credits[output]->Receive();
+    if ( c ) {
+      _proc_credits.push_back(make_pair(now + _credit_delay, 
+					make_pair(output, (int)c->vc.size())));
+      c->Free();
+    }
+  }
+}
+
+void LiteRouter::_Route( int input, Flit * f )
+{
+  OutputSet route;
+  _rf(this, f, input, &route, false);
+
+  // no VC or switch allocation to choose among alternatives, so take the
+  // highest-priority option the routing function offers
+  set<OutputSet::sSetElement> const & setlist = route.GetSet();
+  assert(!setlist.empty());
+  OutputSet::sSetElement const & elem = *setlist.begin();
+  assert((elem.output_port >= 0) && (elem.output_port < _outputs));
+
+  _in_output[input] = elem.output_port;
+  _in_out_vc[input] = elem.vc_start;
+
+  if ( f->watch ) {
+    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
+	       << "Routed packet " << f->pid
+	       << " at input " << input
+	       << " to output " << elem.output_port
+	       << " (VC " << elem.vc_start << ")."
+	       << endl;
+  }
+
+  // Injected packets per source
+  if (input < gC){
+    _injected_packets_vect[input] += 1;
+  }
+}
+
+void LiteRouter::_InternalStep( )
+{
+  PROFILE_SCOPE("LiteRouter::_InternalStep");
+  int const now = GetSimTime();
+  ++_steps;
+
+  while ( !_proc_credits.empty() && (_proc_credits.front().first <= now) ) {
+    pair<int, int> const & item = _proc_credits.front().second;
+    _out_credits[item.first] += item.second;
+    assert(_out_credits[item.first] <= _input_buffer_size);
+    _proc_credits.pop_front();
+  }
+
+  inc_hash = 0;
+  bool routed = false;
+
+  // move at most one flit per input and per output through the switch,
+  // rotating the input that gets first pick every step
+  for ( int i = 0; i < _inputs; ++i ) {
+    int const input = (_rr_offset + i) % _inputs;
+    RingFIFO<pair<int, Flit *> > & in_queue = _input_queue[input];
+    if ( in_queue.empty() || (in_queue.front().first > now) ) {
+      continue;
+    }
+    Flit * const f = in_queue.front().second;
+
+    if ( _in_output[input] < 0 ) {
+      assert(f->head);
+      _Route(input, f);
+      routed = true;
+    }
+    int const output = _in_output[input];
+
+    if ( ((_out_owner[output] >= 0) && (_out_owner[output] != input)) ||
+	 (_out_moved[output] == _steps) ||
+	 ((int)_output_queue[output].size() >= _output_buffer_size) ) {
+      continue;
+    }
+    in_queue.pop_front();
+
+    if ( gEventTrace ) {
+      gEventTrace->Record(EventTrace::SW_GRANT, f, GetID(), input, output, _in_out_vc[input]);
+    }
+
+    Credit * const c = Credit::New();
+    c->vc.insert(f->vc);
+    _credit_queue[input].push_back(c);
+
+    f->vc = _in_out_vc[input];
+    ++f->hops;
+    if ( f->tail ) {
+      _out_owner[output] = -1;
+      _in_output[input] = -1;
+    } else {
+      _out_owner[output] = input;
+    }
+    _out_moved[output] = _steps;
+    _output_queue[output].push_back(make_pair(now + max(_crossbar_delay - 1, 0), f));
+  }
+  _rr_offset = (_rr_offset + 1) % _inputs;
+
+  if ( routed ) {
+    _UpdateRouteOffsets();
+  }
+}
+
+void LiteRouter::WriteOutputs( )
+{
+  PROFILE_SCOPE("LiteRouter::WriteOutputs");
+  int const now = GetSimTime();
+
+  for ( int output = 0; output < _outputs; ++output ) {
+    RingFIFO<pair<int, Flit *> > & out_queue = _output_queue[output];
+    if ( !out_queue.empty() && (out_queue.front().first <= now) &&
+	 (_out_credits[output] > 0) ) {
+      Flit * const f = out_queue.front().second;
+      out_queue.pop_front();
+      --_out_credits[output];
+      if ( f->watch ) {
+	*gWatchOut << now << " | " << FullName() << " | "
+		   << "Sending flit " << f->id
+		   << " to channel at output " << output
+		   << "." << endl;
+      }
+      _output_channels[output]->Send( f );
+    }
+  }
+
+  for ( int input = 0; input < _inputs; ++input ) {
+    if ( !_credit_queue[input].empty() ) {
+      if ( gEventTrace ) {
+	Credit const * const c = _credit_queue[input].front();
+	gEventTrace->RecordCredit(GetID(), input, *c->vc.begin());
+      }
+      _input_credits[input]->Send( _credit_queue[input].front() );
+      _credit_queue[input].pop_front();
+    }
+  }
+}
+
+void LiteRouter::Display( ostream & os ) const
+{
+  for ( int input = 0; input < _inputs; ++input ) {
+    os << FullName() << " input " << input << ": "
+       << _input_queue[input].size() << " flits" << endl;
+  }
+  for ( int output = 0; output < _outputs; ++output ) {
+    os << FullName() << " output " << output << ": "
+       << _output_queue[output].size() << " flits, "
+       << _out_credits[output] << " credits" << endl;
+  }
+}
+
+// Credit queries are per port; the local output queue counts as occupancy
+// so that adaptive routing functions still see congestion at this router.
+int LiteRouter::GetUsedCredit(int o) const
+{
+  assert((o >= 0) && (o < _outputs));
+  return _input_buffer_size - _out_credits[o] + _output_queue[o].size();
+}
+
+int LiteRouter::GetBufferOccupancy(int i) const
+{
+  assert((i >= 0) && (i < _inputs));
+  return _input_queue[i].size();
+}
+
+int LiteRouter::GetUsedCreditVC(int o, int v) const
+{
+  assert((v >= 0) && (v < _vcs));
+  return GetUsedCredit(o);
+}
+
+int LiteRouter::GetInjectedPacket(int o) const
+{
+  assert((o >= 0) && (o < gC));
+  return _injected_packets_vect[o];
+}
+
+int LiteRouter::GetUsedCreditForClass(int output, int cl) const
+{
+  return GetUsedCredit(output);
+}
+
+int LiteRouter::GetBufferOccupancyForClass(int input, int cl) const
+{
+  return GetBufferOccupancy(input);
+}
+
+vector<int> LiteRouter::UsedCredits() const
+{
+  vector<int> result(_outputs);
+  for(int o = 0; o < _outputs; ++o) {
+    result[o] = _input_buffer_size - _out_credits[o];
+  }
+  return result;
+}
+
+vector<int> LiteRouter::FreeCredits() const
+{
+  return _out_credits;
+}
+
+vector<int> LiteRouter::MaxCredits() const
+{
+  return vector<int>(_outputs, _input_buffer_size);
+}
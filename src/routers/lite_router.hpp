@@ -0,0 +1,110 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _LITE_ROUTER_HPP_
+#define _LITE_ROUTER_HPP_
+
+#include <string>
+#include <vector>
+
+#include "router.hpp"
+#include "routefunc.hpp"
+#include "ringfifo.hpp"
+
+using namespace std;
+
+// Port-granularity router for very large networks. Each input is a single
+// FIFO and each output a single FIFO with a credit counter covering the
+// whole downstream input buffer; there is no per-VC state, no VC allocation
+// and no switch allocator. A packet holds its output from head to tail, and
+// each input and output moves at most one flit per cycle.
+class LiteRouter : public Router {
+
+  int _vcs;
+
+  int _input_buffer_size;
+  int _output_buffer_size;
+  int _pipeline_delay;
+
+  tRoutingFunction _rf;
+
+  // (ready time, flit)
+  vector<RingFIFO<pair<int, Flit *> > > _input_queue;
+  vector<RingFIFO<pair<int, Flit *> > > _output_queue;
+
+  // (ready time, (output, credits))
+  RingFIFO<pair<int, pair<int, int> > > _proc_credits;
+
+  // output and VC chosen for the packet at the head of each input
+  vector<int> _in_output;
+  vector<int> _in_out_vc;
+  // input holding each output until the current packet's tail has passed
+  vector<int> _out_owner;
+  vector<int> _out_credits;
+  // step in which each output last accepted a flit
+  vector<int> _out_moved;
+
+  // one credit per flit leaving each input, sent one per cycle
+  vector<RingFIFO<Credit *> > _credit_queue;
+
+  int _rr_offset;
+  int _steps;
+
+  vector<int> _injected_packets_vect;
+
+  virtual void _InternalStep( );
+
+  void _Route( int input, Flit * f );
+
+public:
+
+  LiteRouter( Configuration const & config,
+	      Module *parent, string const & name, int id,
+	      int inputs, int outputs );
+
+  virtual ~LiteRouter( );
+
+  virtual void ReadInputs( );
+  virtual void WriteOutputs( );
+
+  void Display( ostream & os = cout ) const;
+
+  virtual int GetUsedCredit(int o) const;
+  virtual int GetBufferOccupancy(int i) const;
+
+  virtual int GetUsedCreditVC(int o, int v) const;
+  virtual int GetInjectedPacket(int o) const;
+
+  virtual int GetUsedCreditForClass(int output, int cl) const;
+  virtual int GetBufferOccupancyForClass(int input, int cl) const;
+
+  virtual vector<int> UsedCredits() const;
+  virtual vector<int> FreeCredits() const;
+  virtual vector<int> MaxCredits() const;
+};
+
+#endif
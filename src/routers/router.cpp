@@ -41,14 +41,18 @@
 #include "booksim.hpp"
 #include <iostream>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
 #include "router.hpp"
 
 //////////////////Sub router types//////////////////////
 #include "iq_router.hpp"
 #include "event_router.hpp"
 #include "chaos_router.hpp"
+#include "lite_router.hpp"
 ///////////////////////////////////////////////////////
 #include "random_utils.hpp"
+#include "globals.hpp"
 
 int const Router::STALL_BUFFER_BUSY       = -2;
 int const Router::STALL_BUFFER_CONFLICT   = -3;
@@ -69,21 +73,21 @@ TimedModule( parent, name ), _id( id ), _inputs( inputs ), _outputs( outputs ),
   _internal_speedup = config.GetFloat( "internal_speedup" );
   _classes          = config.GetInt( "classes" );
 
-#ifdef TRACK_FLOWS
-  _received_flits.resize(_classes, vector<int>(_inputs, 0));
-  _stored_flits.resize(_classes);
-  _sent_flits.resize(_classes, vector<int>(_outputs, 0));
-  _active_packets.resize(_classes);
-  _outstanding_credits.resize(_classes, vector<int>(_outputs, 0));
-#endif
-
-#ifdef TRACK_STALLS
-  _buffer_busy_stalls.resize(_classes, 0);
-  _buffer_conflict_stalls.resize(_classes, 0);
-  _buffer_full_stalls.resize(_classes, 0);
-  _buffer_reserved_stalls.resize(_classes, 0);
-  _crossbar_conflict_stalls.resize(_classes, 0);
-#endif
+  if(gTrackFlows) {
+    _received_flits.resize(_classes, vector<int>(_inputs, 0));
+    _stored_flits.resize(_classes);
+    _sent_flits.resize(_classes, vector<int>(_outputs, 0));
+    _active_packets.resize(_classes);
+    _outstanding_credits.resize(_classes, vector<int>(_outputs, 0));
+  }
+
+  if(gTrackStalls) {
+    _buffer_busy_stalls.resize(_classes, 0);
+    _buffer_conflict_stalls.resize(_classes, 0);
+    _buffer_full_stalls.resize(_classes, 0);
+    _buffer_reserved_stalls.resize(_classes, 0);
+    _crossbar_conflict_stalls.resize(_classes, 0);
+  }
 
 }
 
@@ -123,6 +127,111 @@ bool Router::IsFaultyOutput( int c ) const
   return _channel_faults[c];
 }
 
+void Router::_InitRoutingState( const Configuration& config )
+{
+  spread_pid.resize(gK, 0);
+  switch_flag.resize(gK, false);
+
+
+  flit_count.resize(_outputs, 0);
+  latest_port.resize(gK, 0);
+  for (int i = 0; i < gK; i++) {
+    latest_port[i] = i;
+  }
+
+  int const flowlet_entries = config.GetInt("flowlet_table_size");
+  if(flowlet_entries <= 0) {
+    Error("flowlet_table_size must be greater than zero.");
+  }
+  flowlet_key.resize(flowlet_entries, 0);
+  flowlet_time.resize(flowlet_entries, -1);
+  flowlet_port.resize(flowlet_entries, -1);
+
+  GenerateCyclic(gK, pattern_init);
+}
+
+void Router::_UpdateRouteOffsets( )
+{
+  offset += inc_hash;
+
+  if ((offset / gK) != packet_cnt_check) {
+    random_offset = random_offset + (GetSimTime() % gK);
+    random_src_offset = GetSimTime() % gK;
+  }
+  packet_cnt_check = offset / gK;
+}
+
+// THO: Some additionals for routing purpose
+// Cyclic: Function to generate n non-repeating random numbers
+int Router::GenerateCyclic(int n, vector<int>& src_avai) const{
+     // Fill the vector
+    if (src_avai.empty()) {
+        for (int i = 0; i < n; i++)
+            src_avai.push_back(i);
+    }
+ 
+    int m = src_avai.size();
+ 
+    // Make sure the number is within the index range
+    int index = rand() % m;
+ 
+    // Get random number from the vector
+    int num = src_avai[index];
+ 
+    // Remove the number from the vector
+    swap(src_avai[index], src_avai[m - 1]);
+    src_avai.pop_back();
+
+    return num;
+}
+
+// THO: CRC8 for char type
+char Router::CRC8(const char *data,int length) const
+{
+   char crc = 0x00;
+   char extract;
+   char sum;
+   for(int i=0;i<length;i++)
+   {
+      extract = *data;
+      for (char tempI = 8; tempI; tempI--) 
+      {
+        sum = (crc ^ extract) & 0x01;
+        crc >>= 1;
+        if (sum)
+          crc ^= 0xB8;
+        extract >>= 1;
+      }
+      data++;
+   }
+   return crc;
+}
+
+
+// THO: CRC16 for int type
+uint16_t Router::crc16(const uint8_t* data, size_t length) const {
+  uint16_t crc = 0;
+  const uint16_t CRC16_POLY = 0x1021;
+  // const uint16_t CRC16_POLY = 0xA8F4;
+  for (size_t i = 0; i < length; ++i) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (size_t j = 0; j < 8; ++j) {
+      if (crc & 0x8000) {
+        crc = (crc << 1) ^ CRC16_POLY;
+      } else {
+        crc <<= 1;
+      }
+    }
+  }
+  return crc;
+}
+
+uint16_t Router::crc16_int(uint32_t data) const {
+  uint8_t bytes[4];
+  std::memcpy(bytes, &data, sizeof(data));
+  return crc16(bytes, sizeof(bytes));
+}
+
 /*Router constructor*/
 Router *Router::NewRouter( const Configuration& config,
 			   Module *parent, const string & name, int id,
@@ -136,6 +245,8 @@ Router *Router::NewRouter( const Configuration& config,
     r = new EventRouter( config, parent, name, id, inputs, outputs );
   } else if ( type == "chaos" ) {
     r = new ChaosRouter( config, parent, name, id, inputs, outputs );
+  } else if ( type == "lite" ) {
+    r = new LiteRouter( config, parent, name, id, inputs, outputs );
   } else {
     cerr << "Unknown router type: " << type << endl;
   }
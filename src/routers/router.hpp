@@ -72,24 +72,24 @@ protected:
   vector<CreditChannel *> _output_credits;
   vector<bool>            _channel_faults;
 
-#ifdef TRACK_FLOWS
   vector<vector<int> > _received_flits;
   vector<vector<int> > _stored_flits;
   vector<vector<int> > _sent_flits;
   vector<vector<int> > _outstanding_credits;
   vector<vector<int> > _active_packets;
-#endif
 
-#ifdef TRACK_STALLS
   vector<int> _buffer_busy_stalls;
   vector<int> _buffer_conflict_stalls;
   vector<int> _buffer_full_stalls;
   vector<int> _buffer_reserved_stalls;
   vector<int> _crossbar_conflict_stalls;
-#endif
 
   virtual void _InternalStep() = 0;
 
+  // routing function state shared by all router types (see routefunc.cpp)
+  void _InitRoutingState( const Configuration& config );
+  void _UpdateRouteOffsets( );
+
   mutable int _roundrobin;
 
 public:
@@ -140,6 +140,11 @@ public:
 
   mutable vector<int>           latest_port;
 
+  // THO: Flowlet table, indexed by a hash of (src, dest, type)
+  mutable vector<unsigned long> flowlet_key;
+  mutable vector<int>           flowlet_time;
+  mutable vector<int>           flowlet_port;
+
   mutable vector<pair<int, int> >  committed_packet;
   int                           packet_cnt_check;
 
@@ -159,12 +164,9 @@ public:
   virtual int GetUsedCreditVC(int o, int v) const = 0;
   virtual int GetInjectedPacket(int o) const = 0;
 
-#ifdef TRACK_BUFFERS
   virtual int GetUsedCreditForClass(int output, int cl) const = 0;
   virtual int GetBufferOccupancyForClass(int input, int cl) const = 0;
-#endif
 
-#ifdef TRACK_FLOWS
   inline vector<int> const & GetReceivedFlits(int c) const {
     assert((c >= 0) && (c < _classes));
     return _received_flits[c];
@@ -192,13 +194,26 @@ public:
     _received_flits[c].assign(_received_flits[c].size(), 0);
     _sent_flits[c].assign(_sent_flits[c].size(), 0);
   }
-#endif
 
   virtual vector<int> UsedCredits() const = 0;
   virtual vector<int> FreeCredits() const = 0;
   virtual vector<int> MaxCredits() const = 0;
 
-#ifdef TRACK_STALLS
+  // Per-VC wait state for deadlock detection (see deadlock_detector.hpp).
+  // Routers without per-VC input state keep the defaults and are skipped.
+  enum eVCWait { VC_FREE,       // empty and holding no output VC
+		 VC_ADVANCING,  // can move on without another VC draining
+		 VC_BLOCKED,    // waits for one of the output VCs in waits
+		 VC_STARVED };  // empty, but the rest of its packet is upstream
+  virtual bool HasVCWaitState( ) const { return false; }
+  virtual eVCWait GetVCWait( int input, int vc, vector<int> * waits ) const { 
+    return VC_ADVANCING; 
+  }
+  // input * vcs + vc of the input VC whose packet holds an output VC, or
+  // -1 if no packet at this router holds it
+  virtual int GetOutputVCHolder( int output, int vc ) const { return -1; }
+  virtual Flit const * GetVCFront( int input, int vc ) const { return NULL; }
+
   inline int GetBufferBusyStalls(int c) const {
     assert((c >= 0) && (c < _classes));
     return _buffer_busy_stalls[c];
@@ -228,20 +243,15 @@ public:
     _buffer_reserved_stalls[c] = 0;
     _crossbar_conflict_stalls[c] = 0;
   }
-#endif
 
   inline int NumInputs() const {return _inputs;}
   inline int NumOutputs() const {return _outputs;}
 
-#ifdef CHAN_UTILS
-  virtual int GetChanUtil(int output) { return 0; }
-#endif
-
   // THO: Some additionals for routing purpose
-  virtual int GenerateCyclic(int n, vector<int>& src_avai) const {return -1;}
-  virtual char CRC8(const char *data,int length) const {return 0;}
-  virtual uint16_t crc16(const uint8_t* data, size_t length) const {return 0;}
-  virtual uint16_t crc16_int(uint32_t data) const {return 0;}
+  int GenerateCyclic(int n, vector<int>& src_avai) const;
+  char CRC8(const char *data,int length) const;
+  uint16_t crc16(const uint8_t* data, size_t length) const;
+  uint16_t crc16_int(uint32_t data) const;
 
 };
 
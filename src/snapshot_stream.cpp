@@ -0,0 +1,180 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*snapshot_stream.cpp
+ *
+ *The layout of the routers and links is fixed when the stream is opened,
+ *so every record has the same size and only holds the counter values.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
+#include "booksim.hpp"
+#include "snapshot_stream.hpp"
+#include "network.hpp"
+#include "router.hpp"
+#include "flitchannel.hpp"
+
+SnapshotStream::SnapshotStream( string const & filename, int interval,
+				int buffer_records, vector<Network *> const & net,
+				int nodes )
+  : _filename(filename), _interval(interval), _nodes(nodes), _net(net),
+    _size(buffer_records), _head(0)
+{
+  if(_interval <= 0) {
+    cout << "Error: snapshot_interval must be greater than zero." << endl;
+    exit(-1);
+  }
+  if(_size <= 0) {
+    cout << "Error: snapshot_buffer must be greater than zero." << endl;
+    exit(-1);
+  }
+  _out.open(_filename.c_str(), ios::binary | ios::trunc);
+  if(!_out) {
+    cout << "Error: Unable to open snapshot file " << _filename << endl;
+    exit(-1);
+  }
+
+  SnapshotHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, "BSSNAP", 7);
+  h.version = VERSION;
+  h.interval = _interval;
+  h.subnets = _net.size();
+  h.nodes = _nodes;
+
+  vector<SnapshotRouter> routers;
+  vector<SnapshotLink> links;
+  for(int s = 0; s < (int)_net.size(); ++s) {
+    vector<Router *> const & r = _net[s]->GetRouters();
+    for(size_t i = 0; i < r.size(); ++i) {
+      SnapshotRouter sr;
+      sr.subnet = s;
+      sr.id = r[i]->GetID();
+      sr.inputs = r[i]->NumInputs();
+      sr.outputs = r[i]->NumOutputs();
+      routers.push_back(sr);
+      h.inputs += sr.inputs;
+      h.outputs += sr.outputs;
+    }
+    // every connected flit channel: injection, router-to-router, ejection
+    vector<FlitChannel *> const * const groups[] = {
+      &_net[s]->GetInject(), &_net[s]->GetChannels(), &_net[s]->GetEject()
+    };
+    for(int g = 0; g < 3; ++g) {
+      for(size_t i = 0; i < groups[g]->size(); ++i) {
+	FlitChannel const * const chan = (*groups[g])[i];
+	if(!chan->GetSource() && !chan->GetSink()) {
+	  continue;
+	}
+	SnapshotLink sl;
+	sl.subnet = s;
+	sl.src_router = chan->GetSource() ? chan->GetSource()->GetID() : -1;
+	sl.src_port = chan->GetSource() ? chan->GetSourcePort() : -1;
+	sl.dest_router = chan->GetSink() ? chan->GetSink()->GetID() : -1;
+	sl.dest_port = chan->GetSink() ? chan->GetSinkPort() : -1;
+	links.push_back(sl);
+	_links.push_back(chan);
+	_link_mark.push_back(chan->GetBusyCycles());
+      }
+    }
+  }
+  h.routers = routers.size();
+  h.links = links.size();
+  _record_ints = 1 + h.inputs + h.outputs + h.links + _nodes;
+  h.record_ints = _record_ints;
+
+  _out.write((char const *)&h, sizeof(h));
+  if(!routers.empty()) {
+    _out.write((char const *)&routers[0], routers.size() * sizeof(SnapshotRouter));
+  }
+  if(!links.empty()) {
+    _out.write((char const *)&links[0], links.size() * sizeof(SnapshotLink));
+  }
+  _out.flush();
+
+  _buffer.resize((size_t)_size * _record_ints);
+}
+
+SnapshotStream::~SnapshotStream( )
+{
+  Flush();
+  _out.close();
+}
+
+void SnapshotStream::Record( int time, vector<int> const & rob )
+{
+  assert((int)rob.size() == _nodes);
+  if(_head == _size) {
+    Flush();
+  }
+  int * r = &_buffer[(size_t)_head * _record_ints];
+  *r++ = time;
+  for(size_t s = 0; s < _net.size(); ++s) {
+    vector<Router *> const & routers = _net[s]->GetRouters();
+    for(size_t i = 0; i < routers.size(); ++i) {
+      for(int in = 0; in < routers[i]->NumInputs(); ++in) {
+	*r++ = routers[i]->GetBufferOccupancy(in);
+      }
+    }
+  }
+  for(size_t s = 0; s < _net.size(); ++s) {
+    vector<Router *> const & routers = _net[s]->GetRouters();
+    for(size_t i = 0; i < routers.size(); ++i) {
+      for(int out = 0; out < routers[i]->NumOutputs(); ++out) {
+	*r++ = routers[i]->GetUsedCredit(out);
+      }
+    }
+  }
+  for(size_t i = 0; i < _links.size(); ++i) {
+    int const busy = _links[i]->GetBusyCycles();
+    *r++ = busy - _link_mark[i];
+    _link_mark[i] = busy;
+  }
+  for(int n = 0; n < _nodes; ++n) {
+    *r++ = rob[n];
+  }
+  assert(r == &_buffer[0] + (size_t)(_head + 1) * _record_ints);
+  ++_head;
+}
+
+void SnapshotStream::Flush( )
+{
+  if(_head == 0) {
+    return;
+  }
+  _out.write((char const *)&_buffer[0], (size_t)_head * _record_ints * sizeof(int));
+  _out.flush();
+  if(!_out) {
+    cout << "Error: Unable to write snapshot file " << _filename << endl;
+    exit(-1);
+  }
+  _head = 0;
+}
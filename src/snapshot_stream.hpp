@@ -0,0 +1,127 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _SNAPSHOT_STREAM_HPP_
+#define _SNAPSHOT_STREAM_HPP_
+
+// Periodic binary snapshots of the network state, enabled with
+// snapshot_out. Every snapshot_interval cycles the traffic manager records
+// the buffer occupancy of every router input, the credits in use at every
+// router output, the flits sent on every link since the previous snapshot
+// and the reorder buffer occupancy at every node. Snapshots are plain
+// counter copies into a staging buffer that is written out in one piece
+// every snapshot_buffer snapshots, so the cost per cycle stays bounded;
+// booksim_snapdec (make snapdec) prints them as CSV.
+//
+// File layout: one SnapshotHeader, then SnapshotHeader::routers
+// SnapshotRouter and SnapshotHeader::links SnapshotLink entries, then
+// fixed-size records of SnapshotHeader::record_ints ints each:
+//
+//   time
+//   buffer occupancy, per router input (routers in order, inputs in order)
+//   used credits, per router output
+//   flits sent since the previous snapshot, per link
+//   reorder buffer occupancy, per node
+//
+// The number of records follows from the file size; a record cut short by
+// an aborted run is ignored.
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+class Network;
+class FlitChannel;
+
+struct SnapshotHeader {
+  char magic[8];      // "BSSNAP\0\0"
+  int version;
+  int interval;       // cycles between snapshots
+  int subnets;
+  int routers;        // routers of all subnetworks
+  int links;          // links of all subnetworks
+  int nodes;
+  int inputs;         // router inputs in total
+  int outputs;        // router outputs in total
+  int record_ints;    // ints per record
+  int reserved;
+};
+
+struct SnapshotRouter {
+  int subnet;
+  int id;
+  int inputs;
+  int outputs;
+};
+
+struct SnapshotLink {
+  int subnet;
+  int src_router;     // -1 for injection links
+  int src_port;
+  int dest_router;    // -1 for ejection links
+  int dest_port;
+};
+
+class SnapshotStream {
+
+public:
+
+  static const int VERSION = 1;
+
+  SnapshotStream( std::string const & filename, int interval, 
+		  int buffer_records, std::vector<Network *> const & net,
+		  int nodes );
+  ~SnapshotStream( );
+
+  int Interval( ) const { return _interval; }
+
+  // rob holds the reorder buffer occupancy of every node
+  void Record( int time, std::vector<int> const & rob );
+
+  void Flush( );
+
+private:
+
+  std::string _filename;
+  std::ofstream _out;
+
+  int _interval;
+  int _nodes;
+  int _record_ints;
+
+  std::vector<Network *> _net;
+  std::vector<FlitChannel const *> _links;
+  std::vector<int> _link_mark;
+
+  // staged records, written out when full
+  std::vector<int> _buffer;
+  int _size;
+  int _head;
+
+};
+
+#endif
@@ -63,7 +63,9 @@ public:
     AddSample( (double)val );
   }
 
-  int GetBin(int b){ return _hist[b];}
+  int GetBin(int b) const { return _hist[b];}
+  int NumBins( ) const { return _num_bins; }
+  double BinSize( ) const { return _bin_size; }
 
   void Display( ostream & os = cout ) const;
 
@@ -0,0 +1,115 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "booksim.hpp"
+#include "telemetry_server.hpp"
+
+TelemetryServer::TelemetryServer( string const & path )
+  : _path(path)
+{
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if(_path.size() >= sizeof(addr.sun_path)) {
+    cout << "Error: telemetry_socket path " << _path << " is too long." << endl;
+    exit(-1);
+  }
+  strcpy(addr.sun_path, _path.c_str());
+
+  // a socket left behind by an earlier run would make bind() fail, but
+  // anything else at the path is not ours to remove
+  struct stat st;
+  if(lstat(_path.c_str(), &st) == 0) {
+    if(!S_ISSOCK(st.st_mode)) {
+      cout << "Error: telemetry_socket path " << _path 
+	   << " exists and is not a socket." << endl;
+      exit(-1);
+    }
+    unlink(_path.c_str());
+  }
+
+  _fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if((_fd < 0) ||
+     (bind(_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+     (listen(_fd, 8) != 0) ||
+     (fcntl(_fd, F_SETFL, O_NONBLOCK) != 0)) {
+    cout << "Error: Unable to open telemetry socket " << _path << endl;
+    exit(-1);
+  }
+}
+
+TelemetryServer::~TelemetryServer( )
+{
+  for(size_t i = 0; i < _clients.size(); ++i) {
+    close(_clients[i]);
+  }
+  close(_fd);
+  // leave the path alone if something else has replaced the socket
+  struct stat st;
+  if((lstat(_path.c_str(), &st) == 0) && S_ISSOCK(st.st_mode)) {
+    unlink(_path.c_str());
+  }
+}
+
+bool TelemetryServer::Poll( )
+{
+  int client;
+  while((client = accept(_fd, NULL, NULL)) >= 0) {
+    fcntl(client, F_SETFL, O_NONBLOCK);
+    _clients.push_back(client);
+  }
+  return !_clients.empty();
+}
+
+void TelemetryServer::Publish( string const & line )
+{
+  string const msg = line + '\n';
+  for(size_t i = 0; i < _clients.size(); ) {
+    ssize_t const n = send(_clients[i], msg.data(), msg.size(), MSG_NOSIGNAL);
+    bool const skipped = (n < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK));
+    if(!skipped && (n != (ssize_t)msg.size())) {
+      // client went away, or fell so far behind that only part of the
+      // line fit; either way its stream cannot continue
+      close(_clients[i]);
+      _clients[i] = _clients.back();
+      _clients.pop_back();
+    } else {
+      ++i;
+    }
+  }
+}
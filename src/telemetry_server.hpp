@@ -0,0 +1,63 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _TELEMETRY_SERVER_HPP_
+#define _TELEMETRY_SERVER_HPP_
+
+// Live telemetry over a UNIX domain socket, enabled with telemetry_socket.
+// Every client that connects to the socket receives one text line per
+// update, of the form "key=value key=value ...". The socket is never
+// waited on: new clients are accepted and updates are sent without
+// blocking. A client that cannot keep up misses updates instead of
+// stalling the simulation, and is disconnected if an update only partly
+// fits into its socket buffer.
+
+#include <string>
+#include <vector>
+
+class TelemetryServer {
+
+public:
+
+  TelemetryServer( std::string const & path );
+  ~TelemetryServer( );
+
+  // Accepts pending connections; returns whether any client is connected,
+  // so that callers can skip building updates nobody reads.
+  bool Poll( );
+
+  void Publish( std::string const & line );
+
+private:
+
+  std::string _path;
+  int _fd;
+  std::vector<int> _clients;
+
+};
+
+#endif
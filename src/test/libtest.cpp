@@ -0,0 +1,169 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*libtest.cpp
+ *
+ *Checks for the embeddable simulator (libbooksim.hpp). Built and run by
+ *"make check"; exits with a non-zero status if a check fails.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "booksim.hpp"
+#include "booksim_config.hpp"
+#include "libbooksim.hpp"
+
+static int failures = 0;
+
+static void Check( bool cond, char const * what, int round )
+{
+  if(!cond) {
+    cerr << "FAILED: " << what << " (context " << round << ")" << endl;
+    ++failures;
+  }
+}
+
+static int const num_messages = 64;
+
+static void InjectMessages( BookSimContext & ctx )
+{
+  int const nodes = ctx.Nodes();
+  for(int m = 0; m < num_messages; ++m) {
+    ctx.Inject(m % nodes, (m * 7 + 3) % nodes, 1 + m % 5, m);
+  }
+}
+
+// Advances ctx by up to the given number of cycles, collecting the ids of
+// delivered messages; returns false once nothing is left in flight.
+static bool StepMessages( BookSimContext & ctx, vector<int> & mids, int cycles )
+{
+  for(int t = 0; (t < cycles) && (ctx.Pending() > 0); ++t) {
+    ctx.Step();
+    Delivery d;
+    while(ctx.PollDelivery(d)) {
+      mids.push_back(d.mid);
+    }
+  }
+  return ctx.Pending() > 0;
+}
+
+static void CheckIds( int pending, vector<int> mids, int round )
+{
+  Check(pending == 0, "all messages delivered", round);
+  Check((int)mids.size() == num_messages, "one delivery per message", round);
+  sort(mids.begin(), mids.end());
+  for(int m = 0; m < (int)mids.size(); ++m) {
+    if(mids[m] != m) {
+      Check(false, "message ids numbered from 0", round);
+      break;
+    }
+  }
+}
+
+// Contexts created one after another must each number their messages
+// from 0, whatever a previous context in the process has left behind.
+static void CheckMessageIds( BookSimConfig const & config )
+{
+  int const contexts = 4;
+  for(int round = 0; round < contexts; ++round) {
+    BookSimContext ctx(config);
+    InjectMessages(ctx);
+    vector<int> mids;
+    StepMessages(ctx, mids, 10000);
+    CheckIds(ctx.Pending(), mids, round);
+  }
+}
+
+// Two live contexts stepped in alternation must not share a counter.
+static void CheckInterleavedIds( BookSimConfig const & config )
+{
+  BookSimContext a(config);
+  BookSimContext b(config);
+  InjectMessages(a);
+  InjectMessages(b);
+  vector<int> a_mids, b_mids;
+  for(int t = 0; t < 10000; ++t) {
+    bool const a_busy = StepMessages(a, a_mids, 1);
+    bool const b_busy = StepMessages(b, b_mids, 1);
+    if(!a_busy && !b_busy) {
+      break;
+    }
+  }
+  CheckIds(a.Pending(), a_mids, 0);
+  CheckIds(b.Pending(), b_mids, 1);
+}
+
+static void RunContext( BookSimConfig const * config, vector<int> * mids,
+			int * pending )
+{
+  BookSimContext ctx(*config);
+  InjectMessages(ctx);
+  StepMessages(ctx, *mids, 10000);
+  *pending = ctx.Pending();
+}
+
+// Contexts driven from different threads at the same time.
+static void CheckConcurrentIds( BookSimConfig const & config )
+{
+  int const contexts = 4;
+  vector<vector<int> > mids(contexts);
+  vector<int> pending(contexts, -1);
+  vector<thread> threads;
+  for(int round = 0; round < contexts; ++round) {
+    threads.push_back(thread(RunContext, &config, &mids[round],
+			     &pending[round]));
+  }
+  for(int round = 0; round < contexts; ++round) {
+    threads[round].join();
+    CheckIds(pending[round], mids[round], round);
+  }
+}
+
+int main( int argc, char **argv )
+{
+  BookSimConfig config;
+  config.Assign("topology", "mesh");
+  config.Assign("k", 4);
+  config.Assign("n", 2);
+  config.Assign("routing_function", "dor");
+  config.Assign("compute_nodes", 16);
+  config.Assign("memory_nodes", 0);
+
+  CheckMessageIds(config);
+  CheckInterleavedIds(config);
+  CheckConcurrentIds(config);
+
+  if(failures) {
+    cerr << failures << " check(s) failed" << endl;
+    return 1;
+  }
+  cout << "All checks passed" << endl;
+  return 0;
+}
@@ -0,0 +1,215 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*msgtrace.cpp
+ *
+ *Converts a text message trace into the binary format replayed with
+ *sim_type = trace (see message_trace.hpp). Built by "make msgtrace". Each
+ *input line holds
+ *
+ *  time source dest [size [type]]
+ *
+ *with size in flits (0 for the configured message size) and type 0 for
+ *any, 1 for a read request or 2 for a write request; any further fields
+ *are ignored. Blank lines and lines starting with '#' are ignored. Times
+ *must not decrease within a source. The input is read twice so that the
+ *records of each source can be written straight into place.
+ */
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "message_trace.hpp"
+
+static void Usage( char const * prog )
+{
+  cerr << "Usage: " << prog << " [-n nodes] [-d divisor] input output" << endl
+       << "  -n  number of nodes (default: highest node in the trace + 1)" << endl
+       << "  -d  divide all times by this (e.g. to turn ps into cycles)" << endl;
+  exit(1);
+}
+
+// parses one line; returns false for blank lines and comments
+static bool ParseLine( char const * line, long long lineno, 
+		       MessageTraceRecord & r, int & source )
+{
+  while((*line == ' ') || (*line == '\t')) {
+    ++line;
+  }
+  if((*line == '\0') || (*line == '\n') || (*line == '\r') || (*line == '#')) {
+    return false;
+  }
+  long long v[5] = { 0, 0, 0, 0, 0 };
+  int n = 0;
+  char * end;
+  while(n < 5) {
+    long long const x = strtoll(line, &end, 10);
+    if(end == line) {
+      break;
+    }
+    v[n++] = x;
+    line = end;
+  }
+  if(n < 3) {
+    cerr << "Error: line " << lineno << ": expected time, source and dest" << endl;
+    exit(-1);
+  }
+  if((v[0] < 0) || (v[1] < 0) || (v[2] < 0) || (v[3] < 0) || 
+     (v[4] < 0) || (v[4] > 2)) {
+    cerr << "Error: line " << lineno << ": bad field" << endl;
+    exit(-1);
+  }
+  r.time = v[0];
+  source = v[1];
+  r.dest = v[2];
+  r.size = v[3];
+  r.type = v[4];
+  r.reserved = 0;
+  return true;
+}
+
+int main( int argc, char **argv )
+{
+  int nodes = -1;
+  long long divisor = 1;
+  int opt;
+  while((opt = getopt(argc, argv, "n:d:h")) != -1) {
+    switch(opt) {
+    case 'n': nodes = atoi(optarg); break;
+    case 'd': divisor = atoll(optarg); break;
+    default: Usage(argv[0]);
+    }
+  }
+  if((argc - optind != 2) || (divisor <= 0)) {
+    Usage(argv[0]);
+  }
+  char const * const in_name = argv[optind];
+  char const * const out_name = argv[optind + 1];
+
+  FILE * in = fopen(in_name, "r");
+  if(!in) {
+    cerr << "Error: Unable to open " << in_name << endl;
+    return -1;
+  }
+
+  // pass 1: count the records of each source and check their order
+  vector<long long> count;
+  vector<long long> last;
+  int max_node = -1;
+  long long messages = 0;
+  long long lineno = 0;
+  char line[1024];
+  MessageTraceRecord r;
+  int source;
+  while(fgets(line, sizeof(line), in)) {
+    ++lineno;
+    if(!ParseLine(line, lineno, r, source)) {
+      continue;
+    }
+    r.time /= divisor;
+    if(source >= (int)count.size()) {
+      count.resize(source + 1, 0);
+      last.resize(source + 1, 0);
+    }
+    if(r.time < last[source]) {
+      cerr << "Error: line " << lineno << ": time goes backwards for source "
+	   << source << endl;
+      return -1;
+    }
+    last[source] = r.time;
+    ++count[source];
+    ++messages;
+    max_node = max(max_node, max(source, r.dest));
+  }
+  if(nodes < 0) {
+    nodes = max_node + 1;
+  } else if(max_node >= nodes) {
+    cerr << "Error: trace uses node " << max_node << " but -n is " << nodes << endl;
+    return -1;
+  }
+  count.resize(nodes, 0);
+
+  // pass 2: write header, index and records straight into the mapped file
+  size_t const header_bytes = 
+    sizeof(MessageTraceHeader) + nodes * sizeof(MessageTraceIndex);
+  size_t const bytes = header_bytes + messages * sizeof(MessageTraceRecord);
+  int fd = open(out_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if((fd < 0) || (ftruncate(fd, bytes) != 0)) {
+    cerr << "Error: Unable to create " << out_name << endl;
+    return -1;
+  }
+  void * const p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if(p == MAP_FAILED) {
+    cerr << "Error: Unable to map " << out_name << endl;
+    return -1;
+  }
+
+  MessageTraceHeader * const h = (MessageTraceHeader *)p;
+  memset(h, 0, sizeof(*h));
+  strcpy(h->magic, "BSMSGTR");
+  h->version = MessageTrace::VERSION;
+  h->nodes = nodes;
+  h->messages = messages;
+  MessageTraceIndex * const index = (MessageTraceIndex *)(h + 1);
+  MessageTraceRecord * const records = 
+    (MessageTraceRecord *)((char *)p + header_bytes);
+  vector<long long> next(nodes);
+  long long first = 0;
+  for(int s = 0; s < nodes; ++s) {
+    index[s].first = first;
+    index[s].count = count[s];
+    next[s] = first;
+    first += count[s];
+  }
+
+  rewind(in);
+  lineno = 0;
+  while(fgets(line, sizeof(line), in)) {
+    ++lineno;
+    if(ParseLine(line, lineno, r, source)) {
+      r.time /= divisor;
+      records[next[source]++] = r;
+    }
+  }
+  fclose(in);
+
+  munmap(p, bytes);
+  close(fd);
+
+  cout << "Wrote " << messages << " messages from " << nodes << " nodes to "
+       << out_name << endl;
+  return 0;
+}
@@ -0,0 +1,158 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*resultsdec.cpp
+ *
+ *Reader for the columnar binary results written with results_out. Built by
+ *"make resultsdec"; lists the tables in a results file, or prints all
+ *tables of one name as a single CSV with the simulation and cycle of each
+ *table in front of its columns. A table cut short by an aborted run ends
+ *the file. Run with -h for usage.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "booksim.hpp"
+#include "results_writer.hpp"
+
+static void Usage( char const * prog )
+{
+  cerr << "Usage: " << prog << " [-t table] [-s sim] resultsfile" << endl
+       << "  without -t, list the tables in the file" << endl
+       << "  -t  print all tables of this name as CSV" << endl
+       << "  -s  only tables of this simulation" << endl;
+  exit(1);
+}
+
+int main( int argc, char **argv )
+{
+  string table;
+  int sim = -1;
+
+  int c;
+  while((c = getopt(argc, argv, "t:s:h")) != -1) {
+    switch(c) {
+    case 't': table = optarg; break;
+    case 's': sim = atoi(optarg); break;
+    default: Usage(argv[0]);
+    }
+  }
+  if(optind != argc - 1) {
+    Usage(argv[0]);
+  }
+
+  int const fd = open(argv[optind], O_RDONLY);
+  struct stat st;
+  if((fd < 0) || (fstat(fd, &st) != 0)) {
+    cerr << "Error: Unable to open results file " << argv[optind] << endl;
+    return 1;
+  }
+  if(st.st_size < (off_t)sizeof(ResultsHeader)) {
+    cerr << "Error: " << argv[optind] << " is not a results file" << endl;
+    return 1;
+  }
+  void * const p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(p == MAP_FAILED) {
+    cerr << "Error: Unable to map results file " << argv[optind] << endl;
+    return 1;
+  }
+  char const * const base = (char const *)p;
+  ResultsHeader const * const h = (ResultsHeader const *)base;
+  if(memcmp(h->magic, "BSRESLT", 8) || (h->version != ResultsWriter::VERSION)) {
+    cerr << "Error: " << argv[optind] << " is not a version "
+	 << ResultsWriter::VERSION << " results file" << endl;
+    return 1;
+  }
+
+  cout.precision(10);
+  bool header_done = false;
+  off_t pos = sizeof(ResultsHeader);
+  while(pos < st.st_size) {
+    if(pos + (off_t)sizeof(ResultsTableHeader) > st.st_size) {
+      cerr << "Warning: " << argv[optind] << " ends in a partial table" << endl;
+      break;
+    }
+    ResultsTableHeader const * const t = (ResultsTableHeader const *)(base + pos);
+    pos += sizeof(ResultsTableHeader);
+    if(pos + t->bytes > st.st_size) {
+      cerr << "Warning: " << argv[optind] << " ends in a partial table" << endl;
+      break;
+    }
+    char const * const data = base + pos;
+    pos += t->bytes;
+
+    string const name(t->name, strnlen(t->name, sizeof(t->name)));
+    if((sim >= 0) && (t->sim != sim)) {
+      continue;
+    }
+    if(table.empty()) {
+      cout << name << ": simulation " << t->sim << ", cycle " << t->time
+	   << ", " << t->rows << " rows x " << t->columns << " columns" << endl;
+      continue;
+    }
+    if(name != table) {
+      continue;
+    }
+
+    vector<char const *> columns(t->columns);
+    char const * n = data;
+    for(int i = 0; i < t->columns; ++i) {
+      columns[i] = n;
+      n += strlen(n) + 1;
+    }
+    size_t const names = (n - data + 7) & ~(size_t)7;
+    double const * const values = (double const *)(data + names);
+
+    if(!header_done) {
+      cout << "sim,time";
+      for(int i = 0; i < t->columns; ++i) {
+	cout << ',' << columns[i];
+      }
+      cout << '\n';
+      header_done = true;
+    }
+    for(int r = 0; r < t->rows; ++r) {
+      cout << t->sim << ',' << t->time;
+      for(int i = 0; i < t->columns; ++i) {
+	cout << ',' << values[(long long)i * t->rows + r];
+      }
+      cout << '\n';
+    }
+  }
+
+  munmap(p, st.st_size);
+  close(fd);
+  return 0;
+}
@@ -0,0 +1,164 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*snapdec.cpp
+ *
+ *Reader for the network snapshots written with snapshot_out. Built by
+ *"make snapdec"; prints one CSV line per snapshot, or with -l the routers
+ *and links the columns refer to. Run with -h for usage.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <iostream>
+
+#include "booksim.hpp"
+#include "snapshot_stream.hpp"
+
+static void Usage( char const * prog )
+{
+  cerr << "Usage: " << prog << " [-l] [-s start] [-u until] snapshotfile" << endl
+       << "  -l  print the routers and links instead of the snapshots" << endl
+       << "  -s  only snapshots at or after this cycle" << endl
+       << "  -u  only snapshots at or before this cycle" << endl;
+  exit(1);
+}
+
+int main( int argc, char **argv )
+{
+  bool layout = false;
+  int start = 0;
+  int until = -1;
+
+  int c;
+  while((c = getopt(argc, argv, "ls:u:h")) != -1) {
+    switch(c) {
+    case 'l': layout = true; break;
+    case 's': start = atoi(optarg); break;
+    case 'u': until = atoi(optarg); break;
+    default: Usage(argv[0]);
+    }
+  }
+  if(optind != argc - 1) {
+    Usage(argv[0]);
+  }
+
+  int const fd = open(argv[optind], O_RDONLY);
+  struct stat st;
+  if((fd < 0) || (fstat(fd, &st) != 0)) {
+    cerr << "Error: Unable to open snapshot file " << argv[optind] << endl;
+    return 1;
+  }
+  if(st.st_size < (off_t)sizeof(SnapshotHeader)) {
+    cerr << "Error: " << argv[optind] << " is not a snapshot file" << endl;
+    return 1;
+  }
+  void * const p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(p == MAP_FAILED) {
+    cerr << "Error: Unable to map snapshot file " << argv[optind] << endl;
+    return 1;
+  }
+  char const * const base = (char const *)p;
+  SnapshotHeader const * const h = (SnapshotHeader const *)base;
+  if(memcmp(h->magic, "BSSNAP", 7) || (h->version != SnapshotStream::VERSION)) {
+    cerr << "Error: " << argv[optind] << " is not a version "
+	 << SnapshotStream::VERSION << " snapshot file" << endl;
+    return 1;
+  }
+  off_t const layout_bytes = sizeof(SnapshotHeader) + 
+    (off_t)h->routers * sizeof(SnapshotRouter) + 
+    (off_t)h->links * sizeof(SnapshotLink);
+  if(st.st_size < layout_bytes) {
+    cerr << "Error: " << argv[optind] << " ends in its layout" << endl;
+    return 1;
+  }
+  SnapshotRouter const * const routers = 
+    (SnapshotRouter const *)(base + sizeof(SnapshotHeader));
+  SnapshotLink const * const links = (SnapshotLink const *)(routers + h->routers);
+
+  if(layout) {
+    cout << "# interval " << h->interval << ", " << h->subnets 
+	 << " subnetworks, " << h->nodes << " nodes" << endl;
+    cout << "router,subnet,id,inputs,outputs\n";
+    for(int i = 0; i < h->routers; ++i) {
+      cout << i << ',' << routers[i].subnet << ',' << routers[i].id << ','
+	   << routers[i].inputs << ',' << routers[i].outputs << '\n';
+    }
+    cout << "link,subnet,src_router,src_port,dest_router,dest_port\n";
+    for(int i = 0; i < h->links; ++i) {
+      cout << i << ',' << links[i].subnet << ',' << links[i].src_router << ','
+	   << links[i].src_port << ',' << links[i].dest_router << ','
+	   << links[i].dest_port << '\n';
+    }
+  } else {
+    cout << "time";
+    for(int i = 0; i < h->routers; ++i) {
+      for(int in = 0; in < routers[i].inputs; ++in) {
+	cout << ",buf_" << routers[i].subnet << '_' << routers[i].id << '_' << in;
+      }
+    }
+    for(int i = 0; i < h->routers; ++i) {
+      for(int out = 0; out < routers[i].outputs; ++out) {
+	cout << ",cred_" << routers[i].subnet << '_' << routers[i].id << '_' << out;
+      }
+    }
+    for(int i = 0; i < h->links; ++i) {
+      cout << ",link_" << i;
+    }
+    for(int n = 0; n < h->nodes; ++n) {
+      cout << ",rob_" << n;
+    }
+    cout << '\n';
+
+    off_t const record_bytes = (off_t)h->record_ints * sizeof(int);
+    off_t pos = layout_bytes;
+    for(; pos + record_bytes <= st.st_size; pos += record_bytes) {
+      int const * const r = (int const *)(base + pos);
+      if((r[0] < start) || ((until >= 0) && (r[0] > until))) {
+	continue;
+      }
+      cout << r[0];
+      for(int i = 1; i < h->record_ints; ++i) {
+	cout << ',' << r[i];
+      }
+      cout << '\n';
+    }
+    if(pos != st.st_size) {
+      cerr << "Warning: " << argv[optind] << " ends in a partial snapshot" << endl;
+    }
+  }
+
+  munmap(p, st.st_size);
+  close(fd);
+  return 0;
+}
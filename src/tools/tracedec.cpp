@@ -0,0 +1,174 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*tracedec.cpp
+ *
+ *Decoder for the binary event traces written with event_trace_out. Built by
+ *"make tracedec"; prints one line per record as text (the default) or CSV,
+ *optionally restricted to a flit, packet, node, event type or time range.
+ *Run with -h for usage.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <iostream>
+
+#include "event_trace.hpp"
+
+static void Usage( char const * prog )
+{
+  cerr << "Usage: " << prog << " [-c] [-f flit] [-p packet] [-n node]"
+       << " [-e event] [-s start] [-u until] tracefile" << endl
+       << "  -c  print CSV instead of text" << endl
+       << "  -e  one of inject, hop, vc_alloc, sw_grant, eject, retire, credit" << endl;
+  exit(1);
+}
+
+static void PrintText( TraceRecord const & r )
+{
+  cout << r.time << " | ";
+  bool const terminal = ((r.type == EventTrace::INJECT) ||
+			 (r.type == EventTrace::EJECT) ||
+			 (r.type == EventTrace::RETIRE));
+  cout << (terminal ? "node" : "router") << r.node << " | "
+       << EventTrace::EventName[r.type];
+  if(r.type == EventTrace::CREDIT) {
+    cout << " for VC " << r.vc << " at input " << r.port << endl;
+    return;
+  }
+  cout << " flit " << r.id << " (packet " << r.pid << ", class " << r.cl
+       << ", subnet " << (int)r.subnet << ")";
+  if(r.port >= 0) {
+    cout << " input " << r.port;
+  }
+  cout << " VC " << r.vc;
+  if(r.out_port >= 0) {
+    cout << " -> output " << r.out_port << " VC " << r.out_vc;
+  }
+  cout << endl;
+}
+
+static void PrintCSV( TraceRecord const & r )
+{
+  cout << r.time << ',' << EventTrace::EventName[r.type] << ','
+       << r.id << ',' << r.pid << ',' << r.cl << ',' << (int)r.subnet << ','
+       << r.node << ',' << r.port << ',' << r.vc << ','
+       << r.out_port << ',' << r.out_vc << '\n';
+}
+
+int main( int argc, char **argv )
+{
+  bool csv = false;
+  int flit = -1;
+  int packet = -1;
+  int node = -1;
+  int event = -1;
+  int start = 0;
+  int until = -1;
+
+  int c;
+  while((c = getopt(argc, argv, "cf:p:n:e:s:u:h")) != -1) {
+    switch(c) {
+    case 'c': csv = true; break;
+    case 'f': flit = atoi(optarg); break;
+    case 'p': packet = atoi(optarg); break;
+    case 'n': node = atoi(optarg); break;
+    case 'e':
+      for(int t = 0; t < EventTrace::NUM_EVENT_TYPES; ++t) {
+	if(!strcmp(optarg, EventTrace::EventName[t])) {
+	  event = t;
+	}
+      }
+      if(event < 0) {
+	Usage(argv[0]);
+      }
+      break;
+    case 's': start = atoi(optarg); break;
+    case 'u': until = atoi(optarg); break;
+    default: Usage(argv[0]);
+    }
+  }
+  if(optind != argc - 1) {
+    Usage(argv[0]);
+  }
+
+  int const fd = open(argv[optind], O_RDONLY);
+  struct stat st;
+  if((fd < 0) || (fstat(fd, &st) != 0)) {
+    cerr << "Error: Unable to open trace file " << argv[optind] << endl;
+    return 1;
+  }
+  if(st.st_size < (off_t)sizeof(TraceHeader)) {
+    cerr << "Error: " << argv[optind] << " is not an event trace" << endl;
+    return 1;
+  }
+  void * const p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(p == MAP_FAILED) {
+    cerr << "Error: Unable to map trace file " << argv[optind] << endl;
+    return 1;
+  }
+  TraceHeader const * const h = (TraceHeader const *)p;
+  if(memcmp(h->magic, "BSTRACE", 8) || (h->version != EventTrace::VERSION) ||
+     (h->record_size != (int)sizeof(TraceRecord))) {
+    cerr << "Error: " << argv[optind] << " is not a version "
+	 << EventTrace::VERSION << " event trace" << endl;
+    return 1;
+  }
+  long long const records = h->records;
+  if((off_t)(sizeof(TraceHeader) + records * sizeof(TraceRecord)) > st.st_size) {
+    cerr << "Error: " << argv[optind] << " is truncated" << endl;
+    return 1;
+  }
+  TraceRecord const * const r = (TraceRecord const *)(h + 1);
+
+  if(csv) {
+    cout << "time,event,flit,packet,class,subnet,node,port,vc,out_port,out_vc\n";
+  }
+  for(long long i = 0; i < records; ++i) {
+    TraceRecord const & rec = r[i];
+    if((rec.time < start) || ((until >= 0) && (rec.time > until))) continue;
+    if((flit >= 0) && (rec.id != flit)) continue;
+    if((packet >= 0) && (rec.pid != packet)) continue;
+    if((node >= 0) && (rec.node != node)) continue;
+    if((event >= 0) && (rec.type != event)) continue;
+    if(csv) {
+      PrintCSV(rec);
+    } else {
+      PrintText(rec);
+    }
+  }
+
+  munmap(p, st.st_size);
+  close(fd);
+  return 0;
+}
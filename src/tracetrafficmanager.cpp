@@ -0,0 +1,133 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <sstream>
+
+#include "packet_reply_info.hpp"
+#include "random_utils.hpp"
+#include "tracetrafficmanager.hpp"
+
+TraceTrafficManager::TraceTrafficManager( const Configuration &config, 
+					  const vector<Network *> & net )
+: TrafficManager(config, net)
+{
+  _trace_class = config.GetInt( "trace_class" );
+  if((_trace_class < 0) || (_trace_class >= _classes)) {
+    ostringstream err;
+    err << "Invalid trace class " << _trace_class;
+    Error( err.str( ) );
+  }
+
+  string const trace_file = config.GetStr( "trace_file" );
+  if(trace_file.empty()) {
+    Error( "sim_type = trace requires a trace_file" );
+  }
+  _trace = new MessageTrace( trace_file, _nodes );
+  cout << "Replaying " << _trace->Remaining() << " messages from "
+       << trace_file << endl;
+}
+
+TraceTrafficManager::~TraceTrafficManager( )
+{
+  delete _trace;
+}
+
+int TraceTrafficManager::_IssueMessage( int source, int cl )
+{
+  if(cl != _trace_class) {
+    return TrafficManager::_IssueMessage(source, cl);
+  }
+
+  if(_use_read_write[cl] && !_repliesPending[source].empty()) {
+    return (_repliesPending[source].front()->time <= _time) ? -1 : 0;
+  }
+
+  MessageTraceRecord const * const r = _trace->Peek(source);
+  if(!r || (r->time > _qtime[source][cl])) {
+    return 0;
+  }
+
+  int result = 1;
+  if(_use_read_write[cl]) {
+    if(r->type == 0) {
+      result = (RandomFloat() < _write_fraction[cl]) ? 2 : 1;
+    } else {
+      result = r->type;
+    }
+  }
+  _requestsOutstanding[source]++;
+  _message_seq_no[source]++;
+  return result;
+}
+
+void TraceTrafficManager::_NextRequest( int source, int cl, 
+					int & dest, int & flits )
+{
+  if(cl != _trace_class) {
+    TrafficManager::_NextRequest(source, cl, dest, flits);
+    return;
+  }
+  MessageTraceRecord const * const r = _trace->Peek(source);
+  assert(r);
+  dest = r->dest;
+  flits = (r->size > 0) ? r->size : -1;
+  _trace->Pop(source);
+}
+
+bool TraceTrafficManager::_SingleSim( )
+{
+  _trace->Reset();
+  _sim_state = running;
+  int const start_time = _time;
+
+  bool done = false;
+  while(!done) {
+    for(int iter = 0; iter < _sample_period; ++iter) {
+      _Step( );
+      if(_deadlocked) {
+	return false;
+      }
+    }
+
+    UpdateStats();
+    DisplayStats();
+    cout << _trace->Remaining() << " trace messages left to inject." << endl;
+
+    // other classes keep their configured traffic running in the
+    // background and do not hold up the end of the trace
+    int const c = _trace_class;
+    done = _trace->Done() && (_InFlightFlits(c) == 0);
+    for(int n = 0; done && (n < _nodes); ++n) {
+      done = !_use_read_write[c] || _repliesPending[n].empty();
+    }
+  }
+  cout << "Trace completed in " << _time - start_time << " cycles." << endl;
+
+  _sim_state = draining;
+  _drain_time = _time;
+  return 1;
+}
@@ -0,0 +1,60 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _TRACETRAFFICMANAGER_HPP_
+#define _TRACETRAFFICMANAGER_HPP_
+
+#include <iostream>
+
+#include "config_utils.hpp"
+#include "trafficmanager.hpp"
+#include "message_trace.hpp"
+
+// sim_type = trace: the messages of class trace_class are replayed from
+// the binary message trace in trace_file instead of being drawn from the
+// traffic pattern and injection process. The simulation ends once every
+// message of the trace has been delivered (and replied to).
+class TraceTrafficManager : public TrafficManager {
+
+protected:
+
+  int _trace_class;
+  MessageTrace * _trace;
+
+  virtual int _IssueMessage( int source, int cl );
+  virtual void _NextRequest( int source, int cl, int & dest, int & flits );
+
+  virtual bool _SingleSim( );
+
+public:
+
+  TraceTrafficManager( const Configuration &config, const vector<Network *> & net );
+  virtual ~TraceTrafficManager( );
+
+};
+
+#endif
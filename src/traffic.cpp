@@ -34,6 +34,40 @@
 #include "random_utils.hpp"
 #include "traffic.hpp"
 
+NodeRoleCandidates::NodeRoleCandidates(unsigned char mask, unsigned char want, 
+				       int groups)
+  : _mask(mask), _want(want), _groups(groups), _epoch(-1)
+{
+  assert(_groups > 0);
+}
+
+void NodeRoleCandidates::_Build()
+{
+  _candidates.assign(_groups, vector<int>());
+  for(int n = 0; n < (int)gNodeRoles.size(); ++n) {
+    if((gNodeRoles[n] & _mask) == _want) {
+      _candidates[n % _groups].push_back(n);
+    }
+  }
+  _epoch = gNodeRolesEpoch;
+}
+
+vector<int> const & NodeRoleCandidates::Get(int group)
+{
+  if(_epoch != gNodeRolesEpoch) {
+    _Build();
+  }
+  assert((group >= 0) && (group < _groups));
+  return _candidates[group];
+}
+
+int NodeRoleCandidates::Draw(int group)
+{
+  vector<int> const & candidates = Get(group);
+  assert(!candidates.empty());
+  return candidates[RandomInt(candidates.size() - 1)];
+}
+
 TrafficPattern::TrafficPattern(int nodes)
 : _nodes(nodes)
 {
@@ -464,16 +498,21 @@ UniformRandomInterTrafficPattern::UniformRandomInterTrafficPattern(int nodes)
 int UniformRandomInterTrafficPattern::dest(int source)
 {
   assert((source >= 0) && (source < _nodes));
-  int dest = RandomInt(_nodes - 1);
-  while ((source / gK) == (dest / gK)) {
-    dest = RandomInt(_nodes - 1);
+  // draw among the nodes outside the source's group of gK, then skip over
+  // that group
+  int const first = (source / gK) * gK;
+  int const size = min(gK, _nodes - first);
+  assert(_nodes > size);
+  int dest = RandomInt(_nodes - size - 1);
+  if (dest >= first) {
+    dest += size;
   }
   return dest;
 }
 
 
 NormalRandomTrafficPattern::NormalRandomTrafficPattern(int nodes)
-  : RandomTrafficPattern(nodes)
+  : RandomTrafficPattern(nodes), _memory(NODE_MEMORY, NODE_MEMORY)
 {
 
 }
@@ -485,17 +524,17 @@ int NormalRandomTrafficPattern::dest(int source)
   std::mt19937 gen{rd()};
   std::normal_distribution<> d{32, 8};
 
+  vector<int> const & memory = _memory.Get();
+
   // Normal distribution
   int number = d(gen);
-  while ((number < 0) || (number >= _memory_nodes.size())) {
+  while ((number < 0) || (number >= memory.size())) {
     number = d(gen);
   }
   // cout << "number: " << number << endl;
   // Router offset to get to memory router (clustered)
-  auto it = next(_memory_nodes.begin(), number);
-
-  int dest = *it;
-  assert(_memory_nodes.count(dest));
+  int dest = memory[number];
+  assert(IsMemoryNode(dest));
   // if (dest_router == 15)
     // cout << "dest: " << dest << endl;
   return dest;
@@ -504,23 +543,17 @@ int NormalRandomTrafficPattern::dest(int source)
 
 // THO: Select destination using _active_nodes (UR)
 UniformRandomSelectiveTrafficPattern::UniformRandomSelectiveTrafficPattern(int nodes)
-  : RandomTrafficPattern(nodes)
+  : RandomTrafficPattern(nodes), _memory(NODE_MEMORY, NODE_MEMORY)
 {
 }
 
 int UniformRandomSelectiveTrafficPattern::dest(int source)
 {
   assert((source >= 0) && (source < _nodes));
-  assert(_compute_nodes.count(source));
+  assert(IsComputeNode(source));
   
   // THO: Select destination only from _memory_nodes
-  int rand_dest = RandomInt(_nodes-1);
-  while(_memory_nodes.count(rand_dest) == 0) {
-  // while(_compute_nodes.count(rand_dest) == 0) {
-    rand_dest = RandomInt(_nodes-1);
-  }
-
-  return rand_dest;
+  return _memory.Draw();
 }
 
 // UniformRandomInterRouterTrafficPattern::UniformRandomInterRouterTrafficPattern(int nodes)
@@ -683,7 +716,7 @@ int PermGroupSelectiveTrafficPattern::dest(int source)
 // Unlike randperm, there will be endpoint congestion here
 // *Note: Since compute nodes > memory nodes, there will always be endpoint congestion for requests
 PermRandomSelectiveTrafficPattern::PermRandomSelectiveTrafficPattern(int nodes)
-  : RandomTrafficPattern(nodes)
+  : RandomTrafficPattern(nodes), _non_compute(NODE_COMPUTE, 0)
 {
 }
 
@@ -691,24 +724,15 @@ int PermRandomSelectiveTrafficPattern::dest(int source)
 {
   assert((source >= 0) && (source < _nodes));
   assert((_nodes % gK) == 0);
-  assert(_compute_nodes.count(source));
+  assert(IsComputeNode(source));
 
   if (_dest.empty()) {
     _dest.resize(_nodes);
+    // One draw per node, memory nodes included, whenever the table is
+    // built. Memory nodes never send requests, so their entries are unused.
     for(int src = 0; src < _nodes; src++) {
-      // Memory nodes will not send out requests
-      if(_compute_nodes.count(source) == 0) {
-        _dest[src] = -1;
-      }
-      else {
-        int rand_dest = RandomInt(_nodes-1);
-        // Destination mustn't be compute nodes (must be memory nodes)
-        while(_compute_nodes.count(rand_dest) != 0) {
-
-          rand_dest = RandomInt(_nodes-1);
-        }
-        _dest[src] = rand_dest;
-      }
+      // Destination mustn't be compute nodes (must be memory nodes)
+      _dest[src] = _non_compute.Draw();
     }
   }
 
@@ -738,7 +762,7 @@ int ModuloWorstTrafficPattern::dest(int source)
 
 // THO: Best case for Source and Destination hashing (*All equal nodes*)
 ModuloBestTrafficPattern::ModuloBestTrafficPattern(int nodes)
-  : RandomTrafficPattern(nodes)
+  : RandomTrafficPattern(nodes), _memory(NODE_MEMORY, NODE_MEMORY, gK)
 {
 }
 
@@ -759,11 +783,7 @@ int ModuloBestTrafficPattern::dest(int source)
   // Destination best (Clustered Compute:Memory)
   // Use random to make sure it is balanced for all Memory nodes positions
   // Send to Memory nodes with the same nodes%gK value
-  int dest = RandomInt(_nodes-1);
-  while((_memory_nodes.count(dest) == 0) || ((dest % gK) != (source % gK))) {
-  // while((_memory_nodes.count(dest) == 0) || ((dest % gK) != (source / gK))) {
-    dest = RandomInt(_nodes-1);
-  }
+  int dest = _memory.Draw(source % gK);
 
   // Destination best (Interleaved Compute:Memory) -> does this even exists?
   // Choose destination routers, randomize the interleaved nodes within the router
@@ -782,7 +802,8 @@ int ModuloBestTrafficPattern::dest(int source)
 
 // THO: Hotspot traffic (Evaluate separately Hotspot vs. background)
 UniformRandomHotspotTrafficPattern::UniformRandomHotspotTrafficPattern(int nodes)
-  : RandomTrafficPattern(nodes)
+  : RandomTrafficPattern(nodes), _hotspot(NODE_HS_DEST, NODE_HS_DEST),
+    _background(NODE_HS_DEST, 0)
 {
 }
 
@@ -790,19 +811,15 @@ int UniformRandomHotspotTrafficPattern::dest(int source)
 {
   assert((source >= 0) && (source < _nodes));
   
-  int rand_dest = RandomInt(_nodes-1);
+  int rand_dest;
   // Background (not send to hs_dest)
-  if (!_hs_send_all && _hs_srcs.count(source)==0) {
+  if (!_hs_send_all && !IsHotspotSrc(source)) {
     assert(0);
-    while(_hs_dests.count(rand_dest) != 0) {
-      rand_dest = RandomInt(_nodes-1);
-    }
+    rand_dest = _background.Draw();
   }
   // Hotspot (send to hs_dest)
   else {
-    while(_hs_dests.count(rand_dest) == 0) {
-      rand_dest = RandomInt(_nodes-1);
-    }
+    rand_dest = _hotspot.Draw();
   }
 
   // cout << "[HOTSPOT] Source: " << source << ", Destination: " << rand_dest << endl;
@@ -812,7 +829,7 @@ int UniformRandomHotspotTrafficPattern::dest(int source)
 
 // THO: Hotspot traffic (Evaluate traffics altogether)
 UniformRandomBackgroundTrafficPattern::UniformRandomBackgroundTrafficPattern(int nodes)
-  : RandomTrafficPattern(nodes)
+  : RandomTrafficPattern(nodes), _background(NODE_HS_SRC | NODE_HS_DEST, 0)
 {
 }
 
@@ -820,10 +837,7 @@ int UniformRandomBackgroundTrafficPattern::dest(int source)
 {
   assert((source >= 0) && (source < _nodes));
   
-  int rand_dest = RandomInt(_nodes-1);
-  while(_hs_dests.count(rand_dest) != 0 || _hs_srcs.count(rand_dest) != 0) {
-    rand_dest = RandomInt(_nodes-1);
-  }
+  int rand_dest = _background.Draw();
 
   // cout << "[BACKGROUND] Source: " << source << ", Destination: " << rand_dest << endl;
   return rand_dest;
@@ -852,24 +866,25 @@ int UniformRandomBackgroundTrafficPattern::dest(int source)
 UniformBackgroundTrafficPattern::UniformBackgroundTrafficPattern(int nodes, vector<int> excluded_nodes)
   : RandomTrafficPattern(nodes)
 {
+  vector<bool> excluded(_nodes, false);
   for(size_t i = 0; i < excluded_nodes.size(); ++i) {
     int const node = excluded_nodes[i];
     assert((node >= 0) && (node < _nodes));
-    _excluded.insert(node);
+    excluded[node] = true;
+  }
+  for(int node = 0; node < _nodes; ++node) {
+    if(!excluded[node]) {
+      _included.push_back(node);
+    }
   }
+  assert(!_included.empty());
 }
 
 int UniformBackgroundTrafficPattern::dest(int source)
 {
   assert((source >= 0) && (source < _nodes));
 
-  int result;
-
-  do {
-    result = RandomInt(_nodes - 1);
-  } while(_excluded.count(result) > 0);
-
-  return result;
+  return _included[RandomInt(_included.size() - 1)];
 }
 
 DiagonalTrafficPattern::DiagonalTrafficPattern(int nodes)
@@ -980,6 +995,13 @@ HotSpotTrafficPattern::HotSpotTrafficPattern(int nodes, vector<int> hotspots,
     assert(rate > 0);
     _max_val += rate;
   }
+  // map every value of the rate draw straight to its hotspot unless the
+  // rates add up to something unreasonably large
+  if(_max_val < 65536) {
+    for(size_t i = 0; i < size; ++i) {
+      _lookup.insert(_lookup.end(), _rates[i], i);
+    }
+  }
 }
 
 int HotSpotTrafficPattern::dest(int source)
@@ -992,6 +1014,10 @@ int HotSpotTrafficPattern::dest(int source)
 
   int pct = RandomInt(_max_val);
 
+  if(!_lookup.empty()) {
+    return _hotspots[_lookup[pct]];
+  }
+
   for(size_t i = 0; i < (_hotspots.size() - 1); ++i) {
     int const limit = _rates[i];
     if(limit > pct) {
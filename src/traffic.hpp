@@ -37,6 +37,23 @@
 
 using namespace std;
 
+// Nodes whose role flags (see globals.hpp) satisfy (role & mask) == want,
+// optionally split into groups by node % groups. They are kept in dense
+// arrays, rebuilt whenever the node roles change, so that drawing one
+// uniformly is a single RandomInt and array load.
+class NodeRoleCandidates {
+  unsigned char _mask;
+  unsigned char _want;
+  int _groups;
+  int _epoch;
+  vector<vector<int> > _candidates;
+  void _Build();
+public:
+  NodeRoleCandidates(unsigned char mask, unsigned char want, int groups = 1);
+  vector<int> const & Get(int group = 0);
+  int Draw(int group = 0);
+};
+
 class TrafficPattern {
 protected:
   int _nodes;
@@ -132,6 +149,8 @@ public:
 };
 
 class NormalRandomTrafficPattern : public RandomTrafficPattern {
+private:
+  NodeRoleCandidates _memory;
 public:
   NormalRandomTrafficPattern(int nodes);
   virtual int dest(int source);
@@ -140,6 +159,8 @@ public:
 
 
 class UniformRandomSelectiveTrafficPattern : public RandomTrafficPattern {
+private:
+  NodeRoleCandidates _memory;
 public:
   UniformRandomSelectiveTrafficPattern(int nodes);
   virtual int dest(int source);
@@ -185,6 +206,7 @@ public:
 class PermRandomSelectiveTrafficPattern : public RandomTrafficPattern {
 private:
   vector<int> _dest;
+  NodeRoleCandidates _non_compute;
 public:
   PermRandomSelectiveTrafficPattern(int nodes);
   virtual int dest(int source);
@@ -205,6 +227,9 @@ public:
 
 // THO: Hotspot traffic (Hotspot)
 class UniformRandomHotspotTrafficPattern : public RandomTrafficPattern {
+private:
+  NodeRoleCandidates _hotspot;
+  NodeRoleCandidates _background;
 public:
   UniformRandomHotspotTrafficPattern(int nodes);
   virtual int dest(int source);
@@ -212,6 +237,8 @@ public:
 
 // THO: Hotspot traffic (Background UR)
 class UniformRandomBackgroundTrafficPattern : public RandomTrafficPattern {
+private:
+  NodeRoleCandidates _background;
 public:
   UniformRandomBackgroundTrafficPattern(int nodes);
   virtual int dest(int source);
@@ -224,6 +251,8 @@ public:
 };
 
 class ModuloBestTrafficPattern : public RandomTrafficPattern {
+private:
+  NodeRoleCandidates _memory; // grouped by node % gK
 public:
   ModuloBestTrafficPattern(int nodes);
   virtual int dest(int source);
@@ -238,7 +267,7 @@ public:
 
 class UniformBackgroundTrafficPattern : public RandomTrafficPattern {
 private:
-  set<int> _excluded;
+  vector<int> _included;
 public:
   UniformBackgroundTrafficPattern(int nodes, vector<int> excluded_nodes);
   virtual int dest(int source);
@@ -292,6 +321,8 @@ private:
   vector<int> _hotspots;
   vector<int> _rates;
   int _max_val;
+  // hotspot index for each value of the rate draw, if small enough
+  vector<int> _lookup;
 public:
   HotSpotTrafficPattern(int nodes, vector<int> hotspots, 
 			vector<int> rates = vector<int>());
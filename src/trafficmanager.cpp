@@ -26,19 +26,31 @@
 */
 
 #include <sstream>
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <limits>
 #include <cstdlib>
 #include <ctime>
+#include <sys/time.h>
+#include <unistd.h>
 
 #include "booksim.hpp"
 #include "booksim_config.hpp"
 #include "trafficmanager.hpp"
 #include "batchtrafficmanager.hpp"
+#include "tracetrafficmanager.hpp"
+#include "collectivetrafficmanager.hpp"
 #include "random_utils.hpp" 
 #include "vc.hpp"
 #include "packet_reply_info.hpp"
+#include "profiler.hpp"
+#include "event_trace.hpp"
+#include "endpoint.hpp"
+#include "results_writer.hpp"
+#include "snapshot_stream.hpp"
+#include "telemetry_server.hpp"
+#include "deadlock_detector.hpp"
 
 #include "batchtrafficmanager.hpp"
 
@@ -52,6 +64,12 @@ TrafficManager * TrafficManager::New(Configuration const & config,
     } else if(sim_type == "batch") {
         result = new BatchTrafficManager(config, net);
         cout << "Simulation mode: Batch" << endl;
+    } else if(sim_type == "trace") {
+        result = new TraceTrafficManager(config, net);
+        cout << "Simulation mode: Trace" << endl;
+    } else if(sim_type == "collective") {
+        result = new CollectiveTrafficManager(config, net);
+        cout << "Simulation mode: Collective" << endl;
     } else {
         cerr << "Unknown simulation type: " << sim_type << endl;
     } 
@@ -59,7 +77,7 @@ TrafficManager * TrafficManager::New(Configuration const & config,
 }
 
 TrafficManager::TrafficManager( const Configuration &config, const vector<Network *> & net )
-    : Module( 0, "traffic_manager" ), _net(net), _empty_network(false), _deadlock_timer(0), _reset_time(0), _drain_time(-1), _cur_id(0), _cur_pid(0), _time(0)
+    : Module( 0, "traffic_manager" ), _cur_mid(0), _net(net), _empty_network(false), _deadlock_timer(0), _reset_time(0), _drain_time(-1), _cur_id(0), _cur_pid(0), _time(0)
 {
 
     _nodes = _net[0]->NumNodes( );
@@ -312,28 +330,32 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         }
     }
 
-#ifdef TRACK_FLOWS
-    _outstanding_credits.resize(_classes);
-    for(int c = 0; c < _classes; ++c) {
-        _outstanding_credits[c].resize(_subnets, vector<int>(_nodes, 0));
-    }
-    _outstanding_classes.resize(_nodes);
-    for(int n = 0; n < _nodes; ++n) {
-        _outstanding_classes[n].resize(_subnets, vector<queue<int> >(_vcs));
+    if(gTrackFlows) {
+        _outstanding_credits.resize(_classes);
+        for(int c = 0; c < _classes; ++c) {
+            _outstanding_credits[c].resize(_subnets, vector<int>(_nodes, 0));
+        }
+        _outstanding_classes.resize(_nodes);
+        for(int n = 0; n < _nodes; ++n) {
+            _outstanding_classes[n].resize(_subnets, vector<queue<int> >(_vcs));
+        }
     }
-#endif
 
     // ============ Injection queues ============ 
 
     _qtime.resize(_nodes);
     _qdrained.resize(_nodes);
     _partial_packets.resize(_nodes);
+    _queued_messages.resize(_nodes);
 
     for ( int s = 0; s < _nodes; ++s ) {
         _qtime[s].resize(_classes);
         _qdrained[s].resize(_classes);
         _partial_packets[s].resize(_classes);
+        _queued_messages[s].resize(_classes);
     }
+    _queued_flits.resize(_classes, 0);
+    _queued_measured_flits.resize(_classes, 0);
 
     _total_in_flight_flits.resize(_classes);
     _measured_in_flight_flits.resize(_classes);
@@ -344,6 +366,19 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _repliesPending.resize(_nodes);
     _requestsOutstanding.resize(_nodes);
 
+    string const endpoint_model = config.GetStr("endpoint_model");
+    _endpoint = (endpoint_model == "ideal") ? NULL : 
+        EndpointModel::New(endpoint_model, _nodes, &config);
+    _held_credits.resize(_nodes, vector<vector<int> >(_subnets, vector<int>(_vcs, 0)));
+    _held_credit_count.resize(_nodes, 0);
+    _held_request_flits = 0;
+    _held_requests.resize(_nodes);
+    _held_request_count = 0;
+    _endpoint_queue_stats = new Stats( this, "endpoint_queue", 1.0, 1000 );
+    _stats["endpoint_queue"] = _endpoint_queue_stats;
+    _overall_avg_endpoint_queue = 0.0;
+    _overall_max_endpoint_queue = 0.0;
+
     _hold_switch_for_packet = config.GetInt("hold_switch_for_packet");
 
     // ============ Simulation parameters ============ 
@@ -414,6 +449,15 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
 
     _print_csv_results = config.GetInt( "print_csv_results" );
     _deadlock_warn_timeout = config.GetInt( "deadlock_warn_timeout" );
+    _deadlock_detector = NULL;
+    _deadlocked = false;
+    if(config.GetInt( "deadlock_abort" ) > 0) {
+        _deadlock_detector = new DeadlockDetector(_net, config.GetInt( "num_vcs" ));
+        if(!_deadlock_detector->Supported()) {
+            delete _deadlock_detector;
+            _deadlock_detector = NULL;
+        }
+    }
 
     string watch_file = config.GetStr( "watch_file" );
     if((watch_file != "") && (watch_file != "-")) {
@@ -439,74 +483,77 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _stats_out = new ofstream(stats_out_file.c_str());
         config.WriteMatlabFile(_stats_out);
     }
-  
-#ifdef TRACK_FLOWS
-    _injected_flits.resize(_classes, vector<int>(_nodes, 0));
-    _ejected_flits.resize(_classes, vector<int>(_nodes, 0));
-    string injected_flits_out_file = config.GetStr( "injected_flits_out" );
-    if(injected_flits_out_file == "") {
-        _injected_flits_out = NULL;
-    } else {
-        _injected_flits_out = new ofstream(injected_flits_out_file.c_str());
-    }
-    string received_flits_out_file = config.GetStr( "received_flits_out" );
-    if(received_flits_out_file == "") {
-        _received_flits_out = NULL;
-    } else {
-        _received_flits_out = new ofstream(received_flits_out_file.c_str());
-    }
-    string stored_flits_out_file = config.GetStr( "stored_flits_out" );
-    if(stored_flits_out_file == "") {
-        _stored_flits_out = NULL;
-    } else {
-        _stored_flits_out = new ofstream(stored_flits_out_file.c_str());
-    }
-    string sent_flits_out_file = config.GetStr( "sent_flits_out" );
-    if(sent_flits_out_file == "") {
-        _sent_flits_out = NULL;
-    } else {
-        _sent_flits_out = new ofstream(sent_flits_out_file.c_str());
-    }
-    string outstanding_credits_out_file = config.GetStr( "outstanding_credits_out" );
-    if(outstanding_credits_out_file == "") {
-        _outstanding_credits_out = NULL;
-    } else {
-        _outstanding_credits_out = new ofstream(outstanding_credits_out_file.c_str());
-    }
-    string ejected_flits_out_file = config.GetStr( "ejected_flits_out" );
-    if(ejected_flits_out_file == "") {
-        _ejected_flits_out = NULL;
-    } else {
-        _ejected_flits_out = new ofstream(ejected_flits_out_file.c_str());
-    }
-    string active_packets_out_file = config.GetStr( "active_packets_out" );
-    if(active_packets_out_file == "") {
-        _active_packets_out = NULL;
-    } else {
-        _active_packets_out = new ofstream(active_packets_out_file.c_str());
-    }
-#endif
 
-#ifdef TRACK_CREDITS
-    string used_credits_out_file = config.GetStr( "used_credits_out" );
-    if(used_credits_out_file == "") {
-        _used_credits_out = NULL;
-    } else {
-        _used_credits_out = new ofstream(used_credits_out_file.c_str());
+    string results_out_file = config.GetStr( "results_out" );
+    _results = results_out_file.empty() ? NULL : new ResultsWriter(results_out_file);
+    _cur_sim = 0;
+
+    string telemetry_socket = config.GetStr( "telemetry_socket" );
+    _telemetry = telemetry_socket.empty() ? NULL : new TelemetryServer(telemetry_socket);
+    _telemetry_interval = config.GetInt( "telemetry_interval" );
+    if(_telemetry && (_telemetry_interval <= 0)) {
+        Error("telemetry_interval must be greater than zero.");
     }
-    string free_credits_out_file = config.GetStr( "free_credits_out" );
-    if(free_credits_out_file == "") {
-        _free_credits_out = NULL;
-    } else {
-        _free_credits_out = new ofstream(free_credits_out_file.c_str());
+    _telemetry_cycle = 0;
+    _telemetry_wall = 0.0;
+  
+    _injected_flits_out = NULL;
+    _received_flits_out = NULL;
+    _stored_flits_out = NULL;
+    _sent_flits_out = NULL;
+    _outstanding_credits_out = NULL;
+    _ejected_flits_out = NULL;
+    _active_packets_out = NULL;
+    if(gTrackFlows) {
+        _injected_flits.resize(_classes, vector<int>(_nodes, 0));
+        _ejected_flits.resize(_classes, vector<int>(_nodes, 0));
+        string injected_flits_out_file = config.GetStr( "injected_flits_out" );
+        if(injected_flits_out_file != "") {
+            _injected_flits_out = new ofstream(injected_flits_out_file.c_str());
+        }
+        string received_flits_out_file = config.GetStr( "received_flits_out" );
+        if(received_flits_out_file != "") {
+            _received_flits_out = new ofstream(received_flits_out_file.c_str());
+        }
+        string stored_flits_out_file = config.GetStr( "stored_flits_out" );
+        if(stored_flits_out_file != "") {
+            _stored_flits_out = new ofstream(stored_flits_out_file.c_str());
+        }
+        string sent_flits_out_file = config.GetStr( "sent_flits_out" );
+        if(sent_flits_out_file != "") {
+            _sent_flits_out = new ofstream(sent_flits_out_file.c_str());
+        }
+        string outstanding_credits_out_file = config.GetStr( "outstanding_credits_out" );
+        if(outstanding_credits_out_file != "") {
+            _outstanding_credits_out = new ofstream(outstanding_credits_out_file.c_str());
+        }
+        string ejected_flits_out_file = config.GetStr( "ejected_flits_out" );
+        if(ejected_flits_out_file != "") {
+            _ejected_flits_out = new ofstream(ejected_flits_out_file.c_str());
+        }
+        string active_packets_out_file = config.GetStr( "active_packets_out" );
+        if(active_packets_out_file != "") {
+            _active_packets_out = new ofstream(active_packets_out_file.c_str());
+        }
     }
-    string max_credits_out_file = config.GetStr( "max_credits_out" );
-    if(max_credits_out_file == "") {
-        _max_credits_out = NULL;
-    } else {
-        _max_credits_out = new ofstream(max_credits_out_file.c_str());
+
+    _used_credits_out = NULL;
+    _free_credits_out = NULL;
+    _max_credits_out = NULL;
+    if(gTrackCredits) {
+        string used_credits_out_file = config.GetStr( "used_credits_out" );
+        if(used_credits_out_file != "") {
+            _used_credits_out = new ofstream(used_credits_out_file.c_str());
+        }
+        string free_credits_out_file = config.GetStr( "free_credits_out" );
+        if(free_credits_out_file != "") {
+            _free_credits_out = new ofstream(free_credits_out_file.c_str());
+        }
+        string max_credits_out_file = config.GetStr( "max_credits_out" );
+        if(max_credits_out_file != "") {
+            _max_credits_out = new ofstream(max_credits_out_file.c_str());
+        }
     }
-#endif
 
     // ============ Statistics ============ 
 
@@ -576,27 +623,27 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _overall_avg_write_rlat.resize(_classes, 0.0);
     _overall_max_write_rlat.resize(_classes, 0.0);
 
-#ifdef WAIT_TIME
-    _ewlat_stats.resize(_classes);
-    _overall_min_ewlat.resize(_classes, 0.0);
-    _overall_avg_ewlat.resize(_classes, 0.0);
-    _overall_max_ewlat.resize(_classes, 0.0);
-
-    _service_stats.resize(_classes);
-    _overall_min_service.resize(_classes, 0.0);
-    _overall_avg_service.resize(_classes, 0.0);
-    _overall_max_service.resize(_classes, 0.0);
-
-    _upservice_stats.resize(_classes);
-    _overall_min_upservice.resize(_classes, 0.0);
-    _overall_avg_upservice.resize(_classes, 0.0);
-    _overall_max_upservice.resize(_classes, 0.0);
-
-    _downservice_stats.resize(_classes);
-    _overall_min_downservice.resize(_classes, 0.0);
-    _overall_avg_downservice.resize(_classes, 0.0);
-    _overall_max_downservice.resize(_classes, 0.0);
-#endif
+    if(gTrackWaitTime) {
+        _ewlat_stats.resize(_classes);
+        _overall_min_ewlat.resize(_classes, 0.0);
+        _overall_avg_ewlat.resize(_classes, 0.0);
+        _overall_max_ewlat.resize(_classes, 0.0);
+
+        _service_stats.resize(_classes);
+        _overall_min_service.resize(_classes, 0.0);
+        _overall_avg_service.resize(_classes, 0.0);
+        _overall_max_service.resize(_classes, 0.0);
+
+        _upservice_stats.resize(_classes);
+        _overall_min_upservice.resize(_classes, 0.0);
+        _overall_avg_upservice.resize(_classes, 0.0);
+        _overall_max_upservice.resize(_classes, 0.0);
+
+        _downservice_stats.resize(_classes);
+        _overall_min_downservice.resize(_classes, 0.0);
+        _overall_avg_downservice.resize(_classes, 0.0);
+        _overall_max_downservice.resize(_classes, 0.0);
+    }
 
 
     if(_pair_stats){
@@ -626,26 +673,18 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _overall_avg_accepted.resize(_classes, 0.0);
     _overall_max_accepted.resize(_classes, 0.0);
 
-#ifdef TRACK_STALLS
-    _buffer_busy_stalls.resize(_classes);
-    _buffer_conflict_stalls.resize(_classes);
-    _buffer_full_stalls.resize(_classes);
-    _buffer_reserved_stalls.resize(_classes);
-    _crossbar_conflict_stalls.resize(_classes);
-    _overall_buffer_busy_stalls.resize(_classes, 0);
-    _overall_buffer_conflict_stalls.resize(_classes, 0);
-    _overall_buffer_full_stalls.resize(_classes, 0);
-    _overall_buffer_reserved_stalls.resize(_classes, 0);
-    _overall_crossbar_conflict_stalls.resize(_classes, 0);
-#endif
-
-#ifdef CHAN_UTILS
-    _chanutil_stats.resize(_subnets);
-    _chanutil_freq_stats.resize(_subnets);
-    _overall_min_chanutil.resize(_subnets);
-    _overall_avg_chanutil.resize(_subnets);
-    _overall_max_chanutil.resize(_subnets);
-#endif
+    if(gTrackStalls) {
+        _buffer_busy_stalls.resize(_classes);
+        _buffer_conflict_stalls.resize(_classes);
+        _buffer_full_stalls.resize(_classes);
+        _buffer_reserved_stalls.resize(_classes);
+        _crossbar_conflict_stalls.resize(_classes);
+        _overall_buffer_busy_stalls.resize(_classes, 0);
+        _overall_buffer_conflict_stalls.resize(_classes, 0);
+        _overall_buffer_full_stalls.resize(_classes, 0);
+        _overall_buffer_reserved_stalls.resize(_classes, 0);
+        _overall_crossbar_conflict_stalls.resize(_classes, 0);
+    }
 
     for ( int c = 0; c < _classes; ++c ) {
         ostringstream tmp_name;
@@ -722,27 +761,27 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _stats[tmp_name.str()] = _write_rlat_stats[c];
         tmp_name.str("");
 
-#ifdef WAIT_TIME
-        tmp_name << "ewlat_stat_" << c;
-        _ewlat_stats[c] = new Stats( this, tmp_name.str( ), 1.0, 1000 );
-        _stats[tmp_name.str()] = _ewlat_stats[c];
-        tmp_name.str("");
+        if(gTrackWaitTime) {
+            tmp_name << "ewlat_stat_" << c;
+            _ewlat_stats[c] = new Stats( this, tmp_name.str( ), 1.0, 1000 );
+            _stats[tmp_name.str()] = _ewlat_stats[c];
+            tmp_name.str("");
 
-        tmp_name << "service_stat_" << c;
-        _service_stats[c] = new Stats( this, tmp_name.str( ), 1.0, 1000 );
-        _stats[tmp_name.str()] = _service_stats[c];
-        tmp_name.str("");
+            tmp_name << "service_stat_" << c;
+            _service_stats[c] = new Stats( this, tmp_name.str( ), 1.0, 1000 );
+            _stats[tmp_name.str()] = _service_stats[c];
+            tmp_name.str("");
 
-        tmp_name << "upservice_stat_" << c;
-        _upservice_stats[c] = new Stats( this, tmp_name.str( ), 1.0, 1000 );
-        _stats[tmp_name.str()] = _upservice_stats[c];
-        tmp_name.str("");
+            tmp_name << "upservice_stat_" << c;
+            _upservice_stats[c] = new Stats( this, tmp_name.str( ), 1.0, 1000 );
+            _stats[tmp_name.str()] = _upservice_stats[c];
+            tmp_name.str("");
 
-        tmp_name << "downservice_stat_" << c;
-        _downservice_stats[c] = new Stats( this, tmp_name.str( ), 1.0, 1000 );
-        _stats[tmp_name.str()] = _downservice_stats[c];
-        tmp_name.str("");
-#endif
+            tmp_name << "downservice_stat_" << c;
+            _downservice_stats[c] = new Stats( this, tmp_name.str( ), 1.0, 1000 );
+            _stats[tmp_name.str()] = _downservice_stats[c];
+            tmp_name.str("");
+        }
 
         if(_pair_stats){
             _pair_plat[c].resize(_nodes*_nodes);
@@ -755,13 +794,13 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _sent_flits[c].resize(_nodes, 0);
         _accepted_flits[c].resize(_nodes, 0);
 
-#ifdef TRACK_STALLS
-        _buffer_busy_stalls[c].resize(_subnets*_routers, 0);
-        _buffer_conflict_stalls[c].resize(_subnets*_routers, 0);
-        _buffer_full_stalls[c].resize(_subnets*_routers, 0);
-        _buffer_reserved_stalls[c].resize(_subnets*_routers, 0);
-        _crossbar_conflict_stalls[c].resize(_subnets*_routers, 0);
-#endif
+        if(gTrackStalls) {
+            _buffer_busy_stalls[c].resize(_subnets*_routers, 0);
+            _buffer_conflict_stalls[c].resize(_subnets*_routers, 0);
+            _buffer_full_stalls[c].resize(_subnets*_routers, 0);
+            _buffer_reserved_stalls[c].resize(_subnets*_routers, 0);
+            _crossbar_conflict_stalls[c].resize(_subnets*_routers, 0);
+        }
         if(_pair_stats){
             for ( int i = 0; i < _nodes; ++i ) {
                 for ( int j = 0; j < _nodes; ++j ) {
@@ -785,29 +824,55 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
 
     }
 
-#ifdef CHAN_UTILS
-    for (int s = 0; s < _subnets; s++) {
-        _chanutil_stats[s].resize(_num_channels);
-        _chanutil_freq_stats[s].resize(_num_channels);
-        _overall_min_chanutil[s].resize(_num_channels, 0.0);
-        _overall_avg_chanutil[s].resize(_num_channels, 0.0);
-        _overall_max_chanutil[s].resize(_num_channels, 0.0);
-
-        ostringstream tmp_name;
-
-        for (int i = 0; i < _num_channels; i++){
-            tmp_name << "chanutil_stat_" << s << "_" << i;
-            _chanutil_stats[s][i] = new Stats( this, tmp_name.str( ), 1.0, 1000 );
-            _stats[tmp_name.str()] = _chanutil_stats[s][i];
-            tmp_name.str("");
-
-            tmp_name << "chanutil_freq_stat_" << s << "_" << i;
-            _chanutil_freq_stats[s][i] = new Stats( this, tmp_name.str( ), 1.0, 1000 );
-            _stats[tmp_name.str()] = _chanutil_freq_stats[s][i];
-            tmp_name.str("");
+    if(gTrackChanUtils) {
+        _chanutil_chans.resize(_subnets);
+        _chanutil_mark.resize(_subnets);
+        _chanutil_min.resize(_subnets);
+        _chanutil_sum.resize(_subnets);
+        _chanutil_max.resize(_subnets);
+        _overall_min_chanutil.resize(_subnets);
+        _overall_avg_chanutil.resize(_subnets);
+        _overall_max_chanutil.resize(_subnets);
+        for (int s = 0; s < _subnets; ++s) {
+            // every connected flit channel: injection, router-to-router, ejection
+            vector<FlitChannel *> const * const groups[] = {
+                &_net[s]->GetInject(), &_net[s]->GetChannels(), &_net[s]->GetEject()
+            };
+            for (int g = 0; g < 3; ++g) {
+                for (size_t i = 0; i < groups[g]->size(); ++i) {
+                    FlitChannel * const chan = (*groups[g])[i];
+                    if (chan->GetSource() || chan->GetSink()) {
+                        _chanutil_chans[s].push_back(chan);
+                    }
+                }
+            }
+            int const links = _chanutil_chans[s].size();
+            _chanutil_mark[s].resize(links, 0);
+            _chanutil_min[s].resize(links, 0.0);
+            _chanutil_sum[s].resize(links, 0.0);
+            _chanutil_max[s].resize(links, 0.0);
+            _overall_min_chanutil[s].resize(links, 0.0);
+            _overall_avg_chanutil[s].resize(links, 0.0);
+            _overall_max_chanutil[s].resize(links, 0.0);
+        }
+    }
+    _chanutil_mark_time = 0;
+    _chanutil_windows = 0;
+
+    _chanutil_top = config.GetInt("chan_util_top");
+    string chanutil_out_file = config.GetStr( "chan_util_out" );
+    if(!gTrackChanUtils || (chanutil_out_file == "")) {
+        _chanutil_out = NULL;
+    } else {
+        _chanutil_out = new ofstream(chanutil_out_file.c_str());
+        *_chanutil_out << "time";
+        for (int s = 0; s < _subnets; ++s) {
+            for (size_t i = 0; i < _chanutil_chans[s].size(); ++i) {
+                *_chanutil_out << ',' << _chanutil_chans[s][i]->Name();
+            }
         }
+        *_chanutil_out << endl;
     }
-#endif
 
     // HANS: Additionals for reordering
     _reordering_vect.resize(_nodes);
@@ -834,6 +899,12 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     }
 
     _reordering_vect_maxsize = 0;
+    _rob_occupancy.resize(_nodes, 0);
+
+    string snapshot_out_file = config.GetStr( "snapshot_out" );
+    _snapshot = snapshot_out_file.empty() ? NULL : 
+        new SnapshotStream(snapshot_out_file, config.GetInt("snapshot_interval"),
+                           config.GetInt("snapshot_buffer"), _net, _nodes);
 
     _slowest_flit.resize(_classes, -1);
     _slowest_packet.resize(_classes, -1);
@@ -971,6 +1042,7 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         cout << *i << " ";
     }
     cout << endl;
+    UpdateNodeRoles(_nodes);
 
     // // Error links, cannot route using these links
     // // set<int> faulty_links;
@@ -1033,12 +1105,12 @@ TrafficManager::~TrafficManager( )
         delete _read_rlat_stats[c];
         delete _write_rlat_stats[c];
 
-#ifdef WAIT_TIME
-        delete _ewlat_stats[c];
-        delete _service_stats[c];
-        delete _upservice_stats[c];
-        delete _downservice_stats[c];
-#endif
+        if(gTrackWaitTime) {
+            delete _ewlat_stats[c];
+            delete _service_stats[c];
+            delete _upservice_stats[c];
+            delete _downservice_stats[c];
+        }
 
         delete _traffic_pattern[c];
         delete _traffic_pattern_transient[c];
@@ -1054,19 +1126,14 @@ TrafficManager::~TrafficManager( )
         }
     }
 
-#ifdef CHAN_UTILS
-    for (int s = 0; s < _subnets; s++) {
-        for (int i = 0; i < _num_channels; i++) {
-            delete _chanutil_stats[s][i];
-            delete _chanutil_freq_stats[s][i];
-        }
-    }
-#endif
+    if(_chanutil_out) delete _chanutil_out;
   
-    if(gWatchOut && (gWatchOut != &cout)) delete gWatchOut;
     if(_stats_out && (_stats_out != &cout)) delete _stats_out;
+    if(_results) delete _results;
+    if(_snapshot) delete _snapshot;
+    if(_telemetry) delete _telemetry;
+    if(_deadlock_detector) delete _deadlock_detector;
 
-#ifdef TRACK_FLOWS
     if(_injected_flits_out) delete _injected_flits_out;
     if(_received_flits_out) delete _received_flits_out;
     if(_stored_flits_out) delete _stored_flits_out;
@@ -1074,13 +1141,13 @@ TrafficManager::~TrafficManager( )
     if(_outstanding_credits_out) delete _outstanding_credits_out;
     if(_ejected_flits_out) delete _ejected_flits_out;
     if(_active_packets_out) delete _active_packets_out;
-#endif
 
-#ifdef TRACK_CREDITS
     if(_used_credits_out) delete _used_credits_out;
     if(_free_credits_out) delete _free_credits_out;
     if(_max_credits_out) delete _max_credits_out;
-#endif
+
+    if(_endpoint) delete _endpoint;
+    delete _endpoint_queue_stats;
 
     PacketReplyInfo::FreeAll();
     Flit::FreeAll();
@@ -1090,6 +1157,7 @@ TrafficManager::~TrafficManager( )
 
 void TrafficManager::_RetireFlit( Flit *f, int dest )
 {
+    PROFILE_SCOPE("TrafficManager::_RetireFlit");
     _deadlock_timer = 0;
 
     assert(_total_in_flight_flits[f->cl].count(f->id) > 0);
@@ -1112,6 +1180,10 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
                    << ")." << endl;
     }
 
+    if(gEventTrace) {
+        gEventTrace->Record(EventTrace::RETIRE, f, dest);
+    }
+
     if ( f->head && ( f->dest != dest ) ) {
         ostringstream err;
         err << "Flit " << f->id << " arrived at incorrect output " << dest;
@@ -1125,17 +1197,17 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
         _pair_flat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - f->itime );
     }
 
-#ifdef WAIT_TIME
-    if (f->head){
-        _ewlat_stats[f->cl]->AddSample( f->ewtime );
+    if(gTrackWaitTime) {
+        if (f->head){
+            _ewlat_stats[f->cl]->AddSample( f->Timing().ewtime );
 
-        if((_longest_service_time[f->cl] < 0) || (_service_stats[f->cl]->Max() < (f->service_time)))
-            _longest_service_time[f->cl] = f->id;
-        _service_stats[f->cl]->AddSample( f->service_time );
-        _upservice_stats[f->cl]->AddSample( f->service_uptime );
-        _downservice_stats[f->cl]->AddSample( f->service_downtime );
+            if((_longest_service_time[f->cl] < 0) || (_service_stats[f->cl]->Max() < (f->Timing().service_time)))
+                _longest_service_time[f->cl] = f->id;
+            _service_stats[f->cl]->AddSample( f->Timing().service_time );
+            _upservice_stats[f->cl]->AddSample( f->Timing().service_uptime );
+            _downservice_stats[f->cl]->AddSample( f->Timing().service_downtime );
+        }
     }
-#endif
 
     // HANS: Additionals for recording reordering latency
     // Packet latency does not include the reordering latency
@@ -1193,7 +1265,17 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
             rinfo->time = f->atime;
             rinfo->record = f->record;
             rinfo->type = f->type;
-            _repliesPending[dest].push_back(rinfo);
+            if(_endpoint) {
+                if(_endpoint->Full(dest) || !_held_requests[dest].empty()) {
+                    _held_requests[dest].push_back(rinfo);
+                    ++_held_request_count;
+                } else {
+                    _endpoint_queue_stats->AddSample(_endpoint->Occupancy(dest));
+                    _endpoint->Arrive(dest, rinfo, _time);
+                }
+            } else {
+                _repliesPending[dest].push_back(rinfo);
+            }
         } else {
             if(f->type == Flit::READ_REPLY || f->type == Flit::WRITE_REPLY  ){
                 _requestsOutstanding[dest]--;
@@ -1261,7 +1343,7 @@ int TrafficManager::_IssueMessage( int source, int cl )
       
             // produce a message
             // THO: Active and hotspot
-            if ((_compute_nodes.count(source) > 0) && !_hs_dests.count(source)) {
+            if (IsComputeNode(source) && !IsHotspotDest(source)) {
                 if(_injection_process[cl]->test(source)) {
         
                     //coin toss to determine request type.
@@ -1273,7 +1355,7 @@ int TrafficManager::_IssueMessage( int source, int cl )
         }
     } else { //normal mode
         // THO: Active and hotspot
-        if ((_compute_nodes.count(source) > 0) && !_hs_dests.count(source)) {
+        if (IsComputeNode(source) && !IsHotspotDest(source)) {
             result = _injection_process[cl]->test(source) ? 1 : 0;
             _requestsOutstanding[source]++;
         }
@@ -1288,12 +1370,13 @@ int TrafficManager::_IssueMessage( int source, int cl )
 
 
 void TrafficManager::_Inject(){
+    PROFILE_SCOPE("TrafficManager::_Inject");
 
     for ( int input = 0; input < _nodes; ++input ) {
         for ( int c = 0; c < _classes; ++c ) {
             // Potentially generate packets for any (input,class)
             // that is currently empty
-            if ( _partial_packets[input][c].empty() ) {
+            if ( _SourceIdle(input, c) ) {
                 bool generated = false;
                 while( !generated && ( _qtime[input][c] <= _time ) ) {
                     int stype = _IssueMessage( input, c );
@@ -1321,13 +1404,19 @@ void TrafficManager::_Inject(){
 
 void TrafficManager::_Step( )
 {
+    PROFILE_SCOPE("TrafficManager::_Step");
     bool flits_in_flight = false;
     for(int c = 0; c < _classes; ++c) {
-        flits_in_flight |= !_total_in_flight_flits[c].empty();
+        flits_in_flight |= (_InFlightFlits(c) > 0);
     }
     if(flits_in_flight && (_deadlock_timer++ >= _deadlock_warn_timeout)){
         _deadlock_timer = 0;
         cout << "WARNING: Possible network deadlock.\n";
+        if(_deadlock_detector && _deadlock_detector->Check(cout)) {
+            cout << "Network deadlock; aborting the simulation." << endl;
+            _deadlocked = true;
+            return;
+        }
     }
 
     if ((_transient_time > 0) && (GetSimTime() == _transient_time)) {
@@ -1354,6 +1443,7 @@ void TrafficManager::_Step( )
         _memory_nodes  = trans_mem;
         cout << "Compute size: " << _compute_nodes.size() << ", memory size: " << _memory_nodes.size() << endl; 
         assert((_compute_nodes.size() + _memory_nodes.size()) == _nodes);
+        UpdateNodeRoles(_nodes);
     }
 
     vector<map<int, Flit *> > flits(_subnets);
@@ -1370,6 +1460,9 @@ void TrafficManager::_Step( )
                                << " from VC " << f->vc
                                << "." << endl;
                 }
+                if(gEventTrace) {
+                    gEventTrace->Record(EventTrace::EJECT, f, n);
+                }
                 flits[subnet].insert(make_pair(n, f));
                 if((_sim_state == warming_up) || (_sim_state == running)) {
                     ++_accepted_flits[f->cl][n];
@@ -1381,16 +1474,16 @@ void TrafficManager::_Step( )
 
             Credit * const c = _net[subnet]->ReadCredit( n );
             if ( c ) {
-#ifdef TRACK_FLOWS
-                for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
-                    int const vc = *iter;
-                    assert(!_outstanding_classes[n][subnet][vc].empty());
-                    int cl = _outstanding_classes[n][subnet][vc].front();
-                    _outstanding_classes[n][subnet][vc].pop();
-                    assert(_outstanding_credits[cl][subnet][n] > 0);
-                    --_outstanding_credits[cl][subnet][n];
+                if(gTrackFlows) {
+                    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+                        int const vc = *iter;
+                        assert(!_outstanding_classes[n][subnet][vc].empty());
+                        int cl = _outstanding_classes[n][subnet][vc].front();
+                        _outstanding_classes[n][subnet][vc].pop();
+                        assert(_outstanding_credits[cl][subnet][n] > 0);
+                        --_outstanding_credits[cl][subnet][n];
+                    }
                 }
-#endif
                 _buf_states[n][subnet]->ProcessCredit(c);
                 c->Free();
             }
@@ -1398,10 +1491,26 @@ void TrafficManager::_Step( )
         _net[subnet]->ReadInputs( );
     }
   
+    if(_endpoint) {
+        _endpoint->Step(_time, _repliesPending);
+        if(_held_request_count > 0) {
+            _AdmitHeldRequests();
+        }
+    }
+
     if ( !_empty_network ) {
         _Inject();
     }
 
+    for(int n = 0; n < _nodes; ++n) {
+        for(int c = 0; c < _classes; ++c) {
+            if(_partial_packets[n][c].empty() && 
+               (_queued_messages[n][c].packets > 0)) {
+                _MaterializePacket(n, c);
+            }
+        }
+    }
+
     for(int subnet = 0; subnet < _subnets; ++subnet) {
 
         for(int n = 0; n < _nodes; ++n) {
@@ -1585,10 +1694,10 @@ void TrafficManager::_Step( )
 
                 _partial_packets[n][c].pop_front();
 
-#ifdef TRACK_FLOWS
-                ++_outstanding_credits[c][subnet][n];
-                _outstanding_classes[n][subnet][f->vc].push(c);
-#endif
+                if(gTrackFlows) {
+                    ++_outstanding_credits[c][subnet][n];
+                    _outstanding_classes[n][subnet][f->vc].push(c);
+                }
 
                 dest_buf->SendingFlit(f);
 	
@@ -1621,9 +1730,13 @@ void TrafficManager::_Step( )
                     }
                 }
 	
-#ifdef TRACK_FLOWS
-                ++_injected_flits[c][n];
-#endif
+                if(gTrackFlows) {
+                    ++_injected_flits[c][n];
+                }
+
+                if(gEventTrace) {
+                    gEventTrace->Record(EventTrace::INJECT, f, n);
+                }
 	
                 _net[subnet]->WriteFlit(f, n);
 	
@@ -1638,68 +1751,99 @@ void TrafficManager::_Step( )
                 Flit * const f = iter->second;
 
                 f->atime = _time;
-                if(f->watch) {
-                    *gWatchOut << GetSimTime() << " | "
-                               << "node" << n << " | "
-                               << "Injecting credit for VC " << f->vc 
-                               << " into subnet " << subnet 
-                               << "." << endl;
+                if(_endpoint && _endpoint->Full(n) &&
+                   ((f->type == Flit::READ_REQUEST) || (f->type == Flit::WRITE_REQUEST))) {
+                    // the endpoint cannot take more requests; keep the
+                    // ejection buffer slot until it can
+                    ++_held_credits[n][subnet][f->vc];
+                    ++_held_credit_count[n];
+                    if((_sim_state == warming_up) || (_sim_state == running)) {
+                        ++_held_request_flits;
+                    }
+                } else {
+                    if(f->watch) {
+                        *gWatchOut << GetSimTime() << " | "
+                                   << "node" << n << " | "
+                                   << "Injecting credit for VC " << f->vc 
+                                   << " into subnet " << subnet 
+                                   << "." << endl;
+                    }
+                    Credit * const c = Credit::New();
+                    c->vc.insert(f->vc);
+                    _ReleaseCredits(n, subnet, c);
+                    _net[subnet]->WriteCredit(c, n);
                 }
-                Credit * const c = Credit::New();
-                c->vc.insert(f->vc);
-                _net[subnet]->WriteCredit(c, n);
 	
-#ifdef TRACK_FLOWS
-                ++_ejected_flits[f->cl][n];
-#endif
+                if(gTrackFlows) {
+                    ++_ejected_flits[f->cl][n];
+                }
 	
                 _RetireFlit(f, n);
+            } else if(_endpoint && (_held_credit_count[n] > 0)) {
+                Credit * const c = Credit::New();
+                _ReleaseCredits(n, subnet, c);
+                if(c->vc.empty()) {
+                    c->Free();
+                } else {
+                    _net[subnet]->WriteCredit(c, n);
+                }
             }
         }
         flits[subnet].clear();
         _net[subnet]->Evaluate( );
         _net[subnet]->WriteOutputs( );
-
-#ifdef CHAN_UTILS
-        if ((GetSimTime() > 100) && (gN == 2)){
-            // Uplink
-            for (int i = 0; i < gK; i++){
-                for (int j = 0; j < gK; j++){
-                    _chanutil_stats[subnet][i*gK + j]->AddSample(_net[subnet]->GetChanUtil(gK+i, gK+j));
-                    _chanutil_freq_stats[subnet][i*gK + j]->AddSample(_net[subnet]->GetChanUtil(gK+i, gK+j));
-                }
-            }
-
-            // Downlink
-            for (int i = 0; i < gK; i++){    // 1x Fattree
-            // for (int i = 0; i < gK/2; i++){     // 2x Fattree
-                for (int j = 0; j < gK; j++){   // 1x Fattree
-                // for (int j = 0; j < 2*gK; j++){  // 2x Fattree
-                    // 1x Fattree
-                    _chanutil_stats[subnet][gK*gK + i*gK + j]->AddSample(_net[subnet]->GetChanUtil(i, j));
-                    _chanutil_freq_stats[subnet][gK*gK + i*gK + j]->AddSample(_net[subnet]->GetChanUtil(i, j));
-                    // // 2x Fattree
-                    // _chanutil_stats[subnet][gK*gK + i*2*gK + j]->AddSample(_net[subnet]->GetChanUtil(i, j));
-                    // _chanutil_freq_stats[subnet][gK*gK + i*2*gK + j]->AddSample(_net[subnet]->GetChanUtil(i, j));
-                }
-            }
-        }
-#endif
     }
 
     ++_time;
     assert(_time);
+    if(_snapshot && ((_time % _snapshot->Interval()) == 0)) {
+        _snapshot->Record(_time, _rob_occupancy);
+    }
+    if(_telemetry && ((_time % _telemetry_interval) == 0)) {
+        _PublishTelemetry();
+    }
     if(gTrace){
         cout<<"TIME "<<_time<<endl;
     }
 
 }
   
+// Hands held requests to endpoints that have room again.
+void TrafficManager::_AdmitHeldRequests( )
+{
+    for(int n = 0; n < _nodes; ++n) {
+        deque<PacketReplyInfo *> & held = _held_requests[n];
+        while(!held.empty() && !_endpoint->Full(n)) {
+            _endpoint_queue_stats->AddSample(_endpoint->Occupancy(n));
+            _endpoint->Arrive(n, held.front(), _time);
+            held.pop_front();
+            --_held_request_count;
+        }
+    }
+}
+
+// Adds one credit for every VC of the node's ejection channel whose credits
+// were held back while its endpoint was full.
+void TrafficManager::_ReleaseCredits( int node, int subnet, Credit * c )
+{
+    if(!_endpoint || (_held_credit_count[node] == 0) || _endpoint->Full(node)) {
+        return;
+    }
+    vector<int> & held = _held_credits[node][subnet];
+    for(int vc = 0; vc < _vcs; ++vc) {
+        if((held[vc] > 0) && (c->vc.count(vc) == 0)) {
+            c->vc.insert(vc);
+            --held[vc];
+            --_held_credit_count[node];
+        }
+    }
+}
+
 bool TrafficManager::_PacketsOutstanding( ) const
 {
     for ( int c = 0; c < _classes; ++c ) {
         if ( _measure_stats[c] ) {
-            if ( _measured_in_flight_flits[c].empty() ) {
+            if ( _MeasuredInFlightFlits(c) == 0 ) {
 	
                 for ( int s = 0; s < _nodes; ++s ) {
                     if ( !_qdrained[s][c] ) {
@@ -1712,7 +1856,7 @@ bool TrafficManager::_PacketsOutstanding( ) const
                 }
             } else {
 #ifdef DEBUG_DRAIN
-                cout << "in flight = " << _measured_in_flight_flits[c].size() << endl;
+                cout << "in flight = " << _MeasuredInFlightFlits(c) << endl;
 #endif
                 return true;
             }
@@ -1745,25 +1889,25 @@ void TrafficManager::_ClearStats( )
         _read_rlat_stats[c]->Clear();
         _write_rlat_stats[c]->Clear();
 
-#ifdef WAIT_TIME
-        _ewlat_stats[c]->Clear();
-        _service_stats[c]->Clear();
-        _upservice_stats[c]->Clear();
-        _downservice_stats[c]->Clear();
-#endif
+        if(gTrackWaitTime) {
+            _ewlat_stats[c]->Clear();
+            _service_stats[c]->Clear();
+            _upservice_stats[c]->Clear();
+            _downservice_stats[c]->Clear();
+        }
 
         _sent_packets[c].assign(_nodes, 0);
         _accepted_packets[c].assign(_nodes, 0);
         _sent_flits[c].assign(_nodes, 0);
         _accepted_flits[c].assign(_nodes, 0);
 
-#ifdef TRACK_STALLS
-        _buffer_busy_stalls[c].assign(_subnets*_routers, 0);
-        _buffer_conflict_stalls[c].assign(_subnets*_routers, 0);
-        _buffer_full_stalls[c].assign(_subnets*_routers, 0);
-        _buffer_reserved_stalls[c].assign(_subnets*_routers, 0);
-        _crossbar_conflict_stalls[c].assign(_subnets*_routers, 0);
-#endif
+        if(gTrackStalls) {
+            _buffer_busy_stalls[c].assign(_subnets*_routers, 0);
+            _buffer_conflict_stalls[c].assign(_subnets*_routers, 0);
+            _buffer_full_stalls[c].assign(_subnets*_routers, 0);
+            _buffer_reserved_stalls[c].assign(_subnets*_routers, 0);
+            _crossbar_conflict_stalls[c].assign(_subnets*_routers, 0);
+        }
         if(_pair_stats){
             for ( int i = 0; i < _nodes; ++i ) {
                 for ( int j = 0; j < _nodes; ++j ) {
@@ -1776,14 +1920,21 @@ void TrafficManager::_ClearStats( )
         _hop_stats[c]->Clear();
     }
 
-#ifdef CHAN_UTILS
-    for (int s = 0; s < _subnets; s++){
-        for (int i = 0; i < _num_channels; i++){
-            _chanutil_stats[s][i]->Clear( );
-            _chanutil_freq_stats[s][i]->Clear( );
+    _endpoint_queue_stats->Clear( );
+    _held_request_flits = 0;
+
+    if(gTrackChanUtils) {
+        for (int s = 0; s < _subnets; ++s) {
+            for (size_t i = 0; i < _chanutil_chans[s].size(); ++i) {
+                _chanutil_mark[s][i] = _chanutil_chans[s][i]->GetBusyCycles();
+            }
+            _chanutil_min[s].assign(_chanutil_chans[s].size(), 0.0);
+            _chanutil_sum[s].assign(_chanutil_chans[s].size(), 0.0);
+            _chanutil_max[s].assign(_chanutil_chans[s].size(), 0.0);
         }
+        _chanutil_mark_time = _time;
+        _chanutil_windows = 0;
     }
-#endif
 
     _reset_time = _time;
 }
@@ -1831,32 +1982,52 @@ void TrafficManager::_DisplayRemaining( ostream & os ) const
 {
     for(int c = 0; c < _classes; ++c) {
 
+        // the lowest IDs may belong to flits that have not been created yet
+        vector<int> ids, measured_ids;
         map<int, Flit *>::const_iterator iter;
         int i;
+        for ( iter = _total_in_flight_flits[c].begin( ), i = 0;
+              ( iter != _total_in_flight_flits[c].end( ) ) && ( i < 10 );
+              iter++, i++ ) {
+            ids.push_back(iter->first);
+        }
+        for ( iter = _measured_in_flight_flits[c].begin( ), i = 0;
+              ( iter != _measured_in_flight_flits[c].end( ) ) && ( i < 10 );
+              iter++, i++ ) {
+            measured_ids.push_back(iter->first);
+        }
+        for ( int s = 0; s < _nodes; ++s ) {
+            QueuedMessage const & qm = _queued_messages[s][c];
+            int const n = min(qm.packets * qm.packet_size, 10);
+            for ( i = 0; i < n; ++i ) {
+                ids.push_back(qm.id + i);
+                if(qm.record) {
+                    measured_ids.push_back(qm.id + i);
+                }
+            }
+        }
+        sort(ids.begin(), ids.end());
+        sort(measured_ids.begin(), measured_ids.end());
 
         os << "Class " << c << ":" << endl;
 
         os << "Remaining flits: ";
-        for ( iter = _total_in_flight_flits[c].begin( ), i = 0;
-              ( iter != _total_in_flight_flits[c].end( ) ) && ( i < 10 );
-              iter++, i++ ) {
-            os << iter->first << " ";
+        for ( i = 0; ( i < (int)ids.size() ) && ( i < 10 ); i++ ) {
+            os << ids[i] << " ";
         }
-        if(_total_in_flight_flits[c].size() > 10)
+        if(_InFlightFlits(c) > 10)
             os << "[...] ";
     
-        os << "(" << _total_in_flight_flits[c].size() << " flits)" << endl;
+        os << "(" << _InFlightFlits(c) << " flits)" << endl;
     
         os << "Measured flits: ";
-        for ( iter = _measured_in_flight_flits[c].begin( ), i = 0;
-              ( iter != _measured_in_flight_flits[c].end( ) ) && ( i < 10 );
-              iter++, i++ ) {
-            os << iter->first << " ";
+        for ( i = 0; ( i < (int)measured_ids.size() ) && ( i < 10 ); i++ ) {
+            os << measured_ids[i] << " ";
         }
-        if(_measured_in_flight_flits[c].size() > 10)
+        if(_MeasuredInFlightFlits(c) > 10)
             os << "[...] ";
     
-        os << "(" << _measured_in_flight_flits[c].size() << " flits)" << endl;
+        os << "(" << _MeasuredInFlightFlits(c) << " flits)" << endl;
     
     }
 }
@@ -1880,11 +2051,14 @@ bool TrafficManager::_SingleSim( )
         }
     
     
-        for ( int iter = 0; iter < _sample_period; ++iter ) {
+        for ( int iter = 0; ( iter < _sample_period ) && !_deadlocked; ++iter ) {
             _Step( );
             // if (GetSimTime() > 15000)
             //     DisplayAvgLatFrequently(cout, 500);
         }
+        if ( _deadlocked ) {
+            return false;
+        }
     
         //cout << _sim_state << endl;
 
@@ -1924,6 +2098,7 @@ bool TrafficManager::_SingleSim( )
                 latency += (double)(_time - iter->second->ctime);
                 count++;
             }
+            _AddQueuedLatency(c, latency, count);
       
             if((lat_exc_class < 0) &&
                (_latency_thres[c] >= 0.0) &&
@@ -2002,7 +2177,7 @@ bool TrafficManager::_SingleSim( )
         if ( _measure_latency ) {
             cout << "Draining all recorded packets ..." << endl;
             int empty_steps = 0;
-            while( _PacketsOutstanding( ) ) { 
+            while( _PacketsOutstanding( ) && !_deadlocked ) { 
                 _Step( ); 
 	
                 ++empty_steps;
@@ -2029,6 +2204,7 @@ bool TrafficManager::_SingleSim( )
                             acc_latency += (double)(_time - iter->second->ctime);
                             acc_count++;
                         }
+                        _AddQueuedLatency(c, acc_latency, acc_count);
 	    
                         if((acc_latency / acc_count) > threshold) {
                             lat_exc_class = c;
@@ -2055,7 +2231,7 @@ bool TrafficManager::_SingleSim( )
         cout << "Too many sample periods needed to converge" << endl;
     }
   
-    return ( converged > 0 );
+    return ( converged > 0 ) && !_deadlocked;
 }
 
 bool TrafficManager::Run( )
@@ -2063,6 +2239,7 @@ bool TrafficManager::Run( )
     for ( int sim = 0; sim < _total_sims; ++sim ) {
 
         _time = 0;
+        _cur_sim = sim;
 
         //remove any pending request from the previous simulations
         _requestsOutstanding.assign(_nodes, 0);
@@ -2072,6 +2249,16 @@ bool TrafficManager::Run( )
                 _repliesPending[i].pop_front();
             }
         }
+        if(_endpoint) {
+            _endpoint->Reset();
+            for(int n = 0; n < _nodes; ++n) {
+                while(!_held_requests[n].empty()) {
+                    _held_requests[n].front()->Free();
+                    _held_requests[n].pop_front();
+                }
+            }
+            _held_request_count = 0;
+        }
 
         //reset queuetime for all sources
         for ( int s = 0; s < _nodes; ++s ) {
@@ -2094,7 +2281,11 @@ bool TrafficManager::Run( )
         }
 
         if ( !_SingleSim( ) ) {
-            cout << "Simulation unstable, ending ..." << endl;
+            if ( _deadlocked ) {
+                _ReportDeadlock( );
+            } else {
+                cout << "Simulation unstable, ending ..." << endl;
+            }
             return false;
         }
 
@@ -2105,10 +2296,10 @@ bool TrafficManager::Run( )
 
         bool packets_left = false;
         for(int c = 0; c < _classes; ++c) {
-            packets_left |= !_total_in_flight_flits[c].empty();
+            packets_left |= (_InFlightFlits(c) > 0);
         }
 
-        while( packets_left ) { 
+        while( packets_left && !_deadlocked ) { 
             _Step( ); 
 
             ++empty_steps;
@@ -2119,9 +2310,13 @@ bool TrafficManager::Run( )
       
             packets_left = false;
             for(int c = 0; c < _classes; ++c) {
-                packets_left |= !_total_in_flight_flits[c].empty();
+                packets_left |= (_InFlightFlits(c) > 0);
             }
         }
+        if ( _deadlocked ) {
+            _ReportDeadlock( );
+            return false;
+        }
         //wait until all the credits are drained as well
         while(Credit::OutStanding()!=0){
             _Step();
@@ -2142,10 +2337,16 @@ bool TrafficManager::Run( )
         if(_stats_out) {
             WriteStats(*_stats_out);
         }
+        if(_results) {
+            _WriteSimResults();
+        }
         _UpdateOverallStats();
     }
   
     DisplayOverallStats();
+    if(_results) {
+        _WriteOverallResults();
+    }
     if(_print_csv_results) {
         DisplayOverallStatsCSV();
     }
@@ -2153,6 +2354,21 @@ bool TrafficManager::Run( )
     return true;
 }
 
+// Keep the statistics gathered up to a confirmed deadlock, so that the
+// aborted simulation still leaves them in stats_out and results_out.
+void TrafficManager::_ReportDeadlock( )
+{
+    cout << "Simulation deadlocked at cycle " << _time << ", ending ..." << endl;
+    UpdateStats();
+    DisplayStats();
+    if(_stats_out) {
+        WriteStats(*_stats_out);
+    }
+    if(_results) {
+        _WriteSimResults();
+    }
+}
+
 void TrafficManager::_UpdateOverallStats() {
     for ( int c = 0; c < _classes; ++c ) {
     
@@ -2212,23 +2428,23 @@ void TrafficManager::_UpdateOverallStats() {
         _overall_avg_write_rlat[c] += _write_rlat_stats[c]->Average();
         _overall_max_write_rlat[c] += _write_rlat_stats[c]->Max();
 
-#ifdef WAIT_TIME
-        _overall_min_ewlat[c] += _ewlat_stats[c]->Min();
-        _overall_avg_ewlat[c] += _ewlat_stats[c]->Average();
-        _overall_max_ewlat[c] += _ewlat_stats[c]->Max();
+        if(gTrackWaitTime) {
+            _overall_min_ewlat[c] += _ewlat_stats[c]->Min();
+            _overall_avg_ewlat[c] += _ewlat_stats[c]->Average();
+            _overall_max_ewlat[c] += _ewlat_stats[c]->Max();
 
-        _overall_min_service[c] += _service_stats[c]->Min();
-        _overall_avg_service[c] += _service_stats[c]->Average();
-        _overall_max_service[c] += _service_stats[c]->Max();
+            _overall_min_service[c] += _service_stats[c]->Min();
+            _overall_avg_service[c] += _service_stats[c]->Average();
+            _overall_max_service[c] += _service_stats[c]->Max();
 
-        _overall_min_upservice[c] += _upservice_stats[c]->Min();
-        _overall_avg_upservice[c] += _upservice_stats[c]->Average();
-        _overall_max_upservice[c] += _upservice_stats[c]->Max();
+            _overall_min_upservice[c] += _upservice_stats[c]->Min();
+            _overall_avg_upservice[c] += _upservice_stats[c]->Average();
+            _overall_max_upservice[c] += _upservice_stats[c]->Max();
 
-        _overall_min_downservice[c] += _downservice_stats[c]->Min();
-        _overall_avg_downservice[c] += _downservice_stats[c]->Average();
-        _overall_max_downservice[c] += _downservice_stats[c]->Max();
-#endif
+            _overall_min_downservice[c] += _downservice_stats[c]->Min();
+            _overall_avg_downservice[c] += _downservice_stats[c]->Average();
+            _overall_max_downservice[c] += _downservice_stats[c]->Max();
+        }
 
         _overall_hop_stats[c] += _hop_stats[c]->Average();
         int count_min, count_sum, count_max;
@@ -2268,40 +2484,46 @@ void TrafficManager::_UpdateOverallStats() {
         _overall_avg_accepted_packets[c] += rate_avg;
         _overall_max_accepted_packets[c] += rate_max;
 
-#ifdef TRACK_STALLS
-        _ComputeStats(_buffer_busy_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        _overall_buffer_busy_stalls[c] += rate_avg;
-        _ComputeStats(_buffer_conflict_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        _overall_buffer_conflict_stalls[c] += rate_avg;
-        _ComputeStats(_buffer_full_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        _overall_buffer_full_stalls[c] += rate_avg;
-        _ComputeStats(_buffer_reserved_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        _overall_buffer_reserved_stalls[c] += rate_avg;
-        _ComputeStats(_crossbar_conflict_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        _overall_crossbar_conflict_stalls[c] += rate_avg;
-#endif
-
-    }
-
-#ifdef CHAN_UTILS
-    for (int s = 0; s < _subnets; s++) {
-        for (int i = 0; i < _num_channels; i++) {
-            _overall_min_chanutil[s][i] += _chanutil_stats[s][i]->Min();
-            _overall_avg_chanutil[s][i] += _chanutil_stats[s][i]->Average();
-            _overall_max_chanutil[s][i] += _chanutil_stats[s][i]->Max();
+        if(gTrackStalls) {
+            _ComputeStats(_buffer_busy_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            _overall_buffer_busy_stalls[c] += rate_avg;
+            _ComputeStats(_buffer_conflict_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            _overall_buffer_conflict_stalls[c] += rate_avg;
+            _ComputeStats(_buffer_full_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            _overall_buffer_full_stalls[c] += rate_avg;
+            _ComputeStats(_buffer_reserved_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            _overall_buffer_reserved_stalls[c] += rate_avg;
+            _ComputeStats(_crossbar_conflict_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            _overall_crossbar_conflict_stalls[c] += rate_avg;
+        }
+
+    }
+
+    if(_endpoint) {
+        _overall_avg_endpoint_queue += _endpoint_queue_stats->Average();
+        _overall_max_endpoint_queue += _endpoint_queue_stats->Max();
+    }
+
+    if(gTrackChanUtils) {
+        for (int s = 0; s < _subnets; ++s) {
+            for (size_t i = 0; i < _chanutil_chans[s].size(); ++i) {
+                _overall_min_chanutil[s][i] += _chanutil_min[s][i];
+                _overall_avg_chanutil[s][i] += 
+                    (_chanutil_windows > 0) ? (_chanutil_sum[s][i] / _chanutil_windows) : 0.0;
+                _overall_max_chanutil[s][i] += _chanutil_max[s][i];
+            }
         }
     }
-#endif
 
 }
 
@@ -2393,111 +2615,121 @@ void TrafficManager::WriteStats(ostream & os) const {
             os << (double)_accepted_flits[c][d] / (double)_accepted_packets[c][d] << " ";
         }
         os << "];" << endl;
-#ifdef TRACK_STALLS
-        os << "buffer_busy_stalls(" << c+1 << ",:) = [ ";
-        for ( int d = 0; d < _subnets*_routers; ++d ) {
-            os << (double)_buffer_busy_stalls[c][d] / time_delta << " ";
-        }
-        os << "];" << endl
-           << "buffer_conflict_stalls(" << c+1 << ",:) = [ ";
-        for ( int d = 0; d < _subnets*_routers; ++d ) {
-            os << (double)_buffer_conflict_stalls[c][d] / time_delta << " ";
-        }
-        os << "];" << endl
-           << "buffer_full_stalls(" << c+1 << ",:) = [ ";
-        for ( int d = 0; d < _subnets*_routers; ++d ) {
-            os << (double)_buffer_full_stalls[c][d] / time_delta << " ";
-        }
-        os << "];" << endl
-           << "buffer_reserved_stalls(" << c+1 << ",:) = [ ";
-        for ( int d = 0; d < _subnets*_routers; ++d ) {
-            os << (double)_buffer_reserved_stalls[c][d] / time_delta << " ";
-        }
-        os << "];" << endl
-           << "crossbar_conflict_stalls(" << c+1 << ",:) = [ ";
-        for ( int d = 0; d < _subnets*_routers; ++d ) {
-            os << (double)_crossbar_conflict_stalls[c][d] / time_delta << " ";
+        if(gTrackStalls) {
+            os << "buffer_busy_stalls(" << c+1 << ",:) = [ ";
+            for ( int d = 0; d < _subnets*_routers; ++d ) {
+                os << (double)_buffer_busy_stalls[c][d] / time_delta << " ";
+            }
+            os << "];" << endl
+               << "buffer_conflict_stalls(" << c+1 << ",:) = [ ";
+            for ( int d = 0; d < _subnets*_routers; ++d ) {
+                os << (double)_buffer_conflict_stalls[c][d] / time_delta << " ";
+            }
+            os << "];" << endl
+               << "buffer_full_stalls(" << c+1 << ",:) = [ ";
+            for ( int d = 0; d < _subnets*_routers; ++d ) {
+                os << (double)_buffer_full_stalls[c][d] / time_delta << " ";
+            }
+            os << "];" << endl
+               << "buffer_reserved_stalls(" << c+1 << ",:) = [ ";
+            for ( int d = 0; d < _subnets*_routers; ++d ) {
+                os << (double)_buffer_reserved_stalls[c][d] / time_delta << " ";
+            }
+            os << "];" << endl
+               << "crossbar_conflict_stalls(" << c+1 << ",:) = [ ";
+            for ( int d = 0; d < _subnets*_routers; ++d ) {
+                os << (double)_crossbar_conflict_stalls[c][d] / time_delta << " ";
+            }
+            os << "];" << endl;
         }
-        os << "];" << endl;
-#endif
+    }
+
+    if(_endpoint) {
+        os << "endpoint_queue = " << _endpoint_queue_stats->Average() << ";" << endl
+           << "endpoint_queue_hist = " << *_endpoint_queue_stats << ";" << endl;
     }
 }
 
 void TrafficManager::UpdateStats() {
-#if defined(TRACK_FLOWS) || defined(TRACK_STALLS)
-    for(int c = 0; c < _classes; ++c) {
-#ifdef TRACK_FLOWS
-        {
-            char trail_char = (c == _classes - 1) ? '\n' : ',';
-            if(_injected_flits_out) *_injected_flits_out << _injected_flits[c] << trail_char;
-            _injected_flits[c].assign(_nodes, 0);
-            if(_ejected_flits_out) *_ejected_flits_out << _ejected_flits[c] << trail_char;
-            _ejected_flits[c].assign(_nodes, 0);
-        }
-#endif
-        for(int subnet = 0; subnet < _subnets; ++subnet) {
-#ifdef TRACK_FLOWS
-            if(_outstanding_credits_out) *_outstanding_credits_out << _outstanding_credits[c][subnet] << ',';
-            if(_stored_flits_out) *_stored_flits_out << vector<int>(_nodes, 0) << ',';
-#endif
-            for(int router = 0; router < _routers; ++router) {
-                Router * const r = _router[subnet][router];
-#ifdef TRACK_FLOWS
-                char trail_char = 
-                    ((router == _routers - 1) && (subnet == _subnets - 1) && (c == _classes - 1)) ? '\n' : ',';
-                if(_received_flits_out) *_received_flits_out << r->GetReceivedFlits(c) << trail_char;
-                if(_stored_flits_out) *_stored_flits_out << r->GetStoredFlits(c) << trail_char;
-                if(_sent_flits_out) *_sent_flits_out << r->GetSentFlits(c) << trail_char;
-                if(_outstanding_credits_out) *_outstanding_credits_out << r->GetOutstandingCredits(c) << trail_char;
-                if(_active_packets_out) *_active_packets_out << r->GetActivePackets(c) << trail_char;
-                r->ResetFlowStats(c);
-#endif
-#ifdef TRACK_STALLS
-                _buffer_busy_stalls[c][subnet*_routers+router] += r->GetBufferBusyStalls(c);
-                _buffer_conflict_stalls[c][subnet*_routers+router] += r->GetBufferConflictStalls(c);
-                _buffer_full_stalls[c][subnet*_routers+router] += r->GetBufferFullStalls(c);
-                _buffer_reserved_stalls[c][subnet*_routers+router] += r->GetBufferReservedStalls(c);
-                _crossbar_conflict_stalls[c][subnet*_routers+router] += r->GetCrossbarConflictStalls(c);
-                r->ResetStallStats(c);
-#endif
-            }
-        }
+    if(gTrackChanUtils) {
+        _UpdateChanUtils();
     }
-#ifdef TRACK_FLOWS
-    if(_injected_flits_out) *_injected_flits_out << flush;
-    if(_received_flits_out) *_received_flits_out << flush;
-    if(_stored_flits_out) *_stored_flits_out << flush;
-    if(_sent_flits_out) *_sent_flits_out << flush;
-    if(_outstanding_credits_out) *_outstanding_credits_out << flush;
-    if(_ejected_flits_out) *_ejected_flits_out << flush;
-    if(_active_packets_out) *_active_packets_out << flush;
-#endif
-#endif
 
-#ifdef TRACK_CREDITS
-    for(int s = 0; s < _subnets; ++s) {
-        for(int n = 0; n < _nodes; ++n) {
-            BufferState const * const bs = _buf_states[n][s];
-            for(int v = 0; v < _vcs; ++v) {
-                if(_used_credits_out) *_used_credits_out << bs->OccupancyFor(v) << ',';
-                if(_free_credits_out) *_free_credits_out << bs->AvailableFor(v) << ',';
-                if(_max_credits_out) *_max_credits_out << bs->LimitFor(v) << ',';
+    if(gTrackFlows || gTrackStalls) {
+        for(int c = 0; c < _classes; ++c) {
+            if(gTrackFlows) {
+                char trail_char = (c == _classes - 1) ? '\n' : ',';
+                if(_injected_flits_out) *_injected_flits_out << _injected_flits[c] << trail_char;
+                _injected_flits[c].assign(_nodes, 0);
+                if(_ejected_flits_out) *_ejected_flits_out << _ejected_flits[c] << trail_char;
+                _ejected_flits[c].assign(_nodes, 0);
+            }
+            for(int subnet = 0; subnet < _subnets; ++subnet) {
+                if(gTrackFlows) {
+                    if(_outstanding_credits_out) *_outstanding_credits_out << _outstanding_credits[c][subnet] << ',';
+                    if(_stored_flits_out) *_stored_flits_out << vector<int>(_nodes, 0) << ',';
+                }
+                for(int router = 0; router < _routers; ++router) {
+                    Router * const r = _router[subnet][router];
+                    if(gTrackFlows) {
+                        char trail_char = 
+                            ((router == _routers - 1) && (subnet == _subnets - 1) && (c == _classes - 1)) ? '\n' : ',';
+                        if(_received_flits_out) *_received_flits_out << r->GetReceivedFlits(c) << trail_char;
+                        if(_stored_flits_out) *_stored_flits_out << r->GetStoredFlits(c) << trail_char;
+                        if(_sent_flits_out) *_sent_flits_out << r->GetSentFlits(c) << trail_char;
+                        if(_outstanding_credits_out) *_outstanding_credits_out << r->GetOutstandingCredits(c) << trail_char;
+                        if(_active_packets_out) *_active_packets_out << r->GetActivePackets(c) << trail_char;
+                        r->ResetFlowStats(c);
+                    }
+                    if(gTrackStalls) {
+                        _buffer_busy_stalls[c][subnet*_routers+router] += r->GetBufferBusyStalls(c);
+                        _buffer_conflict_stalls[c][subnet*_routers+router] += r->GetBufferConflictStalls(c);
+                        _buffer_full_stalls[c][subnet*_routers+router] += r->GetBufferFullStalls(c);
+                        _buffer_reserved_stalls[c][subnet*_routers+router] += r->GetBufferReservedStalls(c);
+                        _crossbar_conflict_stalls[c][subnet*_routers+router] += r->GetCrossbarConflictStalls(c);
+                        r->ResetStallStats(c);
+                    }
+                }
             }
         }
-        for(int r = 0; r < _routers; ++r) {
-            Router const * const rtr = _router[s][r];
-            char trail_char = 
-                ((r == _routers - 1) && (s == _subnets - 1)) ? '\n' : ',';
-            if(_used_credits_out) *_used_credits_out << rtr->UsedCredits() << trail_char;
-            if(_free_credits_out) *_free_credits_out << rtr->FreeCredits() << trail_char;
-            if(_max_credits_out) *_max_credits_out << rtr->MaxCredits() << trail_char;
+        if(gTrackFlows) {
+            if(_injected_flits_out) *_injected_flits_out << flush;
+            if(_received_flits_out) *_received_flits_out << flush;
+            if(_stored_flits_out) *_stored_flits_out << flush;
+            if(_sent_flits_out) *_sent_flits_out << flush;
+            if(_outstanding_credits_out) *_outstanding_credits_out << flush;
+            if(_ejected_flits_out) *_ejected_flits_out << flush;
+            if(_active_packets_out) *_active_packets_out << flush;
+        }
+    }
+
+    if(gTrackCredits) {
+        for(int s = 0; s < _subnets; ++s) {
+            for(int n = 0; n < _nodes; ++n) {
+                BufferState const * const bs = _buf_states[n][s];
+                for(int v = 0; v < _vcs; ++v) {
+                    if(_used_credits_out) *_used_credits_out << bs->OccupancyFor(v) << ',';
+                    if(_free_credits_out) *_free_credits_out << bs->AvailableFor(v) << ',';
+                    if(_max_credits_out) *_max_credits_out << bs->LimitFor(v) << ',';
+                }
+            }
+            for(int r = 0; r < _routers; ++r) {
+                Router const * const rtr = _router[s][r];
+                char trail_char = 
+                    ((r == _routers - 1) && (s == _subnets - 1)) ? '\n' : ',';
+                if(_used_credits_out) *_used_credits_out << rtr->UsedCredits() << trail_char;
+                if(_free_credits_out) *_free_credits_out << rtr->FreeCredits() << trail_char;
+                if(_max_credits_out) *_max_credits_out << rtr->MaxCredits() << trail_char;
+            }
         }
+        if(_used_credits_out) *_used_credits_out << flush;
+        if(_free_credits_out) *_free_credits_out << flush;
+        if(_max_credits_out) *_max_credits_out << flush;
     }
-    if(_used_credits_out) *_used_credits_out << flush;
-    if(_free_credits_out) *_free_credits_out << flush;
-    if(_max_credits_out) *_max_credits_out << flush;
-#endif
 
+    if(_results) {
+        _WriteSampleResults();
+    }
 }
 
 void TrafficManager::DisplayStats(ostream & os) const {
@@ -2567,27 +2799,27 @@ void TrafficManager::DisplayStats(ostream & os) const {
             << "\tmaximum = " << _write_rlat_stats[c]->Max() << endl;
         }
 
-#ifdef WAIT_TIME
-        cout
-            << "Endpoint waiting time average = " << _ewlat_stats[c]->Average() << endl
-            << "\tminimum = " << _ewlat_stats[c]->Min() << endl
-            << "\tmaximum = " << _ewlat_stats[c]->Max() << endl;
+        if(gTrackWaitTime) {
+            cout
+                << "Endpoint waiting time average = " << _ewlat_stats[c]->Average() << endl
+                << "\tminimum = " << _ewlat_stats[c]->Min() << endl
+                << "\tmaximum = " << _ewlat_stats[c]->Max() << endl;
 
-        cout
-            << "Service time average = " << _service_stats[c]->Average() << endl
-            << "\tminimum = " << _service_stats[c]->Min() << endl
-            << "\tmaximum = " << _service_stats[c]->Max() << endl;
+            cout
+                << "Service time average = " << _service_stats[c]->Average() << endl
+                << "\tminimum = " << _service_stats[c]->Min() << endl
+                << "\tmaximum = " << _service_stats[c]->Max() << endl;
         
-        cout
-            << "UpService time average = " << _upservice_stats[c]->Average() << endl
-            << "\tminimum = " << _upservice_stats[c]->Min() << endl
-            << "\tmaximum = " << _upservice_stats[c]->Max() << endl;
+            cout
+                << "UpService time average = " << _upservice_stats[c]->Average() << endl
+                << "\tminimum = " << _upservice_stats[c]->Min() << endl
+                << "\tmaximum = " << _upservice_stats[c]->Max() << endl;
 
-        cout
-            << "DownService time average = " << _downservice_stats[c]->Average() << endl
-            << "\tminimum = " << _downservice_stats[c]->Min() << endl
-            << "\tmaximum = " << _downservice_stats[c]->Max() << endl;
-#endif
+            cout
+                << "DownService time average = " << _downservice_stats[c]->Average() << endl
+                << "\tminimum = " << _downservice_stats[c]->Min() << endl
+                << "\tmaximum = " << _downservice_stats[c]->Max() << endl;
+        }
 
     
         int count_sum, count_min, count_max;
@@ -2644,34 +2876,40 @@ void TrafficManager::DisplayStats(ostream & os) const {
         cout << "Injected packet length average = " << (double)sent_flits / (double)sent_packets << endl
              << "Accepted packet length average = " << (double)accepted_flits / (double)accepted_packets << endl;
 
-        cout << "Total in-flight flits = " << _total_in_flight_flits[c].size()
-             << " (" << _measured_in_flight_flits[c].size() << " measured)"
+        cout << "Total in-flight flits = " << _InFlightFlits(c)
+             << " (" << _MeasuredInFlightFlits(c) << " measured)"
              << endl;
     
-#ifdef TRACK_STALLS
-        _ComputeStats(_buffer_busy_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        os << "Buffer busy stall rate = " << rate_avg << endl;
-        _ComputeStats(_buffer_conflict_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        os << "Buffer conflict stall rate = " << rate_avg << endl;
-        _ComputeStats(_buffer_full_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        os << "Buffer full stall rate = " << rate_avg << endl;
-        _ComputeStats(_buffer_reserved_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        os << "Buffer reserved stall rate = " << rate_avg << endl;
-        _ComputeStats(_crossbar_conflict_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        os << "Crossbar conflict stall rate = " << rate_avg << endl;
-#endif
+        if(gTrackStalls) {
+            _ComputeStats(_buffer_busy_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            os << "Buffer busy stall rate = " << rate_avg << endl;
+            _ComputeStats(_buffer_conflict_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            os << "Buffer conflict stall rate = " << rate_avg << endl;
+            _ComputeStats(_buffer_full_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            os << "Buffer full stall rate = " << rate_avg << endl;
+            _ComputeStats(_buffer_reserved_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            os << "Buffer reserved stall rate = " << rate_avg << endl;
+            _ComputeStats(_crossbar_conflict_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            os << "Crossbar conflict stall rate = " << rate_avg << endl;
+        }
     
     }
+
+    if(_endpoint) {
+        os << "Endpoint queue occupancy average = " << _endpoint_queue_stats->Average() << endl
+           << "\tmaximum = " << _endpoint_queue_stats->Max() << endl
+           << "Request flits held at full endpoints = " << _held_request_flits << endl;
+    }
 }
 
 void TrafficManager::DisplayOverallStats( ostream & os ) const {
@@ -2766,14 +3004,14 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
         os << "\tmaximum = " << _overall_max_write_rlat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;        
 
-#ifdef WAIT_TIME
-        os << "Endpoint waiting latency average = " << _overall_avg_ewlat[c] / (double)_total_sims
-           << " (" << _total_sims << " samples)" << endl;
-        os << "\tminimum = " << _overall_min_ewlat[c] / (double)_total_sims
-           << " (" << _total_sims << " samples)" << endl;
-        os << "\tmaximum = " << _overall_max_ewlat[c] / (double)_total_sims
-           << " (" << _total_sims << " samples)" << endl;
-#endif
+        if(gTrackWaitTime) {
+            os << "Endpoint waiting latency average = " << _overall_avg_ewlat[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl;
+            os << "\tminimum = " << _overall_min_ewlat[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl;
+            os << "\tmaximum = " << _overall_max_ewlat[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl;
+        }
 
         os << "Injected packet rate average = " << _overall_avg_sent_packets[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
@@ -2812,37 +3050,312 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
         os << "Hops average = " << _overall_hop_stats[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
     
-#ifdef TRACK_STALLS
-        os << "Buffer busy stall rate = " << (double)_overall_buffer_busy_stalls[c] / (double)_total_sims
-           << " (" << _total_sims << " samples)" << endl
-           << "Buffer conflict stall rate = " << (double)_overall_buffer_conflict_stalls[c] / (double)_total_sims
-           << " (" << _total_sims << " samples)" << endl
-           << "Buffer full stall rate = " << (double)_overall_buffer_full_stalls[c] / (double)_total_sims
-           << " (" << _total_sims << " samples)" << endl
-           << "Buffer reserved stall rate = " << (double)_overall_buffer_reserved_stalls[c] / (double)_total_sims
+        if(gTrackStalls) {
+            os << "Buffer busy stall rate = " << (double)_overall_buffer_busy_stalls[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl
+               << "Buffer conflict stall rate = " << (double)_overall_buffer_conflict_stalls[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl
+               << "Buffer full stall rate = " << (double)_overall_buffer_full_stalls[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl
+               << "Buffer reserved stall rate = " << (double)_overall_buffer_reserved_stalls[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl
+               << "Crossbar conflict stall rate = " << (double)_overall_crossbar_conflict_stalls[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl;
+        }
+    
+    }
+
+    if(_endpoint) {
+        os << "Endpoint queue occupancy average = " << _overall_avg_endpoint_queue / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl
-           << "Crossbar conflict stall rate = " << (double)_overall_crossbar_conflict_stalls[c] / (double)_total_sims
+           << "\tmaximum = " << _overall_max_endpoint_queue / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
-#endif
-    
     }
 
-#ifdef CHAN_UTILS
-    for (int s = 0; s < _subnets; s++){
-        os << "*** OVERALL UPLINK CHANNEL UTILIZATION ***" << endl;
-        for (int i = 0; i < (_num_channels / 2); i++){
-            os << _overall_min_chanutil[s][i] << "\t" << _overall_avg_chanutil[s][i] << "\t" << _overall_max_chanutil[s][i] << endl;
-            // os << "chanutil record = " << _overall_avg_chanutil[s][i] << endl;
+    if(gTrackChanUtils) {
+        _DisplayChanUtils(os);
+    }
+}
+
+// Utilization of every flit channel over the window since the last update,
+// from the busy-cycle counters the channels maintain in Send().
+void TrafficManager::_UpdateChanUtils( )
+{
+    int const window = _time - _chanutil_mark_time;
+    if(window <= 0) {
+        return;
+    }
+    if(_chanutil_out) {
+        *_chanutil_out << _time;
+    }
+    for (int s = 0; s < _subnets; ++s) {
+        for (size_t i = 0; i < _chanutil_chans[s].size(); ++i) {
+            int const busy = _chanutil_chans[s][i]->GetBusyCycles();
+            double const util = (double)(busy - _chanutil_mark[s][i]) / (double)window;
+            _chanutil_mark[s][i] = busy;
+            if((_chanutil_windows == 0) || (util < _chanutil_min[s][i])) {
+                _chanutil_min[s][i] = util;
+            }
+            if(util > _chanutil_max[s][i]) {
+                _chanutil_max[s][i] = util;
+            }
+            _chanutil_sum[s][i] += util;
+            if(_chanutil_out) {
+                *_chanutil_out << ',' << util;
+            }
+        }
+    }
+    if(_chanutil_out) {
+        *_chanutil_out << endl;
+    }
+    _chanutil_mark_time = _time;
+    ++_chanutil_windows;
+}
+
+void TrafficManager::_DisplayChanUtils( ostream & os ) const
+{
+    for (int s = 0; s < _subnets; ++s) {
+        int const links = _chanutil_chans[s].size();
+        if(links == 0) {
+            continue;
+        }
+        vector<pair<double, int> > order(links);
+        double avg_sum = 0.0;
+        for (int i = 0; i < links; ++i) {
+            order[i] = make_pair(-_overall_avg_chanutil[s][i], i);
+            avg_sum += _overall_avg_chanutil[s][i];
+        }
+        sort(order.begin(), order.end());
+        double const sims = (double)_total_sims;
+        os << "Channel utilization (subnet " << s << ", " << links << " links) average = "
+           << avg_sum / (double)links / sims << endl
+           << "\tminimum = " << -order.back().first / sims << endl
+           << "\tmaximum = " << -order.front().first / sims << endl;
+        int const top = ((_chanutil_top <= 0) || (_chanutil_top > links)) ? links : _chanutil_top;
+        os << "Hottest " << top << " links (min/avg/max utilization):" << endl;
+        for (int t = 0; t < top; ++t) {
+            int const i = order[t].second;
+            FlitChannel const * const chan = _chanutil_chans[s][i];
+            os << "\t" << chan->Name() << " (";
+            if(chan->GetSource()) {
+                os << "router " << chan->GetSource()->GetID() << ":" << chan->GetSourcePort();
+            } else {
+                os << "source";
+            }
+            os << " -> ";
+            if(chan->GetSink()) {
+                os << "router " << chan->GetSink()->GetID() << ":" << chan->GetSinkPort();
+            } else {
+                os << "sink";
+            }
+            os << ") " << _overall_min_chanutil[s][i] / sims
+               << " / " << _overall_avg_chanutil[s][i] / sims
+               << " / " << _overall_max_chanutil[s][i] / sims << endl;
+        }
+    }
+}
+
+// Per-class statistics of the current sample period, the same values that
+// DisplayStats() prints.
+void TrafficManager::_WriteSampleResults( )
+{
+    static char const * const columns[] = {
+        "class", "plat_avg", "plat_min", "plat_max", "nlat_avg", "nlat_min",
+        "nlat_max", "flat_avg", "flat_min", "flat_max", "frag_avg", "hops_avg",
+        "sent_packet_rate", "accepted_packet_rate", "sent_flit_rate",
+        "accepted_flit_rate", "in_flight_flits"
+    };
+    _results->Begin("sample", _cur_sim, _time, 
+                    vector<string>(columns, columns + sizeof(columns) / sizeof(columns[0])));
+    double const time_delta = (double)(_time - _reset_time);
+    for(int c = 0; c < _classes; ++c) {
+        if(_measure_stats[c] == 0) {
+            continue;
         }
+        int sent_packets, accepted_packets, sent_flits, accepted_flits;
+        _ComputeStats(_sent_packets[c], &sent_packets);
+        _ComputeStats(_accepted_packets[c], &accepted_packets);
+        _ComputeStats(_sent_flits[c], &sent_flits);
+        _ComputeStats(_accepted_flits[c], &accepted_flits);
+        double const rate_scale = time_delta * (double)_nodes;
+        double const row[] = {
+            (double)c,
+            _plat_stats[c]->Average(), _plat_stats[c]->Min(), _plat_stats[c]->Max(),
+            _nlat_stats[c]->Average(), _nlat_stats[c]->Min(), _nlat_stats[c]->Max(),
+            _flat_stats[c]->Average(), _flat_stats[c]->Min(), _flat_stats[c]->Max(),
+            _frag_stats[c]->Average(), _hop_stats[c]->Average(),
+            (double)sent_packets / rate_scale, (double)accepted_packets / rate_scale,
+            (double)sent_flits / rate_scale, (double)accepted_flits / rate_scale,
+            (double)_InFlightFlits(c)
+        };
+        _results->Row(vector<double>(row, row + sizeof(row) / sizeof(row[0])));
+    }
+    _results->End();
+}
 
-        os << "*** OVERALL DOWNLINK CHANNEL UTILIZATION ***" << endl;
-        for (int i = (_num_channels / 2); i < _num_channels; i++){
-            os << _overall_min_chanutil[s][i] << "\t" << _overall_avg_chanutil[s][i] << "\t" << _overall_max_chanutil[s][i] << endl;
-            // os << "chanutil record = " << _overall_avg_chanutil[s][i] << endl;
+// Histograms, pair statistics and channel utilization of the simulation
+// that just finished.
+void TrafficManager::_WriteSimResults( )
+{
+    vector<string> hist_columns;
+    hist_columns.push_back("class");
+    hist_columns.push_back("bin");
+    hist_columns.push_back("count");
+
+    static char const * const hist_names[] = {
+        "plat_hist", "nlat_hist", "flat_hist", "frag_hist", "hops_hist"
+    };
+    vector<Stats *> const * const hists[] = {
+        &_plat_stats, &_nlat_stats, &_flat_stats, &_frag_stats, &_hop_stats
+    };
+    for(int h = 0; h < 5; ++h) {
+        _results->Begin(hist_names[h], _cur_sim, _time, hist_columns);
+        for(int c = 0; c < _classes; ++c) {
+            if(_measure_stats[c] == 0) {
+                continue;
+            }
+            Stats const * const s = (*hists[h])[c];
+            // only the occupied bins
+            for(int b = 0; b < s->NumBins(); ++b) {
+                if(s->GetBin(b) > 0) {
+                    double const row[] = { (double)c, b * s->BinSize(), (double)s->GetBin(b) };
+                    _results->Row(vector<double>(row, row + 3));
+                }
+            }
         }
-        os << "*** END ***" << endl << endl;
+        _results->End();
     }
-#endif
+
+    if(_pair_stats) {
+        static char const * const columns[] = {
+            "class", "src", "dest", "packets", "plat_avg", "nlat_avg", "flat_avg"
+        };
+        _results->Begin("pair", _cur_sim, _time, vector<string>(columns, columns + 7));
+        for(int c = 0; c < _classes; ++c) {
+            if(_measure_stats[c] == 0) {
+                continue;
+            }
+            for(int i = 0; i < _nodes; ++i) {
+                for(int j = 0; j < _nodes; ++j) {
+                    int const p = i * _nodes + j;
+                    double const row[] = {
+                        (double)c, (double)i, (double)j, 
+                        (double)_pair_plat[c][p]->NumSamples(),
+                        _pair_plat[c][p]->Average(), _pair_nlat[c][p]->Average(),
+                        _pair_flat[c][p]->Average()
+                    };
+                    _results->Row(vector<double>(row, row + 7));
+                }
+            }
+        }
+        _results->End();
+    }
+
+    if(gTrackChanUtils) {
+        // routers and ports are -1 for injection and ejection channels
+        static char const * const columns[] = {
+            "subnet", "link", "src_router", "src_port", "dest_router", "dest_port",
+            "util_min", "util_avg", "util_max"
+        };
+        _results->Begin("channel", _cur_sim, _time, vector<string>(columns, columns + 9));
+        for (int s = 0; s < _subnets; ++s) {
+            for (size_t i = 0; i < _chanutil_chans[s].size(); ++i) {
+                FlitChannel const * const chan = _chanutil_chans[s][i];
+                double const row[] = {
+                    (double)s, (double)i,
+                    chan->GetSource() ? (double)chan->GetSource()->GetID() : -1.0,
+                    chan->GetSource() ? (double)chan->GetSourcePort() : -1.0,
+                    chan->GetSink() ? (double)chan->GetSink()->GetID() : -1.0,
+                    chan->GetSink() ? (double)chan->GetSinkPort() : -1.0,
+                    _chanutil_min[s][i],
+                    (_chanutil_windows > 0) ? (_chanutil_sum[s][i] / _chanutil_windows) : 0.0,
+                    _chanutil_max[s][i]
+                };
+                _results->Row(vector<double>(row, row + 9));
+            }
+        }
+        _results->End();
+    }
+}
+
+// Per-class statistics averaged over all simulations, the same values that
+// DisplayOverallStats() prints.
+void TrafficManager::_WriteOverallResults( )
+{
+    static char const * const columns[] = {
+        "class", "load", "sims", "plat_min", "plat_avg", "plat_max", "nlat_min",
+        "nlat_avg", "nlat_max", "flat_min", "flat_avg", "flat_max", "frag_min",
+        "frag_avg", "frag_max", "sent_packet_rate_min", "sent_packet_rate_avg",
+        "sent_packet_rate_max", "accepted_packet_rate_min",
+        "accepted_packet_rate_avg", "accepted_packet_rate_max",
+        "sent_flit_rate_min", "sent_flit_rate_avg", "sent_flit_rate_max",
+        "accepted_flit_rate_min", "accepted_flit_rate_avg",
+        "accepted_flit_rate_max", "hops_avg"
+    };
+    _results->Begin("overall", _cur_sim, _time, 
+                    vector<string>(columns, columns + sizeof(columns) / sizeof(columns[0])));
+    double const sims = (double)_total_sims;
+    for(int c = 0; c < _classes; ++c) {
+        if(_measure_stats[c] == 0) {
+            continue;
+        }
+        double const row[] = {
+            (double)c, _load[c], sims,
+            _overall_min_plat[c] / sims, _overall_avg_plat[c] / sims, _overall_max_plat[c] / sims,
+            _overall_min_nlat[c] / sims, _overall_avg_nlat[c] / sims, _overall_max_nlat[c] / sims,
+            _overall_min_flat[c] / sims, _overall_avg_flat[c] / sims, _overall_max_flat[c] / sims,
+            _overall_min_frag[c] / sims, _overall_avg_frag[c] / sims, _overall_max_frag[c] / sims,
+            _overall_min_sent_packets[c] / sims, _overall_avg_sent_packets[c] / sims,
+            _overall_max_sent_packets[c] / sims,
+            _overall_min_accepted_packets[c] / sims, _overall_avg_accepted_packets[c] / sims,
+            _overall_max_accepted_packets[c] / sims,
+            _overall_min_sent[c] / sims, _overall_avg_sent[c] / sims, _overall_max_sent[c] / sims,
+            _overall_min_accepted[c] / sims, _overall_avg_accepted[c] / sims,
+            _overall_max_accepted[c] / sims,
+            _overall_hop_stats[c] / sims
+        };
+        _results->Row(vector<double>(row, row + sizeof(row) / sizeof(row[0])));
+    }
+    _results->End();
+}
+
+// One telemetry line with the progress of the current simulation: running
+// latency and accepted rate of the current sample period, flits in flight
+// and simulation speed since the previous update.
+void TrafficManager::_PublishTelemetry( )
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    double const wall = now.tv_sec + now.tv_usec / 1000000.0;
+    double const cycles_per_sec = (_telemetry_wall > 0.0) ? 
+        (_time - _telemetry_cycle) / (wall - _telemetry_wall) : 0.0;
+    _telemetry_cycle = _time;
+    _telemetry_wall = wall;
+
+    if(!_telemetry->Poll()) {
+        return;
+    }
+
+    static char const * const state_names[] = {
+        "warming_up", "running", "draining", "done"
+    };
+    ostringstream os;
+    os << "time=" << _time
+       << " pid=" << getpid()
+       << " sim=" << _cur_sim
+       << " state=" << state_names[_sim_state]
+       << " cycles_per_sec=" << cycles_per_sec;
+    double const rate_scale = (double)(_time - _reset_time) * (double)_nodes;
+    for(int c = 0; c < _classes; ++c) {
+        int accepted_flits;
+        _ComputeStats(_accepted_flits[c], &accepted_flits);
+        os << " plat_" << c << "=" << _plat_stats[c]->Average()
+           << " nlat_" << c << "=" << _nlat_stats[c]->Average()
+           << " accepted_" << c << "=" 
+           << ((rate_scale > 0.0) ? (accepted_flits / rate_scale) : 0.0)
+           << " in_flight_" << c << "=" << _InFlightFlits(c);
+    }
+    _telemetry->Publish(os.str());
 }
 
 string TrafficManager::_OverallStatsCSV(int c) const
@@ -2879,13 +3392,13 @@ string TrafficManager::_OverallStatsCSV(int c) const
        << ',' << _overall_avg_accepted[c] / _overall_avg_accepted_packets[c]
        << ',' << _overall_hop_stats[c] / (double)_total_sims;
 
-#ifdef TRACK_STALLS
-    os << ',' << (double)_overall_buffer_busy_stalls[c] / (double)_total_sims
-       << ',' << (double)_overall_buffer_conflict_stalls[c] / (double)_total_sims
-       << ',' << (double)_overall_buffer_full_stalls[c] / (double)_total_sims
-       << ',' << (double)_overall_buffer_reserved_stalls[c] / (double)_total_sims
-       << ',' << (double)_overall_crossbar_conflict_stalls[c] / (double)_total_sims;
-#endif
+    if(gTrackStalls) {
+        os << ',' << (double)_overall_buffer_busy_stalls[c] / (double)_total_sims
+           << ',' << (double)_overall_buffer_conflict_stalls[c] / (double)_total_sims
+           << ',' << (double)_overall_buffer_full_stalls[c] / (double)_total_sims
+           << ',' << (double)_overall_buffer_reserved_stalls[c] / (double)_total_sims
+           << ',' << (double)_overall_crossbar_conflict_stalls[c] / (double)_total_sims;
+    }
 
     return os.str();
 }
@@ -2983,6 +3496,16 @@ double TrafficManager::_GetAveragePacketSize(int cl) const
 
 
 // THO: Generate Message
+void TrafficManager::_NextRequest( int source, int cl, int & dest, int & flits )
+{
+    // THO: workaround glitch in compute-memory traffic & add transient traffic
+    if ((_transient_time == 0) || (GetSimTime() < _transient_time))
+        dest = _traffic_pattern[cl]->dest(source);
+    else
+        dest = _traffic_pattern_transient[cl]->dest(source);
+    flits = -1;
+}
+
 void TrafficManager::_GenerateMessage( int source, int stype, int cl, int time )
 {
     assert(stype!=0);
@@ -2991,12 +3514,9 @@ void TrafficManager::_GenerateMessage( int source, int stype, int cl, int time )
     Flit::FlitType message_type = Flit::ANY_TYPE;
     int message_size = _GetNextMessageSize(cl); //in packets
     int packet_size = _GetNextPacketSize(cl); //in flits
-    // THO: workaround glitch in compute-memory traffic & add transient traffic
+    int request_flits = -1;
     if (stype > 0) {
-        if ((_transient_time == 0) || (GetSimTime() < _transient_time))
-            message_destination = _traffic_pattern[cl]->dest(source);
-        else
-            message_destination = _traffic_pattern_transient[cl]->dest(source);
+        _NextRequest(source, cl, message_destination, request_flits);
     }
     bool record = false;
     // bool watch = gWatchOut && (_packets_to_watch.count(pid) > 0); // HANS: Disabled for now
@@ -3048,6 +3568,9 @@ void TrafficManager::_GenerateMessage( int source, int stype, int cl, int time )
             rinfo->Free();
         }
     }
+    if (request_flits > 0) {
+        message_size = (request_flits + packet_size - 1) / packet_size;
+    }
 
     if ((message_destination < 0) || (message_destination >= _nodes)) {
         ostringstream err;
@@ -3073,122 +3596,179 @@ void TrafficManager::_GenerateMessage( int source, int stype, int cl, int time )
     // if ((source / gK) == 0)
       // cout << "offset: " << off_set << endl;
 
-    for (int i = 0; i < message_size; ++i) {
-      int pid = _cur_pid++;
-      assert(_cur_pid);
+    // Flit, packet and local packet IDs are handed out here for the whole
+    // message; the flits themselves are only created one packet at a time
+    // by _MaterializePacket once the source gets around to them.
+    QueuedMessage & qm = _queued_messages[source][cl];
+    assert(qm.packets == 0);
+    qm.packets = message_size;
+    qm.message_size = message_size;
+    qm.packet_size = packet_size;
+    qm.id = _cur_id;
+    _cur_id += message_size * packet_size;
+    assert(_cur_id);
+    qm.pid = _cur_pid;
+    _cur_pid += message_size;
+    assert(_cur_pid);
+    qm.lpid = _cur_lpid[source / gK];
+    _cur_lpid[source / gK] += message_size;
+#ifdef PACKET_GRAN_ORDER
+    int type = FindType(message_type);
+    qm.packet_seq = _reordering_vect[source][message_destination][type]->send;
+    _reordering_vect[source][message_destination][type]->send += message_size;
+#else
+    qm.packet_seq = 0;
+#endif
+    qm.mid = mid;
+    qm.dest = message_destination;
+    qm.time = time;
+    qm.record = record;
+    qm.watch = watch;
+    qm.subnetwork = subnetwork;
+    qm.type = message_type;
+
+    switch( _pri_type ) {
+    case class_based:
+        qm.pri = _class_priority[cl];
+        assert(qm.pri >= 0);
+        break;
+    case age_based:
+        qm.pri = numeric_limits<int>::max() - time;
+        assert(qm.pri >= 0);
+        break;
+    case sequence_based:
+        // qm.pri = numeric_limits<int>::max() - _packet_seq_no[source];
+        qm.pri = numeric_limits<int>::max() - _message_seq_no[source];
+        assert(qm.pri >= 0);
+        break;
+    default:
+        qm.pri = 0;
+    }
+
+    _queued_flits[cl] += message_size * packet_size;
+    if(record) {
+        _queued_measured_flits[cl] += message_size * packet_size;
+    }
+
+    if ( watch ) { 
+        for (int i = 0; i < message_size; ++i) {
+            *gWatchOut << GetSimTime() << " | "
+                       << "node" << source << " | "
+                       << "Enqueuing packet " << qm.pid + i
+                       << " at time " << time
+                       << "." << endl;
+        }
+    }
+}
 
-      int lpid = _cur_lpid[source / gK]++;
-      // if ((source / gK) == 0)
-      //   cout << "lpid = " << lpid << endl;
+void TrafficManager::_MaterializePacket( int source, int cl )
+{
+    QueuedMessage & qm = _queued_messages[source][cl];
+    assert(qm.packets > 0);
+    assert(_partial_packets[source][cl].empty());
 
-      if ( watch ) { 
-        *gWatchOut << GetSimTime() << " | "
-                   << "node" << source << " | "
-                   << "Enqueuing packet " << pid
-                   << " at time " << time
-                   << "." << endl;
-      }
-
-      for ( int j = 0; j < packet_size; ++j ) {
-          Flit * f  = Flit::New();
-          if ((message_size == 1) && (packet_size == 1))
-            f->is_small = true;
-          f->id     = _cur_id++;
-          assert(_cur_id);
-          f->pid    = pid;
-          f->lpid   = lpid;
-          f->mid    = mid;
-          f->watch  = watch | (gWatchOut && (_flits_to_watch.count(f->id) > 0));
-          f->subnetwork = subnetwork;
-          f->src    = source;
-          f->ctime  = time;
-          f->record = record;
-          f->cl     = cl;
-          f->packet_size = packet_size;
-
-          _total_in_flight_flits[f->cl].insert(make_pair(f->id, f));
-          if(record) {
-              _measured_in_flight_flits[f->cl].insert(make_pair(f->id, f));
-          }
-
-          if(gTrace){
-              cout<<"New Flit "<<f->src<<endl;
-          }
-          f->type = message_type;
-
-          if ( i == 0 ) { // Head packet
-              f->msg_head = true;
-          }
-
-          if ( j == 0 ) { // Head flit
-              f->head = true;
-              f->dest = message_destination;            
-          } else {
-              f->head = false;
-              f->dest = -1;
-          }
+    int const i = qm.message_size - qm.packets;
+    int const message_size = qm.message_size;
+    int const packet_size = qm.packet_size;
+
+    int pid = qm.pid++;
+    int lpid = qm.lpid++;
+    // if ((source / gK) == 0)
+    //   cout << "lpid = " << lpid << endl;
+
+    for ( int j = 0; j < packet_size; ++j ) {
+        Flit * f  = Flit::New();
+        if ((message_size == 1) && (packet_size == 1))
+          f->is_small = true;
+        f->id     = qm.id++;
+        f->pid    = pid;
+        f->lpid   = lpid;
+        f->mid    = qm.mid;
+        f->watch  = qm.watch | (gWatchOut && (_flits_to_watch.count(f->id) > 0));
+        f->subnetwork = qm.subnetwork;
+        f->src    = source;
+        f->ctime  = qm.time;
+        f->record = qm.record;
+        f->cl     = cl;
+        f->packet_size = packet_size;
+
+        _total_in_flight_flits[f->cl].insert(make_pair(f->id, f));
+        if(qm.record) {
+            _measured_in_flight_flits[f->cl].insert(make_pair(f->id, f));
+        }
+
+        if(gTrace){
+            cout<<"New Flit "<<f->src<<endl;
+        }
+        f->type = qm.type;
+
+        if ( i == 0 ) { // Head packet
+            f->msg_head = true;
+        }
+
+        if ( j == 0 ) { // Head flit
+            f->head = true;
+            f->dest = qm.dest;            
+        } else {
+            f->head = false;
+            f->dest = -1;
+        }
 
 #ifdef PACKET_GRAN_ORDER
-          int type = FindType(f->type);
-          f->packet_seq = _reordering_vect[source][message_destination][type]->send;
+        f->packet_seq = qm.packet_seq;
 #else
-          f->packet_seq = i;
+        f->packet_seq = i;
 #endif
 
-        //   if ((f->mid == 958) && f->head && (f->packet_seq==11))  // UR
-        //   if (f->id == 20530144)    // UR 8192-flit buffer
-        //     f->watch=true;
-
-          switch( _pri_type ) {
-          case class_based:
-              f->pri = _class_priority[cl];
-              assert(f->pri >= 0);
-              break;
-          case age_based:
-              f->pri = numeric_limits<int>::max() - time;
-              assert(f->pri >= 0);
-              break;
-          case sequence_based:
-              // f->pri = numeric_limits<int>::max() - _packet_seq_no[source];
-              f->pri = numeric_limits<int>::max() - _message_seq_no[source];
-              assert(f->pri >= 0);
-              break;
-          default:
-              f->pri = 0;
-          }
-          if (i == ( message_size - 1 ) ) { // Tail packet
-              f->msg_tail = true;
-          }
-          if ( j == ( packet_size - 1 ) ) { // Tail flit
-              f->tail = true;
-
-              // HANS: For debugging purpose
-              f->dest = message_destination;
-
-              // HANS: Additionals for packet reordering
-#ifdef PACKET_GRAN_ORDER
-              int type = FindType(f->type);
-              _reordering_vect[source][message_destination][type]->send += 1;
-#endif
-              
-          } else {
-              f->tail = false;
-          }
-
-          f->vc  = -1;
-
-          if ( f->watch ) { 
-              *gWatchOut << GetSimTime() << " | "
-                         << "node" << source << " | "
-                         << "Enqueuing flit " << f->id
-                         << " (message " << f->mid
-                         << ", packet " << f->pid
-                         << ") at time " << time
-                         << "." << endl;
-          }
-
-          _partial_packets[source][cl].push_back( f );
-      }
+      //   if ((f->mid == 958) && f->head && (f->packet_seq==11))  // UR
+      //   if (f->id == 20530144)    // UR 8192-flit buffer
+      //     f->watch=true;
+
+        f->pri = qm.pri;
+        if (i == ( message_size - 1 ) ) { // Tail packet
+            f->msg_tail = true;
+        }
+        if ( j == ( packet_size - 1 ) ) { // Tail flit
+            f->tail = true;
+
+            // HANS: For debugging purpose
+            f->dest = qm.dest;
+        } else {
+            f->tail = false;
+        }
+
+        f->vc  = -1;
+
+        if ( f->watch ) { 
+            *gWatchOut << GetSimTime() << " | "
+                       << "node" << source << " | "
+                       << "Enqueuing flit " << f->id
+                       << " (message " << f->mid
+                       << ", packet " << f->pid
+                       << ") at time " << qm.time
+                       << "." << endl;
+        }
+
+        _partial_packets[source][cl].push_back( f );
+    }
+
+    ++qm.packet_seq;
+    --qm.packets;
+    _queued_flits[cl] -= packet_size;
+    if(qm.record) {
+        _queued_measured_flits[cl] -= packet_size;
+    }
+}
+
+void TrafficManager::_AddQueuedLatency( int cl, double & latency, double & count ) const
+{
+    for ( int s = 0; s < _nodes; ++s ) {
+        QueuedMessage const & qm = _queued_messages[s][cl];
+        if ( qm.packets > 0 ) {
+            double const flits = (double)(qm.packets * qm.packet_size);
+            latency += flits * (double)(_time - qm.time);
+            count += flits;
+        }
     }
 }
 
@@ -29,6 +29,7 @@
 #define _TRAFFICMANAGER_HPP_
 
 #include <list>
+#include <deque>
 #include <map>
 #include <set>
 #include <cassert>
@@ -50,8 +51,6 @@
 // #define ORDER_AS_GAP
 
 // THO: Statistic options
-// #define CHAN_UTILS
-// #define WAIT_TIME
 
 
 // HANS: Additionals for reordering, based on Merlin's reorderLinkControl
@@ -77,8 +76,36 @@ struct ReorderInfo {
   {}
 };
 
+// Message waiting at its source. Its flit, packet and local packet IDs are
+// assigned when it is generated, but its flits are only created one packet
+// at a time, when the previous packet has been injected.
+struct QueuedMessage {
+  int packets;          // packets whose flits have not been created yet
+  int message_size;
+  int packet_size;
+  int id;               // next flit, packet and local packet IDs
+  int pid;
+  int lpid;
+  int packet_seq;
+  int mid;
+  int dest;
+  int time;
+  int pri;
+  int subnetwork;
+  Flit::FlitType type;
+  bool record;
+  bool watch;
+
+  QueuedMessage() : packets(0) {}
+};
+
 //register the requests to a node
 class PacketReplyInfo;
+class EndpointModel;
+class ResultsWriter;
+class SnapshotStream;
+class TelemetryServer;
+class DeadlockDetector;
 
 class TrafficManager : public Module {
 
@@ -137,10 +164,8 @@ protected:
 
   // ============ Injection VC states  ============
   vector<vector<BufferState *> > _buf_states;
-#ifdef TRACK_FLOWS
   vector<vector<vector<int> > > _outstanding_credits;
   vector<vector<vector<queue<int> > > > _outstanding_classes;
-#endif
   vector<vector<vector<int> > > _last_vc;
 
   // ============ Routing ============
@@ -152,6 +177,9 @@ protected:
   vector<vector<int> > _qtime;
   vector<vector<bool> > _qdrained;
   vector<vector<list<Flit *> > > _partial_packets;
+  vector<vector<QueuedMessage> > _queued_messages;
+  vector<int> _queued_flits;
+  vector<int> _queued_measured_flits;
 
   vector<map<int, Flit *> > _total_in_flight_flits;
   vector<map<int, Flit *> > _measured_in_flight_flits;
@@ -168,6 +196,11 @@ protected:
   // ============ deadlock ==========
   int _deadlock_timer;
   int _deadlock_warn_timeout;
+  // confirms suspected deadlocks (deadlock_abort); NULL if disabled
+  DeadlockDetector * _deadlock_detector;
+  // set once a deadlock is confirmed; the simulation loops stop stepping
+  // and Run() returns false
+  bool _deadlocked;
 
   // ============ request & replies ==========================
   vector<int> _packet_seq_no;
@@ -175,6 +208,20 @@ protected:
   vector<list<PacketReplyInfo*> > _repliesPending;
   vector<int> _requestsOutstanding;
 
+  // ============ request endpoints ==========================
+  EndpointModel * _endpoint;
+  // ejection credits held back while the node's endpoint is full
+  vector<vector<vector<int> > > _held_credits;
+  vector<int> _held_credit_count;
+  int _held_request_flits;
+  // requests that arrived while their endpoint was full, admitted in order
+  // as it drains
+  vector<deque<PacketReplyInfo *> > _held_requests;
+  int _held_request_count;
+  Stats * _endpoint_queue_stats;
+  double _overall_avg_endpoint_queue;
+  double _overall_max_endpoint_queue;
+
   // ============ Statistics ============
   vector<Stats *> _plat_stats;     
   vector<double> _overall_min_plat;  
@@ -248,7 +295,6 @@ protected:
   vector<double> _overall_avg_write_rlat;  
   vector<double> _overall_max_write_rlat;
 
-#ifdef WAIT_TIME
   // Endpoint wait time statistics
   vector<Stats *> _ewlat_stats;     
   vector<double> _overall_min_ewlat;  
@@ -270,16 +316,21 @@ protected:
   vector<double> _overall_min_downservice;  
   vector<double> _overall_avg_downservice;  
   vector<double> _overall_max_downservice;
-#endif
 
-#ifdef CHAN_UTILS
-  static const int _num_channels = 512; // Uplink + downlink
-  vector<vector<Stats *> >  _chanutil_stats;     
-  vector<vector<Stats *> >  _chanutil_freq_stats;     
-  vector<vector<double> > _overall_min_chanutil;  
-  vector<vector<double> > _overall_avg_chanutil;  
-  vector<vector<double> > _overall_max_chanutil;   
-#endif
+  // channel utilization: busy cycles of every flit channel, sampled at
+  // each statistics update into per-link windowed utilizations
+  vector<vector<FlitChannel *> > _chanutil_chans;
+  vector<vector<int> > _chanutil_mark;
+  int _chanutil_mark_time;
+  int _chanutil_windows;
+  vector<vector<double> > _chanutil_min;
+  vector<vector<double> > _chanutil_sum;
+  vector<vector<double> > _chanutil_max;
+  vector<vector<double> > _overall_min_chanutil;
+  vector<vector<double> > _overall_avg_chanutil;
+  vector<vector<double> > _overall_max_chanutil;
+  int _chanutil_top;
+  ostream * _chanutil_out;
 
   vector<Stats *> _hop_stats;
   vector<double> _overall_hop_stats;
@@ -301,7 +352,6 @@ protected:
   vector<double> _overall_avg_accepted;
   vector<double> _overall_max_accepted;
 
-#ifdef TRACK_STALLS
   vector<vector<int> > _buffer_busy_stalls;
   vector<vector<int> > _buffer_conflict_stalls;
   vector<vector<int> > _buffer_full_stalls;
@@ -312,7 +362,6 @@ protected:
   vector<double> _overall_buffer_full_stalls;
   vector<double> _overall_buffer_reserved_stalls;
   vector<double> _overall_crossbar_conflict_stalls;
-#endif
 
   vector<int> _slowest_packet;
   vector<int> _slowest_flit;
@@ -325,6 +374,8 @@ protected:
   vector<vector<vector<ReorderInfo*> > > _reordering_vect;
   vector<vector<int> > _reordering_vect_size;
   int _reordering_vect_maxsize;
+  // flits held in the reorder buffer of each destination
+  vector<int> _rob_occupancy;
 
   vector<vector<int> > source_resend;
   vector<vector<vector<Flit*> > > _reordering_vect_flit;
@@ -371,7 +422,20 @@ protected:
   //flits to watch
   ostream * _stats_out;
 
-#ifdef TRACK_FLOWS
+  // binary results (results_out); NULL if disabled
+  ResultsWriter * _results;
+  int _cur_sim;
+
+  // periodic network state snapshots (snapshot_out); NULL if disabled
+  SnapshotStream * _snapshot;
+
+  // live telemetry (telemetry_socket); NULL if disabled
+  TelemetryServer * _telemetry;
+  int _telemetry_interval;
+  // cycle and wall clock time of the previous update, for cycles/sec
+  int _telemetry_cycle;
+  double _telemetry_wall;
+
   vector<vector<int> > _injected_flits;
   vector<vector<int> > _ejected_flits;
   ostream * _injected_flits_out;
@@ -381,13 +445,10 @@ protected:
   ostream * _outstanding_credits_out;
   ostream * _ejected_flits_out;
   ostream * _active_packets_out;
-#endif
 
-#ifdef TRACK_CREDITS
   ostream * _used_credits_out;
   ostream * _free_credits_out;
   ostream * _max_credits_out;
-#endif
 
   // THO: Node types
   int _num_compute_nodes;
@@ -403,11 +464,31 @@ protected:
   void _Step( );
 
   bool _PacketsOutstanding( ) const;
+
+  void _AdmitHeldRequests( );
+  void _ReleaseCredits( int node, int subnet, Credit * c );
+  void _MaterializePacket( int source, int cl );
+  // no message of this class is waiting at the source
+  inline bool _SourceIdle( int source, int cl ) const {
+    return _partial_packets[source][cl].empty() && 
+      (_queued_messages[source][cl].packets == 0);
+  }
+  // flits generated but not yet retired, including those not created yet
+  inline int _InFlightFlits( int cl ) const {
+    return _total_in_flight_flits[cl].size() + _queued_flits[cl];
+  }
+  inline int _MeasuredInFlightFlits( int cl ) const {
+    return _measured_in_flight_flits[cl].size() + _queued_measured_flits[cl];
+  }
+  void _AddQueuedLatency( int cl, double & latency, double & count ) const;
   
 
   // THO: Message-based simulation
   virtual int  _IssueMessage( int source, int cl );
   virtual void _GenerateMessage( int source, int size, int cl, int time );
+  // destination and size in flits (-1 for the configured size) of the
+  // next request a source issues
+  virtual void _NextRequest( int source, int cl, int & dest, int & flits );
   virtual int _GetNextMessageSize(int cl) const;
   virtual double _GetAverageMessageSize(int cl) const;
 
@@ -423,6 +504,17 @@ protected:
 
   virtual void _UpdateOverallStats();
 
+  void _ReportDeadlock( );
+
+  void _UpdateChanUtils( );
+  void _DisplayChanUtils( ostream & os ) const;
+
+  void _WriteSampleResults( );
+  void _WriteSimResults( );
+  void _WriteOverallResults( );
+
+  void _PublishTelemetry( );
+
   virtual string _OverallStatsCSV(int c = 0) const;
 
   int _GetNextPacketSize(int cl) const;
@@ -456,6 +548,7 @@ public:
   virtual void DisplayAvgLatFrequently( ostream & os = cout, int period = 0 ) const ;
 
   inline int getTime() { return _time;}
+  inline int getFlitCount() { return _cur_id;}
   Stats * getStats(const string & name) { return _stats[name]; }
 
 };
@@ -0,0 +1,88 @@
+#!/bin/sh
+
+# $Id$
+
+# Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# Redistributions of source code must retain the above copyright notice, this
+# list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+# This is a helper script that validates the lite router against the
+# input-queued router by running both over the same set of injection rates.
+#
+# It takes a complete booksim commandline as its parameter.
+#
+# Example:
+#
+#  rates="0.05 0.1 0.2" ./compare_routers.sh ./booksim configfile
+#
+# For each injection rate, one line is printed that starts with "COMPARE: " 
+# and lists the rate, the average packet latency and accepted flit rate for
+# router=iq and router=lite, and the lite/iq ratio of each. Failed or
+# unstable runs are reported as "-".
+
+if [ "${1}" = "" ]
+then
+    echo "COMPARE: Please specify a simulator executable as the first parameter."
+    exit
+fi
+
+sim=${1}
+shift
+
+if [ "${rates}" = "" ]
+then
+    rates="0.05 0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8 0.9"
+fi
+
+run() {
+    ${sim} $* print_csv_results=1 > ${sim}.${HOSTNAME}.${$}.log 2>&1
+    grep "results:0," ${sim}.${HOSTNAME}.${$}.log | cut -d , -f 6,27
+    rm ${sim}.${HOSTNAME}.${$}.log
+}
+
+ratio() {
+    # the values reach awk as program text, so anything non-numeric has
+    # to be caught before it
+    for v in "${1}" "${2}"
+    do
+        case "${v}" in
+            ''|*[!0-9.e+-]*|-) echo "-"; return ;;
+        esac
+    done
+    awk "BEGIN{ if ( ${1} == 0 ) print \"-\"; else printf \"%.3f\", ${2} / ${1} }"
+}
+
+echo "COMPARE: rate iq_lat lite_lat lat_ratio iq_acc lite_acc acc_ratio"
+
+for inj in ${rates}
+do
+    iq=`run $* router=iq injection_rate=${inj}`
+    lite=`run $* router=lite injection_rate=${inj}`
+    iq_lat=`echo ${iq} | cut -d , -f 1`
+    iq_acc=`echo ${iq} | cut -d , -f 2`
+    lite_lat=`echo ${lite} | cut -d , -f 1`
+    lite_acc=`echo ${lite} | cut -d , -f 2`
+    [ "${iq_lat}" = "" ] && iq_lat="-" && iq_acc="-"
+    [ "${lite_lat}" = "" ] && lite_lat="-" && lite_acc="-"
+    echo "COMPARE: ${inj} ${iq_lat} ${lite_lat} `ratio ${iq_lat} ${lite_lat}` ${iq_acc} ${lite_acc} `ratio ${iq_acc} ${lite_acc}`"
+done
@@ -0,0 +1,82 @@
+#!/bin/sh
+
+# $Id$
+
+# Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# Redistributions of source code must retain the above copyright notice, this
+# list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+# This is a helper script that measures simulator speed on a fixed set of
+# configurations so that slowdowns can be tracked across revisions.
+#
+# It takes the simulator executable as its parameter and must be run from
+# the src directory, where the example configurations live.
+#
+# Example:
+#
+#  cd src && ../utils/perf_bench.sh ./booksim >> perf_history.csv
+#
+# One CSV line is printed per configuration, preceded by a header line
+# unless header=0 is set in the environment. The revision column defaults
+# to the current git commit and can be overridden with rev=<label>. Runs
+# that fail before reporting their statistics have empty value columns.
+#
+# Latency-mode runs are pinned to a fixed number of sample periods by
+# disabling the convergence checks, so the simulated cycle count only
+# changes when the simulated behavior does.
+
+if [ "${1}" = "" ]
+then
+    echo "PERF: Please specify a simulator executable as the first parameter."
+    exit
+fi
+
+sim=${1}
+shift
+
+if [ "${rev}" = "" ]
+then
+    rev=`git rev-parse --short HEAD 2> /dev/null`
+fi
+
+fixed="warmup_periods=1 sample_period=2000 max_samples=4 stopping_thres=0.0 acc_stopping_thres=0.0 print_perf_stats=1"
+
+run() {
+    name=${1}
+    shift
+    ${sim} $* ${fixed} > ${sim}.${HOSTNAME}.${$}.log 2>&1
+    perf=`grep "^perf:" ${sim}.${HOSTNAME}.${$}.log | tail -1 | sed -e 's/^perf://' -e 's/[a-z_]*=//g'`
+    [ "${perf}" = "" ] && perf=",,,,,,"
+    echo "${rev},${name},${perf}"
+    rm ${sim}.${HOSTNAME}.${$}.log
+}
+
+if [ "${header}" != "0" ]
+then
+    echo "revision,config,construction_time,run_time,cycles,flits,cycles_per_sec,flits_per_sec,peak_rss_kb"
+fi
+
+run mesh88_lat examples/mesh88_lat compute_nodes=64 memory_nodes=0
+run torus88 examples/torus88 compute_nodes=64 memory_nodes=0
+run fattree_hash examples/fattree_config routing_function=nca_sourcehash compute_nodes=64 memory_nodes=0
+run dragonfly ../runfiles/dragonflyconfig compute_nodes=1056 memory_nodes=0
+run fattree_msg configs/fattree_msg k=4 compute_nodes=16 batch_size=20